@@ -13,6 +13,7 @@ public class MutableExtension : ModuleRules
 			{
 				"Core",
 				"CustomizableObject",
+				"NetCore",
 			}
 			);
 			
@@ -22,6 +23,8 @@ public class MutableExtension : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"Json",
+				"TraceLog",
 			}
 			);
 	}
@@ -3,10 +3,17 @@
 
 #include "MutableExtensionComponent.h"
 
+#include "MutableExtensionLog.h"
+#include "MutableExtensionSubsystem.h"
+#include "MutableExtensionTrace.h"
 #include "MutableFunctionLib.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
 #include "MuCO/CustomizableObjectInstancePrivate.h"
 #include "MuCO/CustomizableSkeletalComponent.h"
 #include "MuCO/CustomizableObjectSystemPrivate.h"
+#include "Misc/CoreDelegates.h"
+#include "Net/UnrealNetwork.h"
 
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(MutableExtensionComponent)
@@ -16,11 +23,73 @@ UMutableExtensionComponent::UMutableExtensionComponent()
 	PrimaryComponentTick.bCanEverTick = false;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
 	SetIsReplicatedByDefault(false);
+
+	ReplicatedDescriptor.Owner = this;
+}
+
+void UMutableExtensionComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bReplicateDescriptors && GetOwnerRole() == ROLE_Authority)
+	{
+		SetIsReplicated(true);
+	}
+}
+
+void UMutableExtensionComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ThisClass, ReplicatedDescriptor);
 }
 
 void UMutableExtensionComponent::ResetMutableInitialization()
 {
+	// Must happen before releasing shared instances, others may still need them generated
+	CancelScheduledWork();
+
 	// Initialization
+	if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+	{
+		for (const UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+		{
+			Subsystem->UnregisterComponent(Component);
+		}
+		for (const UCustomizableObjectInstance* Instance : CachedInitializingInstances)
+		{
+			Subsystem->ClearSpeculativeCandidates(Instance);
+		}
+	}
+	for (const TPair<UCustomizableObjectInstance*, FDelegateHandle>& Pair : InstanceUpdatedHandles)
+	{
+		if (IsValid(Pair.Key))
+		{
+			Pair.Key->UpdatedNativeDelegate.Remove(Pair.Value);
+		}
+	}
+	InstanceUpdatedHandles.Reset();
+	if (InstanceTimedOutHandle.IsValid())
+	{
+		if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+		{
+			Subsystem->OnInstanceTimedOut.Remove(InstanceTimedOutHandle);
+		}
+		InstanceTimedOutHandle.Reset();
+	}
+	InitializingDescriptorHashes.Reset();
+	GeneratingInstances.Reset();
+	DiskCacheReadingInstances.Reset();
+	InitializationStats = {};
+	for (const TPair<UCustomizableObjectInstance*, int32>& Pair : RefiningInstances)
+	{
+		if (IsValid(Pair.Key))
+		{
+			UMutableFunctionLib::SetInstanceMinLOD(Pair.Key, Pair.Value);
+		}
+	}
+	RefiningInstances.Reset();
+	ReleaseSharedInstances();
 	bHasRequestedInitialize = false;
 	InstancesPendingInitialization.Reset();
 	CachedInitializingInstances.Reset();
@@ -31,7 +100,34 @@ void UMutableExtensionComponent::ResetMutableInitialization()
 	}
 
 	// Runtime Update
+	TransactionDepth = 0;
+	TransactionBaseHashes.Reset();
+	TransactionUpdates.Reset();
 	InstancesPendingRuntimeUpdate.Reset();
+	LastGeneratedDescriptorHashes.Reset();
+	if (EndOfFrameHandle.IsValid())
+	{
+		FCoreDelegates::OnEndFrame.Remove(EndOfFrameHandle);
+		EndOfFrameHandle.Reset();
+	}
+	QueuedCompletions.Reset();
+	FlushMeshSwaps();
+
+	// Replication, the captured parameters are keyed by component index which the next initialization may reassign
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		ReplicatedDescriptor.Reset();
+	}
+	for (const TPair<const UCustomizableObjectInstance*, FDelegateHandle>& Pair : ReplicatedUpdateHandles)
+	{
+		UnsubscribeFromRuntimeUpdate(Pair.Key, Pair.Value);
+	}
+	ReplicatedUpdateHandles.Reset();
+	ReplicatedReceiveTimes.Reset();
+	ComponentsPendingReplicatedUpdate.Reset();
+
+	// Pooling
+	bParked = false;
 }
 
 void UMutableExtensionComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -44,9 +140,20 @@ void UMutableExtensionComponent::EndPlay(const EEndPlayReason::Type EndPlayReaso
 FOnMutableExtensionSimpleDelegate& UMutableExtensionComponent::RequestMutableInitialization(
 	const TArray<UCustomizableSkeletalComponent*>& MutableComponents)
 {
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::RequestMutableInitialization);
+
+	// Back from a pool, keep whatever still matches
+	if (IsParked() && CanUnpark(MutableComponents))
+	{
+		return UnparkMutable();
+	}
+
 	ResetMutableInitialization();
 
 	bHasRequestedInitialize = true;
+	InitializationStats.RequestTime = FPlatformTime::Seconds();
+
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
 	
 	for (UCustomizableSkeletalComponent* Component : MutableComponents)
 	{
@@ -57,14 +164,19 @@ FOnMutableExtensionSimpleDelegate& UMutableExtensionComponent::RequestMutableIni
 			Component->CreateCustomizableObjectInstanceUsage();
 
 			CachedInitializingComponents.Add(Component);
-			if (!InstancesPendingInitialization.Contains(Instance))
+			if (Subsystem)
+			{
+				Subsystem->RegisterComponent(Component);
+			}
+
+			bool bAlreadyPending;
+			InstancesPendingInitialization.Add(Instance, &bAlreadyPending);
+			if (!bAlreadyPending)
 			{
-				InstancesPendingInitialization.Add(Instance);
+				CachedInitializingInstances.Add(Instance);
 			}
 		}
 	}
-	
-	CachedInitializingInstances = InstancesPendingInitialization;
 
 	GetWorld()->GetTimerManager().SetTimerForNextTick(this, &ThisClass::BeginMutableInitialization);
 	
@@ -73,135 +185,1673 @@ FOnMutableExtensionSimpleDelegate& UMutableExtensionComponent::RequestMutableIni
 
 void UMutableExtensionComponent::BeginMutableInitialization()
 {
-	for (UCustomizableObjectInstance* Instance : CachedInitializingInstances)
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::BeginMutableInitialization);
+
+	// Descriptors are read from here on, so this is what the first generation will use
+	if (bReplicateDescriptors)
 	{
-		if (InstancesPendingInitialization.Num() == 0)
+		if (GetOwnerRole() == ROLE_Authority)
 		{
-			return;
+			for (const UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+			{
+				ReplicateDescriptor(Component);
+			}
 		}
-		
-		FDelegateHandle Delegate = Instance->UpdatedNativeDelegate.AddWeakLambda(this, [&](UCustomizableObjectInstance* UpdatedInstance)
+		else
+		{
+			ApplyReplicatedDescriptor();
+		}
+	}
+
+	// Nothing to wait on, but the caller is still owed a completion
+	if (InstancesPendingInitialization.Num() == 0)
+	{
+		OnInitializationCompleted();
+		return;
+	}
+
+	if (ShouldSkipGeneration())
+	{
+		SkipMutableInitialization();
+		return;
+	}
+
+	// Sharing can replace entries in CachedInitializingInstances, and completion can be synchronous
+	const TArray<UCustomizableObjectInstance*> Instances = CachedInitializingInstances;
+	for (UCustomizableObjectInstance* Instance : Instances)
+	{
+		InitializeInstance(Instance, bUseDiskCache);
+	}
+}
+
+void UMutableExtensionComponent::InitializeInstance(UCustomizableObjectInstance* Instance, bool bReadDiskCache)
+{
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	const bool bShareInstances = bShareGeneratedInstances && Subsystem;
+
+	// Any of its components, for the scheduler to score significance with
+	UCustomizableSkeletalComponent* const* Component = CachedInitializingComponents.FindByPredicate(
+		[Instance](const UCustomizableSkeletalComponent* MutableComponent)
+		{
+			return MutableComponent->CustomizableObjectInstance == Instance;
+		});
+
+	TArray<uint8> Descriptor;
+	UMutableFunctionLib::SaveDescriptor(Instance, Descriptor);
+	const uint64 DescriptorHash = UMutableFunctionLib::GetDescriptorHash(Instance, Descriptor);
+
+	// Prewarmed instances were generated for exactly this, so they are shared regardless
+	if (bShareInstances || (Subsystem && Subsystem->IsPrewarmedDescriptor(DescriptorHash)))
+	{
+		bool bGenerated;
+		if (UCustomizableObjectInstance* SharedInstance = Subsystem->AcquireCachedInstance(DescriptorHash, bGenerated))
 		{
-#if WITH_EDITOR
-			// This can cause an edge case when the instance updates during editor time
-			if (!IsValid(this))
+			SharedInstances.Add(SharedInstance);
+			ShareInstance(Instance, SharedInstance);
+			InitializingDescriptorHashes.Add(SharedInstance, DescriptorHash);
+			if (bGenerated)
 			{
-				return;
+				CompleteInstanceInitialization(SharedInstance, true);
 			}
-#endif
-			
-			UpdatedInstance->UpdatedNativeDelegate.Remove(Delegate);
-
-			if (InstancesPendingInitialization.Contains(UpdatedInstance))
+			else
 			{
-				InstancesPendingInitialization.Remove(UpdatedInstance);
-				if (InstancesPendingInitialization.Num() == 0)
-				{
-					OnInitializationCompleted();
-				}
+				// Somebody else is still generating it, wait for them
+				WaitForInstanceUpdate(SharedInstance);
 			}
-		});
+			return;
+		}
+	}
+
+	// Identical to a previous run, nothing to generate. Not shared, sharers expect Mutable to have generated it
+	// Read in the background, a miss comes back here to generate it
+	if (bReadDiskCache && Subsystem && Subsystem->ReadDiskCache(Instance, DescriptorHash,
+		FOnMutableDiskCacheRead::CreateUObject(this, &ThisClass::OnDiskCacheRead, Instance, DescriptorHash)))
+	{
+		DiskCacheReadingInstances.Add(Instance);
+		return;
+	}
+
+	if (bShareInstances)
+	{
+		Subsystem->AddCachedInstance(DescriptorHash, Instance, Descriptor);
+		SharedInstances.Add(Instance);
+	}
+
+	InitializingDescriptorHashes.Add(Instance, DescriptorHash);
+	GeneratingInstances.Add(Instance);
+
+	if (ensureAlways(Subsystem))
+	{
+		// Get something on screen first, full detail follows once every instance is visible
+		if (bProgressiveInitialization)
+		{
+			RefiningInstances.Add(Instance, UMutableFunctionLib::GetInstanceMinLOD(Instance));
+			UMutableFunctionLib::SetInstanceMinLOD(Instance, ProgressiveMinLOD);
+		}
+
+		const FOnMutableScheduledUpdateCompleted Delegate = FOnMutableScheduledUpdateCompleted::CreateUObject(
+			this, &ThisClass::OnMutableInstanceInitializationCompleted);
+		Subsystem->EnqueueInitialization(Instance, Component ? *Component : nullptr, Delegate, InitializationStats.RequestTime);
+	}
+	else
+	{
+		WaitForInstanceUpdate(Instance);
 		Instance->UpdateSkeletalMeshAsync(true, true);
 	}
 }
 
-void UMutableExtensionComponent::OnInitializationCompleted()
+bool UMutableExtensionComponent::ShouldSkipGeneration() const
 {
-	// Updates are async, so this can be called a second time by another
-	if (OnMutableInitialized.IsBound())
+	return DedicatedServerGeneration != EMutableExtensionServerGeneration::Generate && IsNetMode(NM_DedicatedServer);
+}
+
+bool UMutableExtensionComponent::IsMeshValidToRuntimeUpdate(const UCustomizableSkeletalComponent* Component) const
+{
+	// Released by the memory budget or read from the disk cache, the scheduler regenerates it from scratch
+	const UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	return (Subsystem && (Subsystem->IsInstanceReleased(Component->CustomizableObjectInstance) ||
+		Subsystem->IsInstanceFromDiskCache(Component->CustomizableObjectInstance))) ||
+		UMutableFunctionLib::IsMutableMeshValidToUpdate(Component);
+}
+
+uint64 UMutableExtensionComponent::GetDescriptorHash(UCustomizableObjectInstance* Instance) const
+{
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	return Subsystem ? Subsystem->GetDescriptorHash(Instance) : UMutableFunctionLib::GetDescriptorHash(Instance);
+}
+
+FName UMutableExtensionComponent::GetSnapshotId() const
+{
+	return SnapshotId.IsNone() && GetOwner() ? GetOwner()->GetFName() : SnapshotId;
+}
+
+void UMutableExtensionComponent::SkipMutableInitialization()
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::SkipMutableInitialization);
+
+	if (DedicatedServerGeneration == EMutableExtensionServerGeneration::ReferenceMesh)
 	{
-		OnMutableInitialized.Execute();
-		OnMutableInitialized.Unbind();
+		for (const UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+		{
+			USkeletalMeshComponent* OwningComponent = UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(Component);
+			USkeletalMesh* ReferenceMesh = UMutableFunctionLib::GetReferenceSkeletalMesh(Component);
+			if (OwningComponent && ReferenceMesh && OwningComponent->GetSkeletalMeshAsset() != ReferenceMesh)
+			{
+				OwningComponent->SetSkeletalMesh(ReferenceMesh, false);
+			}
+		}
+	}
+
+	// Completion can reset us
+	const TArray<UCustomizableObjectInstance*> Instances = CachedInitializingInstances;
+	for (UCustomizableObjectInstance* Instance : Instances)
+	{
+		CompleteInstanceInitialization(Instance, true);
 	}
 }
 
-bool UMutableExtensionComponent::RuntimeUpdateMutableComponent(USkeletalMeshComponent* OwningComponent,
-	UCustomizableSkeletalComponent* Component, EMutableExtensionRuntimeUpdateError& Error, bool bIgnoreCloseDist, bool
-	bForceHighPriority)
+void UMutableExtensionComponent::WaitForInstanceUpdate(UCustomizableObjectInstance* Instance)
 {
-	if (!ensureAlways(OnComponentRuntimeUpdateCompleted.IsBound()))
+	if (!InstanceUpdatedHandles.Contains(Instance))
 	{
-		Error = EMutableExtensionRuntimeUpdateError::DelegateNotBound;
-		return false;
+		InstanceUpdatedHandles.Add(Instance, Instance->UpdatedNativeDelegate.AddUObject(this, &ThisClass::OnInstanceUpdated));
 	}
 
-	Error = EMutableExtensionRuntimeUpdateError::None;
-
-	if (IsPendingUpdate(Component))
+	// Whoever is generating it may give up, in which case UpdatedNativeDelegate never fires
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (Subsystem && !InstanceTimedOutHandle.IsValid())
 	{
-		// Error instead of doing the check for them, it is likely not intended that they come back here again so soon,
-		// so they should handle it themselves
-		
-		FMessageLog MessageLog {"PIE"};
-		const FString ErrorString = FString::Printf(TEXT("[ %s ] { %s } is already pending update. Please call UMutableExtensionComponent::IsPendingUpdate() before making this call."),
-			*FString(__FUNCTION__), *Component->CustomizableObjectInstance.GetName());
-		MessageLog.Error(FText::FromString(ErrorString));
+		InstanceTimedOutHandle = Subsystem->OnInstanceTimedOut.AddUObject(this, &ThisClass::OnInstanceTimedOut);
+	}
+}
 
-		Error = EMutableExtensionRuntimeUpdateError::AlreadyPendingUpdate;
-		return false;
+void UMutableExtensionComponent::OnInstanceUpdated(UCustomizableObjectInstance* UpdatedInstance)
+{
+	FDelegateHandle Handle;
+	if (InstanceUpdatedHandles.RemoveAndCopyValue(UpdatedInstance, Handle))
+	{
+		UpdatedInstance->UpdatedNativeDelegate.Remove(Handle);
 	}
 
-	if (!UMutableFunctionLib::IsMutableMeshValidToUpdate(Component))
+	const bool bSuccess = UpdatedInstance->GetPrivate()->SkeletalMeshStatus == ESkeletalMeshStatus::Success;
+	CompleteInstanceInitialization(UpdatedInstance, bSuccess);
+}
+
+void UMutableExtensionComponent::OnInstanceTimedOut(UCustomizableObjectInstance* Instance)
+{
+	FDelegateHandle Handle;
+	if (InstanceUpdatedHandles.RemoveAndCopyValue(Instance, Handle))
 	{
-		Error = EMutableExtensionRuntimeUpdateError::MeshNotValidToUpdate;
-		return false;
+		Instance->UpdatedNativeDelegate.Remove(Handle);
+		CompleteInstanceInitialization(Instance, false, 0.0, true);
 	}
+}
 
-	FMutablePendingRuntimeUpdate PendingUpdate { Component->CustomizableObjectInstance, Component, OwningComponent };
-	InstancesPendingRuntimeUpdate.Add(Component->CustomizableObjectInstance, PendingUpdate);
-	
-	FInstanceUpdateDelegate Delegate;
-	Delegate.BindDynamic(this, &ThisClass::OnMutableInstanceRuntimeUpdateCompleted);
-	UMutableFunctionLib::UpdateMutableMesh_Callback(Component, Delegate, bIgnoreCloseDist, bForceHighPriority);
+void UMutableExtensionComponent::OnMutableInstanceInitializationCompleted(const FMutableScheduledUpdate& Update)
+{
+	if (UCustomizableObjectInstance* Instance = Update.MutableInstance.Get())
+	{
+		const bool bSuccess = UMutableFunctionLib::IsUpdateResultValid(Update.UpdateResult);
 
-	return true;
+		// Progressive initialization only generated low detail, it is stored once refined
+		const uint64* DescriptorHash = InitializingDescriptorHashes.Find(Instance);
+		UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+		if (bUseDiskCache && bSuccess && DescriptorHash && Subsystem && !RefiningInstances.Contains(Instance))
+		{
+			Subsystem->WriteDiskCache(Instance, *DescriptorHash);
+		}
+
+		CompleteInstanceInitialization(Instance, bSuccess, Update.DispatchTime, Update.bTimedOut);
+	}
 }
 
-bool UMutableExtensionComponent::IsPendingUpdate(const UCustomizableSkeletalComponent* Component) const
+void UMutableExtensionComponent::CompleteInstanceInitialization(UCustomizableObjectInstance* Instance, bool bSuccess,
+	double DispatchTime, bool bTimedOut)
 {
-	return IsPendingUpdate(Component->CustomizableObjectInstance);
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::CompleteInstanceInitialization);
+
+	if (!InstancesPendingInitialization.Remove(Instance))
+	{
+		return;
+	}
+
+	uint64 DescriptorHash = 0;
+	if (InitializingDescriptorHashes.RemoveAndCopyValue(Instance, DescriptorHash) && bSuccess)
+	{
+		LastGeneratedDescriptorHashes.Add(Instance, DescriptorHash);
+	}
+
+	// We were the first with this descriptor, so anybody sharing it is waiting on us
+	if (GeneratingInstances.Remove(Instance) && bShareGeneratedInstances)
+	{
+		if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+		{
+			Subsystem->OnCachedInstanceGenerated(Instance, bSuccess, GetGeneratedResourceSize(Instance));
+		}
+	}
+
+	// Nothing to refine, the detail level was only lowered for the first generation
+	int32 MinLOD;
+	if (!bSuccess && RefiningInstances.RemoveAndCopyValue(Instance, MinLOD))
+	{
+		UMutableFunctionLib::SetInstanceMinLOD(Instance, MinLOD);
+	}
+
+	// Shared instances complete without passing through the scheduler
+	if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+	{
+		Subsystem->UpdateRegisteredInstance(Instance);
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	FMutableInstanceInitializationTiming& Timing = InitializationStats.Instances.AddDefaulted_GetRef();
+	Timing.Instance = Instance;
+	Timing.bSuccess = bSuccess;
+	Timing.bTimedOut = bTimedOut;
+	Timing.Latency = Now - InitializationStats.RequestTime;
+	Timing.GenerationTime = DispatchTime > 0.0 ? Now - DispatchTime : 0.f;
+
+	if (InstancesPendingInitialization.Num() == 0)
+	{
+		// Whatever finished last held everybody else up
+		InitializationStats.CriticalPathInstance = Instance;
+		InitializationStats.TotalTime = Timing.Latency;
+		InitializationStats.TimeToFullQuality = Timing.Latency;
+		if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+		{
+			Subsystem->NotifyInitializationCompleted(InitializationStats.TotalTime);
+		}
+		OnInitializationCompleted();
+		BeginRefinement();
+		FlushReplicatedUpdates();
+	}
 }
 
-bool UMutableExtensionComponent::IsPendingUpdate(const UCustomizableObjectInstance* Instance) const
+void UMutableExtensionComponent::OnInitializationCompleted()
 {
-	return InstancesPendingRuntimeUpdate.Contains(Instance);
+	// Updates are async, so this can be called a second time by another
+	if (OnMutableInitialized.IsBound())
+	{
+		OnMutableInitialized.Execute();
+		OnMutableInitialized.Unbind();
+	}
 }
 
-const FMutablePendingRuntimeUpdate* UMutableExtensionComponent::GetInstancePendingRuntimeUpdate(
-	const UCustomizableSkeletalComponent* Component) const
+void UMutableExtensionComponent::BeginRefinement()
 {
-	return GetInstancePendingRuntimeUpdate(Component->CustomizableObjectInstance);
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (RefiningInstances.Num() == 0 || !Subsystem)
+	{
+		return;
+	}
+
+	// A listener may have reset us already
+	const TMap<UCustomizableObjectInstance*, int32> Instances = RefiningInstances;
+	for (const TPair<UCustomizableObjectInstance*, int32>& Pair : Instances)
+	{
+		UCustomizableObjectInstance* Instance = Pair.Key;
+		UMutableFunctionLib::SetInstanceMinLOD(Instance, Pair.Value);
+
+		UCustomizableSkeletalComponent* const* Component = CachedInitializingComponents.FindByPredicate(
+			[Instance](const UCustomizableSkeletalComponent* MutableComponent)
+			{
+				return MutableComponent->CustomizableObjectInstance == Instance;
+			});
+
+		const FOnMutableScheduledUpdateCompleted Delegate = FOnMutableScheduledUpdateCompleted::CreateUObject(
+			this, &ThisClass::OnMutableInstanceRefinementCompleted);
+		Subsystem->EnqueueRefinement(Instance, Component ? *Component : nullptr, Delegate);
+	}
 }
 
-const FMutablePendingRuntimeUpdate* UMutableExtensionComponent::GetInstancePendingRuntimeUpdate(
-	const UCustomizableObjectInstance* Instance) const
+void UMutableExtensionComponent::OnMutableInstanceRefinementCompleted(const FMutableScheduledUpdate& Update)
 {
-	return InstancesPendingRuntimeUpdate.Find(Instance);
+	UCustomizableObjectInstance* Instance = Update.MutableInstance.Get();
+	if (!Instance || !RefiningInstances.Remove(Instance))
+	{
+		return;
+	}
+
+	// The low detail generation remains if refinement failed, there is nothing better to fall back to
+	if (!UMutableFunctionLib::IsUpdateResultValid(Update.UpdateResult))
+	{
+		UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] { %s } failed to generate at full detail: %s"),
+			*FString(__FUNCTION__), *GetNameSafe(Instance), *UMutableFunctionLib::GetUpdateResultAsString(Update.UpdateResult));
+	}
+	else if (bUseDiskCache)
+	{
+		UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+		const uint64* DescriptorHash = LastGeneratedDescriptorHashes.Find(Instance);
+		if (Subsystem && DescriptorHash)
+		{
+			Subsystem->WriteDiskCache(Instance, *DescriptorHash);
+		}
+	}
+
+	if (RefiningInstances.Num() == 0)
+	{
+		InitializationStats.TimeToFullQuality = FPlatformTime::Seconds() - InitializationStats.RequestTime;
+		OnMutableFullQualityNative.Broadcast();
+	}
 }
 
-void UMutableExtensionComponent::OnMutableInstanceRuntimeUpdateCompleted(const FUpdateContext& Result)
+void UMutableExtensionComponent::OnDiskCacheRead(EMutableDiskCacheRead Result, const TMap<int32, USkeletalMesh*>& Meshes,
+	UCustomizableObjectInstance* Instance, uint64 DescriptorHash)
 {
-	check(Result.Instance);
+	// Reset, or replaced by sharing, while reading
+	if (!DiskCacheReadingInstances.Remove(Instance) || !InstancesPendingInitialization.Contains(Instance))
+	{
+		return;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::OnDiskCacheRead);
+
+	if (Result != EMutableDiskCacheRead::Hit)
+	{
+		InitializeInstance(Instance, false);
+		return;
+	}
 
-	if (FMutablePendingRuntimeUpdate* PendingUpdate = InstancesPendingRuntimeUpdate.Find(Result.Instance))
+	for (const UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
 	{
-		if (InstancesPendingRuntimeUpdate.Contains(Result.Instance))
+		USkeletalMesh* SkeletalMesh = Component->CustomizableObjectInstance == Instance ?
+			Meshes.FindRef(Component->GetComponentIndex()) : nullptr;
+		if (SkeletalMesh)
 		{
-			PendingUpdate->UpdateResult = Result.UpdateResult;
+			UMutableFunctionLib::SetMeshAndOverrideMaterials(
+				UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(Component), SkeletalMesh, {});
+		}
+	}
+
+	InitializingDescriptorHashes.Add(Instance, DescriptorHash);
+	CompleteInstanceInitialization(Instance, true);
+}
+
+void UMutableExtensionComponent::ShareInstance(UCustomizableObjectInstance* Instance,
+	UCustomizableObjectInstance* SharedInstance)
+{
+	if (Instance == SharedInstance)
+	{
+		return;
+	}
 
-			InstancesPendingRuntimeUpdate.Remove(Result.Instance);
-			CallOnComponentRuntimeUpdateCompleted(*PendingUpdate);
+	for (UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+	{
+		if (Component->CustomizableObjectInstance == Instance)
+		{
+			Component->SetCustomizableObjectInstance(SharedInstance);
+			if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+			{
+				Subsystem->UpdateRegisteredComponent(Component);
+			}
 		}
 	}
+
+	// Another of our instances may already be waiting on the same shared instance
+	InstancesPendingInitialization.Remove(Instance);
+	InstancesPendingInitialization.Add(SharedInstance);
+	CachedInitializingInstances.Remove(Instance);
+	CachedInitializingInstances.AddUnique(SharedInstance);
+}
+
+UCustomizableObjectInstance* UMutableExtensionComponent::UnshareInstance(UCustomizableObjectInstance* SharedInstance)
+{
+	SharedInstances.Remove(SharedInstance);
+
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (!Subsystem || !Subsystem->IsCachedInstance(SharedInstance))
+	{
+		return SharedInstance;
+	}
+
+	// We're the only user, it is ours to change but no longer matches the descriptor it was cached with
+	if (Subsystem->GetCachedInstanceRefCount(SharedInstance) <= 1)
+	{
+		Subsystem->RemoveCachedInstance(SharedInstance);
+		return SharedInstance;
+	}
+
+	// The caller has likely already set parameters on the shared instance, so our copy takes them and the others
+	// are restored to the cached descriptor
+	UCustomizableObjectInstance* OwnInstance = SharedInstance->Clone();
+	Subsystem->RestoreCachedInstanceDescriptor(SharedInstance);
+	Subsystem->ReleaseCachedInstance(SharedInstance);
+	ReplaceInstance(SharedInstance, OwnInstance);
+
+	return OwnInstance;
 }
 
-void UMutableExtensionComponent::CallOnComponentRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& PendingUpdate) const
+void UMutableExtensionComponent::ReplaceInstance(UCustomizableObjectInstance* Instance,
+	UCustomizableObjectInstance* NewInstance)
 {
-	// Delay by a frame to be safe -- can it crash? Not yet tested
-	FTimerDelegate Delegate;
-	Delegate.BindLambda([&]()
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	for (UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+	{
+		if (Component->CustomizableObjectInstance == Instance)
+		{
+			Component->SetCustomizableObjectInstance(NewInstance);
+			if (Subsystem)
+			{
+				Subsystem->UpdateRegisteredComponent(Component);
+			}
+		}
+	}
+
+	FOnMutableExtensionRuntimeUpdateNative Subscribers;
+	if (InstanceRuntimeUpdateDelegates.RemoveAndCopyValue(Instance, Subscribers))
 	{
-		OnComponentRuntimeUpdateCompleted.ExecuteIfBound(PendingUpdate);
-	});
-	GetWorld()->GetTimerManager().SetTimerForNextTick(Delegate);
-}
\ No newline at end of file
+		InstanceRuntimeUpdateDelegates.Add(NewInstance, MoveTemp(Subscribers));
+	}
+
+	// The replication subscription moved with the others, so must its handle
+	FDelegateHandle ReplicatedUpdateHandle;
+	if (ReplicatedUpdateHandles.RemoveAndCopyValue(Instance, ReplicatedUpdateHandle))
+	{
+		ReplicatedUpdateHandles.Add(NewInstance, ReplicatedUpdateHandle);
+	}
+	double ReceiveTime;
+	if (ReplicatedReceiveTimes.RemoveAndCopyValue(Instance, ReceiveTime))
+	{
+		ReplicatedReceiveTimes.Add(NewInstance, ReceiveTime);
+	}
+
+	const int32 Index = CachedInitializingInstances.IndexOfByKey(Instance);
+	if (Index != INDEX_NONE)
+	{
+		CachedInitializingInstances[Index] = NewInstance;
+	}
+}
+
+void UMutableExtensionComponent::ReleaseInstance(UCustomizableObjectInstance* Instance,
+	UCustomizableObjectInstance* ReleasedInstance)
+{
+	ReplaceInstance(Instance, ReleasedInstance);
+
+	// Nothing is generated for the copy, unparking must regenerate it
+	LastGeneratedDescriptorHashes.Remove(Instance);
+}
+
+void UMutableExtensionComponent::ReleaseSharedInstances()
+{
+	if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+	{
+		for (UCustomizableObjectInstance* SharedInstance : SharedInstances)
+		{
+			Subsystem->ReleaseCachedInstance(SharedInstance);
+		}
+	}
+	SharedInstances.Reset();
+}
+
+int64 UMutableExtensionComponent::GetGeneratedResourceSize(const UCustomizableObjectInstance* Instance) const
+{
+	int64 SizeBytes = 0;
+	TSet<const USkeletalMeshComponent*> CountedComponents;
+	for (const UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+	{
+		if (Component->CustomizableObjectInstance != Instance)
+		{
+			continue;
+		}
+
+		bool bAlreadyCounted;
+		const USkeletalMeshComponent* MeshComponent = UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(Component);
+		CountedComponents.Add(MeshComponent, &bAlreadyCounted);
+		if (!bAlreadyCounted)
+		{
+			SizeBytes += UMutableFunctionLib::GetGeneratedResourceSize(MeshComponent);
+		}
+	}
+	return SizeBytes;
+}
+
+void UMutableExtensionComponent::BeginParameterTransaction()
+{
+	if (TransactionDepth++ > 0)
+	{
+		return;
+	}
+
+	TransactionBaseHashes.Reset();
+	for (UCustomizableObjectInstance* Instance : CachedInitializingInstances)
+	{
+		TransactionBaseHashes.Add(Instance, GetDescriptorHash(Instance));
+	}
+}
+
+int32 UMutableExtensionComponent::CommitParameterTransaction()
+{
+	if (!ensureAlways(TransactionDepth > 0) || --TransactionDepth > 0)
+	{
+		return 0;
+	}
+
+	// Anything that was edited without requesting an update still needs one
+	for (UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+	{
+		UCustomizableObjectInstance* Instance = Component->CustomizableObjectInstance;
+		const uint64* BaseHash = TransactionBaseHashes.Find(Instance);
+		if (!TransactionUpdates.Contains(Instance) && BaseHash && *BaseHash != GetDescriptorHash(Instance))
+		{
+			FMutableTransactionUpdate& TransactionUpdate = TransactionUpdates.Add(Instance);
+			TransactionUpdate.MutableComponent = Component;
+			TransactionUpdate.OwningComponent = UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(Component);
+		}
+	}
+
+	// Submitting can start another transaction from a completion callback
+	TMap<UCustomizableObjectInstance*, FMutableTransactionUpdate> Updates = MoveTemp(TransactionUpdates);
+	TransactionUpdates.Reset();
+	TransactionBaseHashes.Reset();
+
+	int32 NumSubmitted = 0;
+	for (const TPair<UCustomizableObjectInstance*, FMutableTransactionUpdate>& Pair : Updates)
+	{
+		const FMutableTransactionUpdate& TransactionUpdate = Pair.Value;
+		if (!IsValid(TransactionUpdate.MutableComponent))
+		{
+			continue;
+		}
+
+		// An instance that was edited without requesting an update still gets one completion for its listeners
+		const int32 NumRequests = FMath::Max(1, TransactionUpdate.NumRequests);
+
+		EMutableExtensionRuntimeUpdateError Error;
+		if (RequestRuntimeUpdate(TransactionUpdate.OwningComponent, TransactionUpdate.MutableComponent, Error,
+			TransactionUpdate.bIgnoreCloseDist, TransactionUpdate.bForceHighPriority, NumRequests))
+		{
+			NumSubmitted++;
+		}
+		else
+		{
+			UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] { %s } failed to submit runtime update for %d request(s): %s"),
+				*FString(__FUNCTION__), *GetNameSafe(Pair.Key), NumRequests,
+				*UMutableFunctionLib::ParseRuntimeUpdateError(Error, true));
+
+			// Every request in the transaction was accepted, so each is still owed a completion
+			FMutablePendingRuntimeUpdate RejectedUpdate { Pair.Key, TransactionUpdate.MutableComponent, TransactionUpdate.OwningComponent };
+			RejectedUpdate.UpdateResult = EUpdateResult::Error;
+			RejectedUpdate.Outcome = EMutableExtensionUpdateOutcome::Rejected;
+			RejectedUpdate.NumRequests = NumRequests;
+			RejectedUpdate.CompletedTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < NumRequests; i++)
+			{
+				QueueRuntimeUpdateCompleted(RejectedUpdate);
+			}
+		}
+	}
+	return NumSubmitted;
+}
+
+bool UMutableExtensionComponent::RuntimeUpdateMutableComponent(USkeletalMeshComponent* OwningComponent,
+	UCustomizableSkeletalComponent* Component, EMutableExtensionRuntimeUpdateError& Error, bool bIgnoreCloseDist, bool
+	bForceHighPriority)
+{
+	return RequestRuntimeUpdate(OwningComponent, Component, Error, bIgnoreCloseDist, bForceHighPriority, 1);
+}
+
+bool UMutableExtensionComponent::RequestRuntimeUpdate(USkeletalMeshComponent* OwningComponent,
+	UCustomizableSkeletalComponent* Component, EMutableExtensionRuntimeUpdateError& Error, bool bIgnoreCloseDist,
+	bool bForceHighPriority, int32 NumRequests)
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::RuntimeUpdateMutableComponent);
+
+	if (!ensureAlways(HasRuntimeUpdateListener(Component->CustomizableObjectInstance)))
+	{
+		Error = EMutableExtensionRuntimeUpdateError::DelegateNotBound;
+		return false;
+	}
+
+	Error = EMutableExtensionRuntimeUpdateError::None;
+
+	// Transactions replicate once, when they are committed
+	if (!IsInParameterTransaction())
+	{
+		ReplicateDescriptor(Component);
+	}
+
+	// Nothing is rendered, but listeners are still owed their completion
+	if (ShouldSkipGeneration())
+	{
+		FMutablePendingRuntimeUpdate SkippedUpdate { Component->CustomizableObjectInstance, Component, OwningComponent };
+		SkippedUpdate.UpdateResult = EUpdateResult::Success;
+		SkippedUpdate.Outcome = EMutableExtensionUpdateOutcome::ServerSkipped;
+		SkippedUpdate.NumRequests = NumRequests;
+		SkippedUpdate.CompletedTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumRequests; i++)
+		{
+			QueueRuntimeUpdateCompleted(SkippedUpdate);
+		}
+		return true;
+	}
+
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (!ensureAlways(Subsystem))
+	{
+		Error = EMutableExtensionRuntimeUpdateError::SchedulerUnavailable;
+		return false;
+	}
+
+	// Collected now and submitted once when the transaction is committed
+	if (IsInParameterTransaction())
+	{
+		// Fail now what would fail at commit anyway, while the caller can still handle it
+		if (!IsMeshValidToRuntimeUpdate(Component))
+		{
+			Error = EMutableExtensionRuntimeUpdateError::MeshNotValidToUpdate;
+			return false;
+		}
+
+		FMutableTransactionUpdate& TransactionUpdate = TransactionUpdates.FindOrAdd(Component->CustomizableObjectInstance);
+		TransactionUpdate.MutableComponent = Component;
+		TransactionUpdate.OwningComponent = OwningComponent;
+		TransactionUpdate.NumRequests += NumRequests;
+		TransactionUpdate.bIgnoreCloseDist |= bIgnoreCloseDist;
+		TransactionUpdate.bForceHighPriority |= bForceHighPriority;
+		return true;
+	}
+
+	if (bCoalesceRuntimeUpdates && IsPendingUpdate(Component))
+	{
+		FMutablePendingRuntimeUpdate& PendingUpdate = InstancesPendingRuntimeUpdate.FindChecked(Component->CustomizableObjectInstance);
+		PendingUpdate.NumRequests += NumRequests;
+		PendingUpdate.MutableComponent = Component;
+		PendingUpdate.OwningComponent = OwningComponent;
+
+		// While still queued the update hasn't read the parameters yet, so it will already use the latest ones
+		if (!Subsystem->IsQueued(Component->CustomizableObjectInstance))
+		{
+			PendingUpdate.bDirty = true;
+			PendingUpdate.bFollowUpIgnoreCloseDist |= bIgnoreCloseDist;
+			PendingUpdate.bFollowUpForceHighPriority |= bForceHighPriority;
+		}
+		return true;
+	}
+
+	if (bSupersedeRuntimeUpdates && IsPendingUpdate(Component))
+	{
+		CancelInstanceRuntimeUpdate(Component->CustomizableObjectInstance, true);
+	}
+
+	if (IsPendingUpdate(Component))
+	{
+		// Error instead of doing the check for them, it is likely not intended that they come back here again so soon,
+		// so they should handle it themselves
+		
+		FMessageLog MessageLog {"PIE"};
+		const FString ErrorString = FString::Printf(TEXT("[ %s ] { %s } is already pending update. Please call UMutableExtensionComponent::IsPendingUpdate() before making this call."),
+			*FString(__FUNCTION__), *Component->CustomizableObjectInstance.GetName());
+		MessageLog.Error(FText::FromString(ErrorString));
+
+		Error = EMutableExtensionRuntimeUpdateError::AlreadyPendingUpdate;
+		return false;
+	}
+
+	if (!IsMeshValidToRuntimeUpdate(Component))
+	{
+		Error = EMutableExtensionRuntimeUpdateError::MeshNotValidToUpdate;
+		return false;
+	}
+
+	// Nothing changed since the last successful update, don't pay for another generation
+	if (bSkipUnchangedRuntimeUpdates)
+	{
+		const uint64* LastHash = LastGeneratedDescriptorHashes.Find(Component->CustomizableObjectInstance);
+		if (LastHash && *LastHash == GetDescriptorHash(Component->CustomizableObjectInstance))
+		{
+			NumSkippedUnchangedUpdates++;
+			Subsystem->NotifyUpdateSkippedUnchanged();
+
+			FMutablePendingRuntimeUpdate SkippedUpdate { Component->CustomizableObjectInstance, Component, OwningComponent };
+			SkippedUpdate.UpdateResult = EUpdateResult::Success;
+			SkippedUpdate.Outcome = EMutableExtensionUpdateOutcome::Unchanged;
+			SkippedUpdate.NumRequests = NumRequests;
+			SkippedUpdate.CompletedTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < NumRequests; i++)
+			{
+				QueueRuntimeUpdateCompleted(SkippedUpdate);
+			}
+			return true;
+		}
+	}
+
+	if (CommitSpeculativeInstance(OwningComponent, Component, NumRequests))
+	{
+		return true;
+	}
+
+	// Changing a shared instance would change every actor using it
+	if (SharedInstances.Contains(Component->CustomizableObjectInstance))
+	{
+		UnshareInstance(Component->CustomizableObjectInstance);
+	}
+
+	FMutablePendingRuntimeUpdate PendingUpdate { Component->CustomizableObjectInstance, Component, OwningComponent };
+	PendingUpdate.NumRequests = NumRequests;
+	InstancesPendingRuntimeUpdate.Add(Component->CustomizableObjectInstance, PendingUpdate);
+
+	EnqueueRuntimeUpdate(Subsystem, OwningComponent, Component, bIgnoreCloseDist, bForceHighPriority);
+
+	return true;
+}
+
+void UMutableExtensionComponent::EnqueueRuntimeUpdate(UMutableExtensionSubsystem* Subsystem,
+	USkeletalMeshComponent* OwningComponent, UCustomizableSkeletalComponent* Component, bool bIgnoreCloseDist,
+	bool bForceHighPriority)
+{
+	const FOnMutableScheduledUpdateCompleted Delegate = FOnMutableScheduledUpdateCompleted::CreateUObject(
+		this, &ThisClass::OnMutableInstanceRuntimeUpdateCompleted);
+
+	UCustomizableObjectInstance* StagingInstance = bDeferMeshSwap ? CaptureMeshSwap(OwningComponent, Component) : nullptr;
+	if (StagingInstance)
+	{
+		Subsystem->EnqueueStagedUpdate(StagingInstance, Component, Delegate, bForceHighPriority);
+		return;
+	}
+
+	Subsystem->EnqueueUpdate(Component, Delegate, bIgnoreCloseDist, bForceHighPriority);
+}
+
+int32 UMutableExtensionComponent::AddSpeculativeCandidates(const UCustomizableSkeletalComponent* Component,
+	const TArray<TArray<uint8>>& Descriptors)
+{
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (!Subsystem || !Component || ShouldSkipGeneration())
+	{
+		return 0;
+	}
+	return Subsystem->AddSpeculativeCandidates(Component->CustomizableObjectInstance, Descriptors);
+}
+
+void UMutableExtensionComponent::ClearSpeculativeCandidates(const UCustomizableSkeletalComponent* Component)
+{
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (Subsystem && Component)
+	{
+		Subsystem->ClearSpeculativeCandidates(Component->CustomizableObjectInstance);
+	}
+}
+
+bool UMutableExtensionComponent::CommitSpeculativeInstance(USkeletalMeshComponent* OwningComponent,
+	UCustomizableSkeletalComponent* Component, int32 NumRequests)
+{
+	UCustomizableObjectInstance* Instance = Component->CustomizableObjectInstance;
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (!Subsystem || !Subsystem->HasSpeculativeCandidates(Instance))
+	{
+		return false;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::CommitSpeculativeInstance);
+
+	const uint64 DescriptorHash = GetDescriptorHash(Instance);
+	UCustomizableObjectInstance* Speculative = Subsystem->TakeSpeculativeInstance(Instance, DescriptorHash);
+	if (!Speculative)
+	{
+		return false;
+	}
+
+	// Anybody else sharing the instance keeps it as it was cached, the same as UnshareInstance()
+	if (SharedInstances.Remove(Instance) && Subsystem->IsCachedInstance(Instance))
+	{
+		Subsystem->RestoreCachedInstanceDescriptor(Instance);
+		Subsystem->ReleaseCachedInstance(Instance);
+	}
+
+	ReplaceInstance(Instance, Speculative);
+	LastGeneratedDescriptorHashes.Remove(Instance);
+	LastGeneratedDescriptorHashes.Add(Speculative, DescriptorHash);
+
+	// Already generated, so bind it now rather than waiting on Mutable to notice the instance changed
+	for (const UCustomizableSkeletalComponent* SpeculativeComponent : CachedInitializingComponents)
+	{
+		USkeletalMesh* SkeletalMesh = SpeculativeComponent->CustomizableObjectInstance == Speculative ?
+			Speculative->GetSkeletalMesh(SpeculativeComponent->GetComponentIndex()) : nullptr;
+		if (SkeletalMesh)
+		{
+			UMutableFunctionLib::SetMeshAndOverrideMaterials(
+				UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(SpeculativeComponent), SkeletalMesh, {});
+		}
+	}
+
+	UE_LOG(LogMutableExtension, Verbose, TEXT("[ %s ] { %s } committed speculative instance %s"),
+		*FString(__FUNCTION__), *GetNameSafe(GetOwner()), *GetNameSafe(Speculative));
+
+	FMutablePendingRuntimeUpdate SpeculatedUpdate { Speculative, Component, OwningComponent };
+	SpeculatedUpdate.UpdateResult = EUpdateResult::Success;
+	SpeculatedUpdate.Outcome = EMutableExtensionUpdateOutcome::Speculated;
+	SpeculatedUpdate.NumRequests = NumRequests;
+	SpeculatedUpdate.CompletedTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumRequests; i++)
+	{
+		QueueRuntimeUpdateCompleted(SpeculatedUpdate);
+	}
+	return true;
+}
+
+bool UMutableExtensionComponent::CancelRuntimeUpdate(const UCustomizableSkeletalComponent* Component)
+{
+	return Component && CancelInstanceRuntimeUpdate(Component->CustomizableObjectInstance, true);
+}
+
+int32 UMutableExtensionComponent::CancelRuntimeUpdates()
+{
+	TArray<UCustomizableObjectInstance*> Instances;
+	InstancesPendingRuntimeUpdate.GenerateKeyArray(Instances);
+
+	int32 NumCancelled = 0;
+	for (UCustomizableObjectInstance* Instance : Instances)
+	{
+		NumCancelled += CancelInstanceRuntimeUpdate(Instance, true) ? 1 : 0;
+	}
+	return NumCancelled;
+}
+
+bool UMutableExtensionComponent::CancelInstanceRuntimeUpdate(UCustomizableObjectInstance* Instance, bool bNotifyListeners)
+{
+	FMutablePendingRuntimeUpdate CancelledUpdate;
+	if (!InstancesPendingRuntimeUpdate.RemoveAndCopyValue(Instance, CancelledUpdate))
+	{
+		return false;
+	}
+
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (Subsystem)
+	{
+		Subsystem->CancelUpdates(Instance);
+	}
+
+	// An abandoned update may still change the mesh, so it can no longer be assumed to match
+	LastGeneratedDescriptorHashes.Remove(Instance);
+
+	// Nothing will be staged, but a mesh generated earlier may still be waiting
+	if (FMutableMeshSwap* MeshSwap = MeshSwaps.Find(CancelledUpdate.OwningComponent))
+	{
+		if (MeshSwap->GeneratingInstance && Subsystem)
+		{
+			Subsystem->CancelUpdates(MeshSwap->GeneratingInstance);
+		}
+		MeshSwap->GeneratingInstance = nullptr;
+
+		if (!MeshSwap->IsStaged())
+		{
+			MeshSwaps.Remove(CancelledUpdate.OwningComponent);
+		}
+	}
+
+	if (bNotifyListeners)
+	{
+		CancelledUpdate.UpdateResult = EUpdateResult::Error;
+		CancelledUpdate.Outcome = EMutableExtensionUpdateOutcome::Cancelled;
+		CancelledUpdate.CompletedTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < CancelledUpdate.NumRequests; i++)
+		{
+			QueueRuntimeUpdateCompleted(CancelledUpdate);
+		}
+	}
+	return true;
+}
+
+void UMutableExtensionComponent::CancelScheduledWork()
+{
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	for (const UCustomizableObjectInstance* Instance : InstancesPendingInitialization)
+	{
+		Subsystem->CancelUpdates(Instance);
+	}
+
+	for (const TPair<UCustomizableObjectInstance*, int32>& Pair : RefiningInstances)
+	{
+		Subsystem->CancelUpdates(Pair.Key);
+	}
+
+	for (const TPair<UCustomizableObjectInstance*, FMutablePendingRuntimeUpdate>& Pair : InstancesPendingRuntimeUpdate)
+	{
+		Subsystem->CancelUpdates(Pair.Key);
+	}
+
+	for (const TPair<USkeletalMeshComponent*, FMutableMeshSwap>& Pair : MeshSwaps)
+	{
+		if (Pair.Value.GeneratingInstance)
+		{
+			Subsystem->CancelUpdates(Pair.Value.GeneratingInstance);
+		}
+	}
+}
+
+bool UMutableExtensionComponent::IsMeshSwapPending(const USkeletalMeshComponent* OwningComponent) const
+{
+	const FMutableMeshSwap* MeshSwap = MeshSwaps.Find(OwningComponent);
+	return MeshSwap && MeshSwap->IsStaged();
+}
+
+UCustomizableObjectInstance* UMutableExtensionComponent::CaptureMeshSwap(USkeletalMeshComponent* OwningComponent,
+	UCustomizableSkeletalComponent* Component)
+{
+	if (!IsValid(OwningComponent) || !IsValid(Component->CustomizableObjectInstance))
+	{
+		return nullptr;
+	}
+
+	// A mesh that is already staged keeps waiting, it is replaced once this one is generated
+	FMutableMeshSwap& MeshSwap = MeshSwaps.FindOrAdd(OwningComponent);
+	MeshSwap.MutableComponent = Component;
+
+	if (MeshSwap.GeneratingInstance)
+	{
+		if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+		{
+			Subsystem->CancelUpdates(MeshSwap.GeneratingInstance);
+		}
+	}
+
+	MeshSwap.GeneratingInstance = Component->CustomizableObjectInstance->Clone();
+	return MeshSwap.GeneratingInstance;
+}
+
+UCustomizableObjectInstance* UMutableExtensionComponent::GetRuntimeUpdateInstance(
+	UCustomizableObjectInstance* GeneratedInstance) const
+{
+	for (const TPair<USkeletalMeshComponent*, FMutableMeshSwap>& Pair : MeshSwaps)
+	{
+		if (Pair.Value.GeneratingInstance == GeneratedInstance)
+		{
+			return IsValid(Pair.Value.MutableComponent) ? Pair.Value.MutableComponent->CustomizableObjectInstance : nullptr;
+		}
+	}
+	return GeneratedInstance;
+}
+
+bool UMutableExtensionComponent::StageMeshSwap(const FMutablePendingRuntimeUpdate& CompletedUpdate,
+	UCustomizableObjectInstance* GeneratedInstance)
+{
+	USkeletalMeshComponent* OwningComponent = CompletedUpdate.OwningComponent;
+	FMutableMeshSwap* MeshSwap = IsValid(OwningComponent) ? MeshSwaps.Find(OwningComponent) : nullptr;
+	if (!MeshSwap || !GeneratedInstance || MeshSwap->GeneratingInstance != GeneratedInstance)
+	{
+		return false;
+	}
+	MeshSwap->GeneratingInstance = nullptr;
+
+	// Nothing was bound, so on failure the previous mesh simply stays
+	const UCustomizableSkeletalComponent* MutableComponent = CompletedUpdate.MutableComponent;
+	USkeletalMesh* NewMesh = UMutableFunctionLib::IsUpdateResultValid(CompletedUpdate.UpdateResult) && IsValid(MutableComponent) ?
+		GeneratedInstance->GetSkeletalMesh(MutableComponent->GetComponentIndex()) : nullptr;
+	if (!NewMesh)
+	{
+		if (!MeshSwap->IsStaged())
+		{
+			MeshSwaps.Remove(OwningComponent);
+		}
+		return false;
+	}
+
+	if (!MeshSwap->IsStaged())
+	{
+		NumStagedMeshSwaps++;
+	}
+
+	MeshSwap->StagedInstance = GeneratedInstance;
+	MeshSwap->NewMesh = NewMesh;
+	MeshSwap->NewMaterials.Reset();
+	for (const FSkeletalMaterial& Material : NewMesh->GetMaterials())
+	{
+		MeshSwap->NewMaterials.Add(Material.MaterialInterface);
+	}
+	MeshSwap->StagedTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < CompletedUpdate.NumRequests; i++)
+	{
+		MeshSwap->Completions.Add(CompletedUpdate);
+	}
+
+	if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld()))
+	{
+		Subsystem->EnqueueMeshSwap(this, MeshSwap->NewMaterials);
+	}
+	return true;
+}
+
+void UMutableExtensionComponent::BindStagedInstance(FMutableMeshSwap& MeshSwap)
+{
+	UCustomizableObjectInstance* StagedInstance = MeshSwap.StagedInstance;
+	UCustomizableObjectInstance* Instance = IsValid(MeshSwap.MutableComponent) ? MeshSwap.MutableComponent->CustomizableObjectInstance : nullptr;
+	MeshSwap.StagedInstance = nullptr;
+	MeshSwap.NewMesh = nullptr;
+	MeshSwap.NewMaterials.Reset();
+
+	if (!IsValid(StagedInstance) || !Instance || Instance == StagedInstance)
+	{
+		return;
+	}
+
+	// Bound before the instance is replaced, so Mutable finds every generated mesh already bound
+	for (const UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+	{
+		USkeletalMesh* SkeletalMesh = Component->CustomizableObjectInstance == Instance ?
+			StagedInstance->GetSkeletalMesh(Component->GetComponentIndex()) : nullptr;
+		if (SkeletalMesh)
+		{
+			UMutableFunctionLib::SetMeshAndOverrideMaterials(
+				UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(Component), SkeletalMesh, {});
+		}
+	}
+
+	ReplaceInstance(Instance, StagedInstance);
+
+	uint64 DescriptorHash;
+	if (LastGeneratedDescriptorHashes.RemoveAndCopyValue(Instance, DescriptorHash))
+	{
+		LastGeneratedDescriptorHashes.Add(StagedInstance, DescriptorHash);
+	}
+
+	// A newer request is generating from the replaced instance, it now completes for the staged one
+	FMutablePendingRuntimeUpdate PendingUpdate;
+	if (InstancesPendingRuntimeUpdate.RemoveAndCopyValue(Instance, PendingUpdate))
+	{
+		PendingUpdate.MutableInstance = StagedInstance;
+		InstancesPendingRuntimeUpdate.Add(StagedInstance, PendingUpdate);
+	}
+
+	for (FMutablePendingRuntimeUpdate& Completion : MeshSwap.Completions)
+	{
+		Completion.MutableInstance = StagedInstance;
+	}
+}
+
+int32 UMutableExtensionComponent::ApplyReadyMeshSwaps(int32 MaxSwaps, float MaxWaitSeconds)
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::ApplyReadyMeshSwaps);
+
+	const double Now = FPlatformTime::Seconds();
+	TArray<FMutablePendingRuntimeUpdate> Completions;
+	int32 NumSwapped = 0;
+	for (auto It = MeshSwaps.CreateIterator(); It && NumSwapped < MaxSwaps; ++It)
+	{
+		FMutableMeshSwap& MeshSwap = It.Value();
+		if (!MeshSwap.IsStaged())
+		{
+			continue;
+		}
+
+		const bool bWaitedTooLong = Now - MeshSwap.StagedTime >= MaxWaitSeconds;
+		if (!bWaitedTooLong && !UMutableFunctionLib::AreMaterialTexturesStreamedIn(MeshSwap.NewMaterials))
+		{
+			continue;
+		}
+
+		BindStagedInstance(MeshSwap);
+		Completions.Append(MoveTemp(MeshSwap.Completions));
+		MeshSwap.Completions.Reset();
+		NumStagedMeshSwaps--;
+		NumSwapped++;
+
+		// A newer runtime update is still generating
+		if (!MeshSwap.GeneratingInstance)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// Listeners may request another update, which would capture into MeshSwaps
+	for (const FMutablePendingRuntimeUpdate& Completion : Completions)
+	{
+		CallOnComponentRuntimeUpdateCompleted(Completion);
+	}
+	return NumSwapped;
+}
+
+void UMutableExtensionComponent::FlushMeshSwaps()
+{
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	for (TPair<USkeletalMeshComponent*, FMutableMeshSwap>& Pair : MeshSwaps)
+	{
+		if (Pair.Value.GeneratingInstance && Subsystem)
+		{
+			Subsystem->CancelUpdates(Pair.Value.GeneratingInstance);
+		}
+
+		if (Pair.Value.IsStaged())
+		{
+			BindStagedInstance(Pair.Value);
+		}
+	}
+	MeshSwaps.Reset();
+	NumStagedMeshSwaps = 0;
+}
+
+bool UMutableExtensionComponent::IsPendingUpdate(const UCustomizableSkeletalComponent* Component) const
+{
+	return IsPendingUpdate(Component->CustomizableObjectInstance);
+}
+
+bool UMutableExtensionComponent::IsPendingUpdate(const UCustomizableObjectInstance* Instance) const
+{
+	return InstancesPendingRuntimeUpdate.Contains(Instance);
+}
+
+const FMutablePendingRuntimeUpdate* UMutableExtensionComponent::GetInstancePendingRuntimeUpdate(
+	const UCustomizableSkeletalComponent* Component) const
+{
+	return GetInstancePendingRuntimeUpdate(Component->CustomizableObjectInstance);
+}
+
+const FMutablePendingRuntimeUpdate* UMutableExtensionComponent::GetInstancePendingRuntimeUpdate(
+	const UCustomizableObjectInstance* Instance) const
+{
+	return InstancesPendingRuntimeUpdate.Find(Instance);
+}
+
+void UMutableExtensionComponent::OnMutableInstanceRuntimeUpdateCompleted(const FMutableScheduledUpdate& Update)
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::OnMutableInstanceRuntimeUpdateCompleted);
+
+	// A deferred mesh swap generates a copy, the update is pending for the instance it was copied from
+	UCustomizableObjectInstance* GeneratedInstance = Update.MutableInstance.Get();
+	UCustomizableObjectInstance* Instance = GeneratedInstance ? GetRuntimeUpdateInstance(GeneratedInstance) : nullptr;
+	if (!Instance)
+	{
+		return;
+	}
+
+	FMutablePendingRuntimeUpdate* PendingUpdate = InstancesPendingRuntimeUpdate.Find(Instance);
+	if (!PendingUpdate)
+	{
+		return;
+	}
+
+	// Parameters changed while this update was in flight, the result is stale so nobody is told about it
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+	if (PendingUpdate->bDirty && bSkipUnchangedRuntimeUpdates &&
+		Update.DescriptorHash == GetDescriptorHash(Instance))
+	{
+		// The coalesced requests didn't actually change anything
+		PendingUpdate->bDirty = false;
+	}
+
+	if (PendingUpdate->bDirty && Subsystem && IsValid(PendingUpdate->MutableComponent))
+	{
+		PendingUpdate->bDirty = false;
+
+		EnqueueRuntimeUpdate(Subsystem, PendingUpdate->OwningComponent, PendingUpdate->MutableComponent,
+			PendingUpdate->bFollowUpIgnoreCloseDist, PendingUpdate->bFollowUpForceHighPriority);
+		return;
+	}
+
+	PendingUpdate->UpdateResult = Update.UpdateResult;
+	PendingUpdate->Outcome = Update.bTimedOut ? EMutableExtensionUpdateOutcome::TimedOut : EMutableExtensionUpdateOutcome::Generated;
+	PendingUpdate->CompletedTime = Update.CompleteTime;
+	if (UMutableFunctionLib::IsUpdateResultValid(Update.UpdateResult))
+	{
+		LastGeneratedDescriptorHashes.Add(Instance, Update.DescriptorHash);
+	}
+	else
+	{
+		LastGeneratedDescriptorHashes.Remove(Instance);
+	}
+
+	// Copy out before removing, listeners must never see a reference into the map
+	FMutablePendingRuntimeUpdate CompletedUpdate;
+	InstancesPendingRuntimeUpdate.RemoveAndCopyValue(Instance, CompletedUpdate);
+
+	// The previous mesh stays bound and listeners are told once the new one replaces it
+	if (StageMeshSwap(CompletedUpdate, GeneratedInstance))
+	{
+		return;
+	}
+
+	// Every caller that was coalesced into this update receives one completion
+	for (int32 i = 0; i < CompletedUpdate.NumRequests; i++)
+	{
+		CallOnComponentRuntimeUpdateCompleted(CompletedUpdate);
+	}
+}
+
+FDelegateHandle UMutableExtensionComponent::SubscribeToRuntimeUpdate(const UCustomizableObjectInstance* Instance,
+	FOnMutableExtensionRuntimeUpdateNative::FDelegate&& Delegate)
+{
+	return InstanceRuntimeUpdateDelegates.FindOrAdd(Instance).Add(MoveTemp(Delegate));
+}
+
+void UMutableExtensionComponent::UnsubscribeFromRuntimeUpdate(const UCustomizableObjectInstance* Instance,
+	FDelegateHandle Handle)
+{
+	if (FOnMutableExtensionRuntimeUpdateNative* Delegate = InstanceRuntimeUpdateDelegates.Find(Instance))
+	{
+		Delegate->Remove(Handle);
+		if (!Delegate->IsBound())
+		{
+			InstanceRuntimeUpdateDelegates.Remove(Instance);
+		}
+	}
+}
+
+bool UMutableExtensionComponent::HasRuntimeUpdateListener(const UCustomizableObjectInstance* Instance) const
+{
+	if (OnComponentRuntimeUpdateCompleted.IsBound() || OnRuntimeUpdateCompletedNative.IsBound())
+	{
+		return true;
+	}
+
+	const FOnMutableExtensionRuntimeUpdateNative* Delegate = InstanceRuntimeUpdateDelegates.Find(Instance);
+	return Delegate && Delegate->IsBound();
+}
+
+void UMutableExtensionComponent::CallOnComponentRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& PendingUpdate)
+{
+	if (CompletionDelivery == EMutableExtensionCompletionDelivery::Immediate)
+	{
+		BroadcastRuntimeUpdateCompleted(PendingUpdate);
+		return;
+	}
+
+	QueueRuntimeUpdateCompleted(PendingUpdate);
+}
+
+void UMutableExtensionComponent::QueueRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& PendingUpdate)
+{
+	// Queued by value, the pending update no longer exists by the time it is delivered
+	if (QueuedCompletions.Num() == 0)
+	{
+		EndOfFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &ThisClass::DeliverQueuedCompletions);
+	}
+	QueuedCompletions.Add(PendingUpdate);
+}
+
+void UMutableExtensionComponent::DeliverQueuedCompletions()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndOfFrameHandle);
+	EndOfFrameHandle.Reset();
+
+	// Listeners can request further updates that complete and queue again
+	TArray<FMutablePendingRuntimeUpdate> Completions = MoveTemp(QueuedCompletions);
+	QueuedCompletions.Reset();
+	for (const FMutablePendingRuntimeUpdate& Completion : Completions)
+	{
+		BroadcastRuntimeUpdateCompleted(Completion);
+	}
+}
+
+void UMutableExtensionComponent::BroadcastRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& PendingUpdate) const
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::BroadcastRuntimeUpdateCompleted);
+	MUTABLE_EXTENSION_TRACE(RecordCompletionLatency, FPlatformTime::Seconds() - PendingUpdate.CompletedTime);
+
+	OnComponentRuntimeUpdateCompleted.ExecuteIfBound(PendingUpdate);
+	OnRuntimeUpdateCompletedNative.Broadcast(PendingUpdate);
+
+	if (const FOnMutableExtensionRuntimeUpdateNative* Delegate = InstanceRuntimeUpdateDelegates.Find(PendingUpdate.MutableInstance))
+	{
+		Delegate->Broadcast(PendingUpdate);
+	}
+}
+
+void UMutableExtensionComponent::ReplicateDescriptor(const UCustomizableSkeletalComponent* Component)
+{
+	if (!bReplicateDescriptors || GetOwnerRole() != ROLE_Authority)
+	{
+		return;
+	}
+
+	const int32 ComponentIndex = CachedInitializingComponents.IndexOfByKey(Component);
+	if (ComponentIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::ReplicateDescriptor);
+
+	int64 NumBits = 0;
+	const int32 NumChanged = ReplicatedDescriptor.Capture(Component->CustomizableObjectInstance, ComponentIndex, NumBits,
+		ReplicationPrecision);
+	if (NumChanged > 0)
+	{
+		ReplicationStats.NumChangesSent++;
+		ReplicationStats.NumParametersSent += NumChanged;
+		ReplicationStats.TotalBitsSent += NumBits;
+		ReplicationStats.AverageBitsPerChange = static_cast<double>(ReplicationStats.TotalBitsSent) / ReplicationStats.NumChangesSent;
+	}
+}
+
+UCustomizableSkeletalComponent* UMutableExtensionComponent::ApplyReplicatedParameter(
+	const FMutableReplicatedParameter& Parameter)
+{
+	if (!CachedInitializingComponents.IsValidIndex(Parameter.ComponentIndex))
+	{
+		return nullptr;
+	}
+
+	UCustomizableSkeletalComponent* Component = CachedInitializingComponents[Parameter.ComponentIndex];
+	if (!Component || !Component->CustomizableObjectInstance)
+	{
+		return nullptr;
+	}
+
+	// Changing a shared instance would change every actor using it
+	if (SharedInstances.Contains(Component->CustomizableObjectInstance))
+	{
+		UnshareInstance(Component->CustomizableObjectInstance);
+	}
+
+	Parameter.Apply(Component->CustomizableObjectInstance);
+	return Component;
+}
+
+void UMutableExtensionComponent::ApplyReplicatedParameters(const TArrayView<int32>& Indices)
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::ApplyReplicatedParameters);
+
+	const double Now = FPlatformTime::Seconds();
+	int32 NumApplied = 0;
+	for (const int32 Index : Indices)
+	{
+		UCustomizableSkeletalComponent* Component = ApplyReplicatedParameter(ReplicatedDescriptor.Parameters[Index]);
+		if (!Component)
+		{
+			continue;
+		}
+
+		NumApplied++;
+		ComponentsPendingReplicatedUpdate.AddUnique(Component);
+		ReplicatedReceiveTimes.FindOrAdd(Component->CustomizableObjectInstance, Now);
+	}
+
+	if (NumApplied > 0)
+	{
+		ReplicationStats.NumChangesReceived++;
+		ReplicationStats.NumParametersReceived += NumApplied;
+		FlushReplicatedUpdates();
+	}
+}
+
+void UMutableExtensionComponent::ApplyReplicatedDescriptor()
+{
+	for (const FMutableReplicatedParameter& Parameter : ReplicatedDescriptor.Parameters)
+	{
+		ApplyReplicatedParameter(Parameter);
+	}
+
+	// Initialization will generate with these
+	ComponentsPendingReplicatedUpdate.Reset();
+	ReplicatedReceiveTimes.Reset();
+}
+
+void UMutableExtensionComponent::FlushReplicatedUpdates()
+{
+	// Initialization reads the descriptors when it is dispatched, anything received later is flushed once it completes
+	if (!HasMutableInitialized())
+	{
+		return;
+	}
+
+	const TArray<UCustomizableSkeletalComponent*> Components = ComponentsPendingReplicatedUpdate;
+	for (UCustomizableSkeletalComponent* Component : Components)
+	{
+		UCustomizableObjectInstance* Instance = IsValid(Component) ? Component->CustomizableObjectInstance.Get() : nullptr;
+		if (!Instance)
+		{
+			ComponentsPendingReplicatedUpdate.Remove(Component);
+			continue;
+		}
+
+		// Also how we find out that a pending update completed
+		if (!ReplicatedUpdateHandles.Contains(Instance))
+		{
+			ReplicatedUpdateHandles.Add(Instance, SubscribeToRuntimeUpdate(Instance,
+				FOnMutableExtensionRuntimeUpdateNative::FDelegate::CreateUObject(this, &ThisClass::OnReplicatedRuntimeUpdateCompleted)));
+		}
+
+		// Picked up again when the pending update completes
+		if (IsPendingUpdate(Component) && !bCoalesceRuntimeUpdates && !bSupersedeRuntimeUpdates)
+		{
+			continue;
+		}
+
+		ComponentsPendingReplicatedUpdate.Remove(Component);
+
+		// Already generated with these parameters, most likely by initialization
+		const uint64* LastHash = LastGeneratedDescriptorHashes.Find(Instance);
+		if (LastHash && *LastHash == GetDescriptorHash(Instance))
+		{
+			ReplicatedReceiveTimes.Remove(Instance);
+			continue;
+		}
+
+		EMutableExtensionRuntimeUpdateError Error;
+		if (!RuntimeUpdateMutableComponent(UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(Component), Component, Error))
+		{
+			ReplicatedReceiveTimes.Remove(Instance);
+			UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] { %s } failed to apply replicated parameters: %s"),
+				*FString(__FUNCTION__), *GetNameSafe(Instance), *UMutableFunctionLib::ParseRuntimeUpdateError(Error, false));
+		}
+	}
+}
+
+void UMutableExtensionComponent::OnReplicatedRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& Update)
+{
+	double ReceiveTime;
+	if (ReplicatedReceiveTimes.RemoveAndCopyValue(Update.MutableInstance, ReceiveTime))
+	{
+		const double Latency = FPlatformTime::Seconds() - ReceiveTime;
+		ReplicationStats.NumUpdatesApplied++;
+		ReplicationStats.TotalApplyLatency += Latency;
+		ReplicationStats.AverageApplyLatency = ReplicationStats.TotalApplyLatency / ReplicationStats.NumUpdatesApplied;
+		ReplicationStats.MaxApplyLatency = FMath::Max<float>(ReplicationStats.MaxApplyLatency, Latency);
+	}
+
+	// Parameters received while this update was pending
+	if (ComponentsPendingReplicatedUpdate.Num() > 0)
+	{
+		FlushReplicatedUpdates();
+	}
+}
+
+bool UMutableExtensionComponent::ParkMutable()
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::ParkMutable);
+
+	if (IsParked())
+	{
+		return true;
+	}
+
+	// Half initialized state isn't worth keeping, it would have to be regenerated anyway
+	if (!HasMutableInitialized())
+	{
+		ResetMutableInitialization();
+		return false;
+	}
+
+	CancelRuntimeUpdates();
+	TransactionDepth = 0;
+	TransactionBaseHashes.Reset();
+	TransactionUpdates.Reset();
+	FlushMeshSwaps();
+
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+
+	// Only generated at low detail, so regenerate it when unparked rather than refining in the pool
+	for (const TPair<UCustomizableObjectInstance*, int32>& Pair : RefiningInstances)
+	{
+		if (Subsystem)
+		{
+			Subsystem->CancelUpdates(Pair.Key);
+		}
+		UMutableFunctionLib::SetInstanceMinLOD(Pair.Key, Pair.Value);
+		LastGeneratedDescriptorHashes.Remove(Pair.Key);
+	}
+	RefiningInstances.Reset();
+
+	if (Subsystem)
+	{
+		for (const UCustomizableObjectInstance* Instance : CachedInitializingInstances)
+		{
+			Subsystem->ClearSpeculativeCandidates(Instance);
+		}
+		Subsystem->NotifyParked();
+	}
+
+	// Whatever was received while parked is in the descriptors, and compared when unparked
+	ComponentsPendingReplicatedUpdate.Reset();
+	ReplicatedReceiveTimes.Reset();
+
+	bParked = true;
+	PoolStats.NumParks++;
+	return true;
+}
+
+FOnMutableExtensionSimpleDelegate& UMutableExtensionComponent::UnparkMutable()
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::UnparkMutable);
+
+	if (!IsParked())
+	{
+		return OnMutableInitialized;
+	}
+
+	bParked = false;
+	InitializationStats = {};
+	InitializationStats.RequestTime = FPlatformTime::Seconds();
+
+	// Nothing is ready until BeginUnpark() has compared descriptors
+	for (UCustomizableObjectInstance* Instance : CachedInitializingInstances)
+	{
+		InstancesPendingInitialization.Add(Instance);
+	}
+
+	GetWorld()->GetTimerManager().SetTimerForNextTick(this, &ThisClass::BeginUnpark);
+
+	return OnMutableInitialized;
+}
+
+bool UMutableExtensionComponent::CanUnpark(const TArray<UCustomizableSkeletalComponent*>& MutableComponents) const
+{
+	int32 NumComponents = 0;
+	for (const UCustomizableSkeletalComponent* Component : MutableComponents)
+	{
+		// Ignored by RequestMutableInitialization() too
+		if (!Component->CustomizableObjectInstance)
+		{
+			continue;
+		}
+
+		if (!CachedInitializingComponents.Contains(Component) ||
+			!CachedInitializingInstances.Contains(Component->CustomizableObjectInstance))
+		{
+			return false;
+		}
+		NumComponents++;
+	}
+	return NumComponents == CachedInitializingComponents.Num();
+}
+
+void UMutableExtensionComponent::BeginUnpark()
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionComponent::BeginUnpark);
+
+	// Reset or parked again before we got here
+	if (IsParked() || InstancesPendingInitialization.Num() == 0)
+	{
+		return;
+	}
+
+	if (bReplicateDescriptors && GetOwnerRole() == ROLE_Authority)
+	{
+		for (const UCustomizableSkeletalComponent* Component : CachedInitializingComponents)
+		{
+			ReplicateDescriptor(Component);
+		}
+	}
+
+	if (ShouldSkipGeneration())
+	{
+		SkipMutableInitialization();
+		return;
+	}
+
+	UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(GetWorld());
+
+	// Decide for every instance before completing any, completion can reset us
+	TArray<UCustomizableObjectInstance*> ReusedInstances;
+	TArray<UCustomizableObjectInstance*> ChangedInstances;
+	for (UCustomizableObjectInstance* Instance : CachedInitializingInstances)
+	{
+		const uint64* LastHash = LastGeneratedDescriptorHashes.Find(Instance);
+		const bool bReleased = Subsystem && Subsystem->IsInstanceReleased(Instance);
+		if (LastHash && !bReleased && *LastHash == GetDescriptorHash(Instance))
+		{
+			ReusedInstances.Add(Instance);
+		}
+		else
+		{
+			ChangedInstances.Add(Instance);
+		}
+	}
+
+	PoolStats.RecordUnpark(ReusedInstances.Num(), ChangedInstances.Num());
+	if (Subsystem)
+	{
+		Subsystem->NotifyUnparked(ReusedInstances.Num(), ChangedInstances.Num());
+	}
+
+	for (UCustomizableObjectInstance* Instance : ChangedInstances)
+	{
+		// Anybody else sharing it keeps what was generated
+		if (SharedInstances.Contains(Instance))
+		{
+			UCustomizableObjectInstance* OwnInstance = UnshareInstance(Instance);
+			InstancesPendingInitialization.Remove(Instance);
+			InstancesPendingInitialization.Add(OwnInstance);
+			Instance = OwnInstance;
+		}
+
+		LastGeneratedDescriptorHashes.Remove(Instance);
+		InitializingDescriptorHashes.Add(Instance, GetDescriptorHash(Instance));
+
+		UCustomizableSkeletalComponent* const* Component = CachedInitializingComponents.FindByPredicate(
+			[Instance](const UCustomizableSkeletalComponent* MutableComponent)
+			{
+				return MutableComponent->CustomizableObjectInstance == Instance;
+			});
+
+		if (ensureAlways(Subsystem))
+		{
+			const FOnMutableScheduledUpdateCompleted Delegate = FOnMutableScheduledUpdateCompleted::CreateUObject(
+				this, &ThisClass::OnMutableInstanceInitializationCompleted);
+			Subsystem->EnqueueInitialization(Instance, Component ? *Component : nullptr, Delegate, InitializationStats.RequestTime);
+		}
+		else
+		{
+			WaitForInstanceUpdate(Instance);
+			Instance->UpdateSkeletalMeshAsync(true, true);
+		}
+	}
+
+	for (UCustomizableObjectInstance* Instance : ReusedInstances)
+	{
+		InitializingDescriptorHashes.Add(Instance, LastGeneratedDescriptorHashes.FindRef(Instance));
+		CompleteInstanceInitialization(Instance, true);
+	}
+}
+
+FMutableScopedParameterTransaction::FMutableScopedParameterTransaction(UMutableExtensionComponent* InExtensionComponent)
+	: ExtensionComponent(InExtensionComponent)
+{
+	if (ExtensionComponent.IsValid())
+	{
+		ExtensionComponent->BeginParameterTransaction();
+	}
+}
+
+FMutableScopedParameterTransaction::~FMutableScopedParameterTransaction()
+{
+	// Reset or EndPlay may have discarded the transaction already
+	if (ExtensionComponent.IsValid() && ExtensionComponent->IsInParameterTransaction())
+	{
+		ExtensionComponent->CommitParameterTransaction();
+	}
+}
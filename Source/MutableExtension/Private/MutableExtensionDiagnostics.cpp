@@ -0,0 +1,405 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionDiagnostics.h"
+
+#include "EngineUtils.h"
+#include "MutableExtensionComponent.h"
+#include "MutableExtensionLog.h"
+#include "MutableExtensionSubsystem.h"
+#include "MutableFunctionLib.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "MuCO/CustomizableSkeletalComponent.h"
+
+namespace MutableExtensionDiagnostics
+{
+	static const TCHAR* GetNetRoleString(ENetRole Role)
+	{
+		switch (Role)
+		{
+		case ROLE_None: return TEXT("None");
+		case ROLE_SimulatedProxy: return TEXT("Simulated Proxy");
+		case ROLE_AutonomousProxy: return TEXT("Autonomous Proxy");
+		case ROLE_Authority: return TEXT("Authority");
+		default: return TEXT("Unknown");
+		}
+	}
+
+	static const TCHAR* GetMeshStatusString(const FMutableComponentDiagnostics& Component)
+	{
+		if (!Component.bValidMeshStatus)
+		{
+			return TEXT("Unknown");
+		}
+
+		switch (Component.MeshStatus)
+		{
+		case ESkeletalMeshStatus::NotGenerated: return TEXT("Not Generated");
+		case ESkeletalMeshStatus::Success: return TEXT("Success");
+		case ESkeletalMeshStatus::Error: return TEXT("Error");
+		default: return TEXT("Unknown");
+		}
+	}
+
+	static const TCHAR* GetBoolString(bool bValue)
+	{
+		return bValue ? TEXT("true") : TEXT("false");
+	}
+
+	static FName GetNameSafe(const UObject* Object)
+	{
+		return Object ? Object->GetFName() : NAME_None;
+	}
+
+	static void WriteLine(FArchive& Ar, const FStringBuilderBase& Line)
+	{
+		const FTCHARToUTF8 Utf8(Line.ToString(), Line.Len());
+		Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+void FMutableWorldDiagnostics::Gather(const UWorld* World)
+{
+	Reset();
+
+	if (!World)
+	{
+		return;
+	}
+
+	WorldName = World->GetFName();
+	CaptureTime = World->GetTimeSeconds();
+
+	if (const UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(World))
+	{
+		SchedulerStats = Subsystem->GetSchedulerStats();
+		CacheStats = Subsystem->GetCacheStats();
+		MemoryStats = Subsystem->GetMemoryStats();
+		SpeculationStats = Subsystem->GetSpeculationStats();
+		DiskCacheStats = Subsystem->GetDiskCacheStats();
+		PoolStats = Subsystem->GetPoolStats();
+		SnapshotStats = Subsystem->GetSnapshotStats();
+	}
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		GatherActor(*It);
+	}
+}
+
+void FMutableWorldDiagnostics::GatherActor(const AActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	TInlineComponentArray<UCustomizableSkeletalComponent*> MutableComponents(Actor);
+	const UMutableExtensionComponent* ExtensionComp = Actor->FindComponentByClass<UMutableExtensionComponent>();
+	if (MutableComponents.Num() == 0 && !ExtensionComp)
+	{
+		return;
+	}
+
+	const APawn* MaybePawn = Cast<APawn>(Actor);
+	const APlayerState* MaybePS = MaybePawn ? MaybePawn->GetPlayerState() : nullptr;
+
+	FMutableActorDiagnostics& ActorDiagnostics = Actors.AddDefaulted_GetRef();
+	ActorDiagnostics.ActorName = Actor->GetFName();
+	ActorDiagnostics.OwnerName = MutableExtensionDiagnostics::GetNameSafe(Actor->GetOwner());
+	ActorDiagnostics.LocalRole = Actor->GetLocalRole();
+	ActorDiagnostics.RemoteRole = Actor->GetRemoteRole();
+	ActorDiagnostics.bHasAuthority = Actor->HasAuthority();
+	ActorDiagnostics.bHidden = Actor->IsHidden();
+	ActorDiagnostics.bLocallyControlled = UMutableFunctionLib::IsActorLocallyControlled(Actor);
+	ActorDiagnostics.bIsBot = MaybePS && MaybePS->IsABot();
+	ActorDiagnostics.bHasExtensionComponent = ExtensionComp != nullptr;
+	ActorDiagnostics.FirstComponent = Components.Num();
+	ActorDiagnostics.NumComponents = MutableComponents.Num();
+
+	if (ExtensionComp)
+	{
+		ActorDiagnostics.bHasMutableInitialized = ExtensionComp->HasMutableInitialized();
+		ActorDiagnostics.NumPendingInitialization = ExtensionComp->GetNumPendingInitialization();
+		ActorDiagnostics.NumPendingRuntimeUpdate = ExtensionComp->GetInstancesPendingRuntimeUpdate().Num();
+	}
+
+	for (const UCustomizableSkeletalComponent* MutableComp : MutableComponents)
+	{
+		UCustomizableObjectInstance* Instance = MutableComp->CustomizableObjectInstance;
+
+		FMutableComponentDiagnostics& ComponentDiagnostics = Components.AddDefaulted_GetRef();
+		ComponentDiagnostics.ComponentName = MutableComp->GetFName();
+		ComponentDiagnostics.InstanceName = MutableExtensionDiagnostics::GetNameSafe(Instance);
+		ComponentDiagnostics.MeshStatus = UMutableFunctionLib::GetMutableComponentStatus(MutableComp, ComponentDiagnostics.bValidMeshStatus);
+
+		if (const USkeletalMeshComponent* MeshComponent = UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(MutableComp))
+		{
+			ComponentDiagnostics.MeshComponentName = MeshComponent->GetFName();
+			ComponentDiagnostics.SkeletalMeshName = MutableExtensionDiagnostics::GetNameSafe(MeshComponent->GetSkeletalMeshAsset());
+			ComponentDiagnostics.bHiddenInGame = MeshComponent->bHiddenInGame;
+			ComponentDiagnostics.bVisible = MeshComponent->IsVisible();
+			ComponentDiagnostics.NumMaterials = MeshComponent->GetNumMaterials();
+		}
+
+		if (ExtensionComp && Instance)
+		{
+			ComponentDiagnostics.bPendingInitialization = ExtensionComp->IsPendingInitialization(Instance);
+			ComponentDiagnostics.bPendingRuntimeUpdate = ExtensionComp->GetInstancesPendingRuntimeUpdate().Contains(Instance);
+		}
+	}
+}
+
+void FMutableWorldDiagnostics::Reset()
+{
+	WorldName = NAME_None;
+	CaptureTime = 0.0;
+	Actors.Reset();
+	Components.Reset();
+	SchedulerStats = FMutableExtensionSchedulerStats();
+	CacheStats = FMutableExtensionCacheStats();
+	MemoryStats = FMutableExtensionMemoryStats();
+	SpeculationStats = FMutableSpeculationStats();
+	DiskCacheStats = FMutableDiskCacheStats();
+	PoolStats = FMutablePoolStats();
+	SnapshotStats = FMutableSnapshotStats();
+}
+
+void FMutableWorldDiagnostics::WriteJson(FArchive& Ar) const
+{
+	using namespace MutableExtensionDiagnostics;
+
+	// FName can't be written without conversion, reuse a single buffer for every name
+	TStringBuilder<FName::StringBufferSize> Name;
+	auto WriteName = [&Name](TJsonWriter<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>& Writer, const TCHAR* Identifier, FName Value)
+	{
+		Name.Reset();
+		Value.AppendString(Name);
+		Writer.WriteValue(Identifier, Name.ToString());
+	};
+
+	TSharedRef<TJsonWriter<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>> Writer = TJsonWriterFactory<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>::Create(&Ar);
+	Writer->WriteObjectStart();
+	WriteName(*Writer, TEXT("world"), WorldName);
+	Writer->WriteValue(TEXT("captureTime"), CaptureTime);
+
+	Writer->WriteObjectStart(TEXT("scheduler"));
+	Writer->WriteValue(TEXT("queueDepth"), SchedulerStats.QueueDepth);
+	Writer->WriteValue(TEXT("peakQueueDepth"), SchedulerStats.PeakQueueDepth);
+	Writer->WriteValue(TEXT("inFlight"), SchedulerStats.NumInFlight);
+	Writer->WriteValue(TEXT("totalDispatched"), SchedulerStats.TotalDispatched);
+	Writer->WriteValue(TEXT("totalCompleted"), SchedulerStats.TotalCompleted);
+	Writer->WriteValue(TEXT("totalSkippedUnchanged"), SchedulerStats.TotalSkippedUnchanged);
+	Writer->WriteValue(TEXT("deferredOffScreen"), SchedulerStats.NumDeferredOffScreen);
+	Writer->WriteValue(TEXT("totalStalled"), SchedulerStats.TotalStalled);
+	Writer->WriteValue(TEXT("totalRetried"), SchedulerStats.TotalRetried);
+	Writer->WriteValue(TEXT("averageRetryWaitTime"), SchedulerStats.AverageRetryWaitTime);
+	Writer->WriteValue(TEXT("maxRetryWaitTime"), SchedulerStats.MaxRetryWaitTime);
+	Writer->WriteValue(TEXT("totalLateCompletions"), SchedulerStats.TotalLateCompletions);
+	Writer->WriteValue(TEXT("totalTimedOut"), SchedulerStats.TotalTimedOut);
+	Writer->WriteValue(TEXT("maxGenerationTime"), SchedulerStats.MaxGenerationTime);
+	Writer->WriteValue(TEXT("totalCancelled"), SchedulerStats.TotalCancelled);
+	Writer->WriteValue(TEXT("totalAbandoned"), SchedulerStats.TotalAbandoned);
+	Writer->WriteValue(TEXT("estimatedSavedMs"), SchedulerStats.EstimatedSavedMs);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("cache"));
+	Writer->WriteValue(TEXT("entries"), CacheStats.NumEntries);
+	Writer->WriteValue(TEXT("sizeBytes"), CacheStats.SizeBytes);
+	Writer->WriteValue(TEXT("hits"), CacheStats.Hits);
+	Writer->WriteValue(TEXT("misses"), CacheStats.Misses);
+	Writer->WriteValue(TEXT("evictions"), CacheStats.Evictions);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("memory"));
+	Writer->WriteValue(TEXT("budgetBytes"), MemoryStats.BudgetBytes);
+	Writer->WriteValue(TEXT("usedBytes"), MemoryStats.UsedBytes);
+	Writer->WriteValue(TEXT("peakUsedBytes"), MemoryStats.PeakUsedBytes);
+	Writer->WriteValue(TEXT("instances"), MemoryStats.NumInstances);
+	Writer->WriteValue(TEXT("released"), MemoryStats.NumReleased);
+	Writer->WriteValue(TEXT("evictions"), MemoryStats.TotalEvictions);
+	Writer->WriteValue(TEXT("evictedBytes"), MemoryStats.TotalEvictedBytes);
+	Writer->WriteValue(TEXT("restores"), MemoryStats.TotalRestores);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("speculation"));
+	Writer->WriteValue(TEXT("candidates"), SpeculationStats.NumCandidates);
+	Writer->WriteValue(TEXT("ready"), SpeculationStats.NumReady);
+	Writer->WriteValue(TEXT("sizeBytes"), SpeculationStats.SizeBytes);
+	Writer->WriteValue(TEXT("generated"), SpeculationStats.TotalGenerated);
+	Writer->WriteValue(TEXT("hits"), SpeculationStats.Hits);
+	Writer->WriteValue(TEXT("misses"), SpeculationStats.Misses);
+	Writer->WriteValue(TEXT("hitRate"), SpeculationStats.HitRate);
+	Writer->WriteValue(TEXT("wasted"), SpeculationStats.TotalWasted);
+	Writer->WriteValue(TEXT("wastedMs"), SpeculationStats.WastedGenerationMs);
+	Writer->WriteValue(TEXT("evicted"), SpeculationStats.TotalEvicted);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("diskCache"));
+	Writer->WriteValue(TEXT("hits"), DiskCacheStats.Hits);
+	Writer->WriteValue(TEXT("misses"), DiskCacheStats.Misses);
+	Writer->WriteValue(TEXT("rejected"), DiskCacheStats.Rejected);
+	Writer->WriteValue(TEXT("writes"), DiskCacheStats.Writes);
+	Writer->WriteValue(TEXT("bytesRead"), DiskCacheStats.BytesRead);
+	Writer->WriteValue(TEXT("bytesWritten"), DiskCacheStats.BytesWritten);
+	Writer->WriteValue(TEXT("evictions"), DiskCacheStats.Evictions);
+	Writer->WriteValue(TEXT("evictedBytes"), DiskCacheStats.EvictedBytes);
+	Writer->WriteValue(TEXT("readTimeMs"), DiskCacheStats.ReadTimeMs);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("pool"));
+	Writer->WriteValue(TEXT("parks"), PoolStats.NumParks);
+	Writer->WriteValue(TEXT("unparks"), PoolStats.NumUnparks);
+	Writer->WriteValue(TEXT("fullReuses"), PoolStats.NumFullReuses);
+	Writer->WriteValue(TEXT("instancesReused"), PoolStats.NumInstancesReused);
+	Writer->WriteValue(TEXT("instancesRegenerated"), PoolStats.NumInstancesRegenerated);
+	Writer->WriteValue(TEXT("hitRate"), PoolStats.HitRate);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("snapshot"));
+	Writer->WriteValue(TEXT("sizeBytes"), SnapshotStats.SizeBytes);
+	Writer->WriteValue(TEXT("actors"), SnapshotStats.NumActors);
+	Writer->WriteValue(TEXT("instances"), SnapshotStats.NumInstances);
+	Writer->WriteValue(TEXT("uniqueDescriptors"), SnapshotStats.NumUniqueDescriptors);
+	Writer->WriteValue(TEXT("uniqueParameters"), SnapshotStats.NumUniqueParameters);
+	Writer->WriteValue(TEXT("strings"), SnapshotStats.NumStrings);
+	Writer->WriteValue(TEXT("unmatched"), SnapshotStats.NumUnmatched);
+	Writer->WriteValue(TEXT("encodeTimeMs"), SnapshotStats.EncodeTimeMs);
+	Writer->WriteValue(TEXT("decodeTimeMs"), SnapshotStats.DecodeTimeMs);
+	Writer->WriteValue(TEXT("restoreToReadyTime"), SnapshotStats.RestoreToReadyTime);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteArrayStart(TEXT("actors"));
+	for (const FMutableActorDiagnostics& Actor : Actors)
+	{
+		Writer->WriteObjectStart();
+		WriteName(*Writer, TEXT("actor"), Actor.ActorName);
+		WriteName(*Writer, TEXT("owner"), Actor.OwnerName);
+		Writer->WriteValue(TEXT("localRole"), GetNetRoleString(Actor.LocalRole));
+		Writer->WriteValue(TEXT("remoteRole"), GetNetRoleString(Actor.RemoteRole));
+		Writer->WriteValue(TEXT("hasAuthority"), Actor.bHasAuthority);
+		Writer->WriteValue(TEXT("hidden"), Actor.bHidden);
+		Writer->WriteValue(TEXT("locallyControlled"), Actor.bLocallyControlled);
+		Writer->WriteValue(TEXT("bot"), Actor.bIsBot);
+		Writer->WriteValue(TEXT("hasExtensionComponent"), Actor.bHasExtensionComponent);
+		Writer->WriteValue(TEXT("initialized"), Actor.bHasMutableInitialized);
+		Writer->WriteValue(TEXT("pendingInitialization"), Actor.NumPendingInitialization);
+		Writer->WriteValue(TEXT("pendingRuntimeUpdate"), Actor.NumPendingRuntimeUpdate);
+
+		Writer->WriteArrayStart(TEXT("components"));
+		for (int32 Index = Actor.FirstComponent; Index < Actor.FirstComponent + Actor.NumComponents; Index++)
+		{
+			const FMutableComponentDiagnostics& Component = Components[Index];
+			Writer->WriteObjectStart();
+			WriteName(*Writer, TEXT("component"), Component.ComponentName);
+			WriteName(*Writer, TEXT("instance"), Component.InstanceName);
+			WriteName(*Writer, TEXT("meshComponent"), Component.MeshComponentName);
+			WriteName(*Writer, TEXT("skeletalMesh"), Component.SkeletalMeshName);
+			Writer->WriteValue(TEXT("meshStatus"), GetMeshStatusString(Component));
+			Writer->WriteValue(TEXT("hiddenInGame"), Component.bHiddenInGame);
+			Writer->WriteValue(TEXT("visible"), Component.bVisible);
+			Writer->WriteValue(TEXT("numMaterials"), Component.NumMaterials);
+			Writer->WriteValue(TEXT("pendingInitialization"), Component.bPendingInitialization);
+			Writer->WriteValue(TEXT("pendingRuntimeUpdate"), Component.bPendingRuntimeUpdate);
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+}
+
+void FMutableWorldDiagnostics::WriteCsv(FArchive& Ar) const
+{
+	using namespace MutableExtensionDiagnostics;
+
+	// Object names can't contain commas or quotes, so nothing needs escaping
+	TStringBuilder<1024> Line;
+	Line << TEXT("Actor,Owner,LocalRole,RemoteRole,HasAuthority,Hidden,LocallyControlled,Bot,HasExtensionComponent,Initialized,")
+		TEXT("ActorPendingInitialization,ActorPendingRuntimeUpdate,Component,Instance,MeshComponent,SkeletalMesh,MeshStatus,")
+		TEXT("HiddenInGame,Visible,NumMaterials,PendingInitialization,PendingRuntimeUpdate\n");
+	WriteLine(Ar, Line);
+
+	for (const FMutableActorDiagnostics& Actor : Actors)
+	{
+		// Actors without Mutable components still get a row so their extension state is visible
+		const int32 NumRows = FMath::Max(1, Actor.NumComponents);
+		for (int32 Row = 0; Row < NumRows; Row++)
+		{
+			Line.Reset();
+			Line << Actor.ActorName << TEXT(',') << Actor.OwnerName << TEXT(',')
+				<< GetNetRoleString(Actor.LocalRole) << TEXT(',') << GetNetRoleString(Actor.RemoteRole) << TEXT(',')
+				<< GetBoolString(Actor.bHasAuthority) << TEXT(',') << GetBoolString(Actor.bHidden) << TEXT(',')
+				<< GetBoolString(Actor.bLocallyControlled) << TEXT(',') << GetBoolString(Actor.bIsBot) << TEXT(',')
+				<< GetBoolString(Actor.bHasExtensionComponent) << TEXT(',') << GetBoolString(Actor.bHasMutableInitialized) << TEXT(',')
+				<< Actor.NumPendingInitialization << TEXT(',') << Actor.NumPendingRuntimeUpdate << TEXT(',');
+
+			if (Row < Actor.NumComponents)
+			{
+				const FMutableComponentDiagnostics& Component = Components[Actor.FirstComponent + Row];
+				Line << Component.ComponentName << TEXT(',') << Component.InstanceName << TEXT(',')
+					<< Component.MeshComponentName << TEXT(',') << Component.SkeletalMeshName << TEXT(',')
+					<< GetMeshStatusString(Component) << TEXT(',')
+					<< GetBoolString(Component.bHiddenInGame) << TEXT(',') << GetBoolString(Component.bVisible) << TEXT(',')
+					<< Component.NumMaterials << TEXT(',')
+					<< GetBoolString(Component.bPendingInitialization) << TEXT(',') << GetBoolString(Component.bPendingRuntimeUpdate);
+			}
+			else
+			{
+				Line << TEXT(",,,,,,,,,");
+			}
+
+			Line << TEXT('\n');
+			WriteLine(Ar, Line);
+		}
+	}
+}
+
+namespace MutableExtensionDiagnostics
+{
+	/** Reused between dumps so repeated captures don't reallocate */
+	static FMutableWorldDiagnostics DumpAllSnapshot;
+
+	FAutoConsoleCommandWithWorldAndArgs CmdDumpAll(
+		TEXT("Mutable.DumpAll"),
+		TEXT("Write the state of every Mutable actor in the world to Saved/MutableExtension. Optional: Json|Csv (default Json), Filename"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const bool bCsv = Args.Num() > 0 && Args[0].Equals(TEXT("Csv"), ESearchCase::IgnoreCase);
+			const FString Filename = Args.Num() > 1 ? Args[1] : FPaths::ProjectSavedDir() / TEXT("MutableExtension") /
+				FString::Printf(TEXT("Dump-%s.%s"), *FDateTime::Now().ToString(), bCsv ? TEXT("csv") : TEXT("json"));
+
+			const double StartTime = FPlatformTime::Seconds();
+			DumpAllSnapshot.Gather(World);
+			const double GatherTime = FPlatformTime::Seconds() - StartTime;
+
+			const TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*Filename));
+			if (!Ar)
+			{
+				UE_LOG(LogMutableExtension, Error, TEXT("[ %s ] Failed to open { %s }"), *FString(__FUNCTION__), *Filename);
+				return;
+			}
+
+			if (bCsv)
+			{
+				DumpAllSnapshot.WriteCsv(*Ar);
+			}
+			else
+			{
+				DumpAllSnapshot.WriteJson(*Ar);
+			}
+
+			UE_LOG(LogMutableExtension, Log, TEXT("[ %s ] Wrote %d actors, %d components to { %s } (gather %.2fms, total %.2fms)"),
+				*FString(__FUNCTION__), DumpAllSnapshot.Actors.Num(), DumpAllSnapshot.Components.Num(), *Filename,
+				GatherTime * 1000.0, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		}));
+}
@@ -0,0 +1,966 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionDiskCache.h"
+
+#include "MutableExtensionLog.h"
+#include "MutableExtensionTrace.h"
+#include "Algo/AllOf.h"
+#include "Algo/Sort.h"
+#include "Animation/Skeleton.h"
+#include "Async/MappedFileHandle.h"
+#include "Engine/AssetManager.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Memory/MemoryView.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/ScopeLock.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "Rendering/Texture2DResource.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "MuCO/CustomizableObject.h"
+#include "MuCO/CustomizableObjectInstance.h"
+
+namespace MutableExtensionDiskCache
+{
+	static constexpr uint32 Magic = 0x4358454D;
+
+	static constexpr const TCHAR* Extension = TEXT("mxcache");
+
+	/** Bump whenever anything below changes, older entries are then stale */
+	static constexpr uint32 FormatVersion = 2;
+
+	struct FBlob
+	{
+		int64 Offset = 0;
+		int64 Size = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FBlob& Blob)
+		{
+			return Ar << Blob.Offset << Blob.Size;
+		}
+	};
+
+	struct FHeader
+	{
+		uint32 Magic = 0;
+		uint32 FormatVersion = 0;
+		uint64 ObjectVersion = 0;
+		uint64 DescriptorHash = 0;
+		FBlob Contents;
+
+		friend FArchive& operator<<(FArchive& Ar, FHeader& Header)
+		{
+			return Ar << Header.Magic << Header.FormatVersion << Header.ObjectVersion << Header.DescriptorHash << Header.Contents;
+		}
+	};
+
+	/** Either an asset, or a texture Mutable generated whose mips are in the payload */
+	struct FTexture
+	{
+		FName Parameter;
+		FString AssetPath;
+		int32 SizeX = 0;
+		int32 SizeY = 0;
+		uint8 PixelFormat = PF_Unknown;
+		uint8 CompressionSettings = TC_Default;
+		uint8 LODGroup = TEXTUREGROUP_World;
+		bool bSRGB = true;
+		TArray<FBlob> Mips;
+
+		/** Mips of a generated texture, copied on the game thread and appended to the payload by Write() */
+		TArray<TArray64<uint8>> MipData;
+
+		friend FArchive& operator<<(FArchive& Ar, FTexture& Texture)
+		{
+			return Ar << Texture.Parameter << Texture.AssetPath << Texture.SizeX << Texture.SizeY << Texture.PixelFormat
+				<< Texture.CompressionSettings << Texture.LODGroup << Texture.bSRGB << Texture.Mips;
+		}
+	};
+
+	/** Either an asset, or a dynamic instance of ParentPath that Mutable created */
+	struct FMaterial
+	{
+		FName SlotName;
+		FString ParentPath;
+		bool bDynamic = false;
+		FMeshUVChannelInfo UVChannelData;
+		TArray<TPair<FName, float>> ScalarParameters;
+		TArray<TPair<FName, FLinearColor>> VectorParameters;
+		TArray<FTexture> TextureParameters;
+
+		friend FArchive& operator<<(FArchive& Ar, FMaterial& Material)
+		{
+			return Ar << Material.SlotName << Material.ParentPath << Material.bDynamic << Material.UVChannelData
+				<< Material.ScalarParameters << Material.VectorParameters << Material.TextureParameters;
+		}
+	};
+
+	struct FLOD
+	{
+		float ScreenSize = 0.f;
+		float LODHysteresis = 0.f;
+		TArray<int32> LODMaterialMap;
+
+		friend FArchive& operator<<(FArchive& Ar, FLOD& LOD)
+		{
+			return Ar << LOD.ScreenSize << LOD.LODHysteresis << LOD.LODMaterialMap;
+		}
+	};
+
+	struct FMesh
+	{
+		int32 ComponentIndex = 0;
+		FString SkeletonPath;
+		FString PhysicsAssetPath;
+		FReferenceSkeleton RefSkeleton;
+		FBoxSphereBounds Bounds;
+		bool bHasVertexColors = false;
+		TArray<FLOD> LODs;
+		TArray<FMaterial> Materials;
+		FBlob RenderData;
+
+		/** Render data serialized on the game thread, appended to the payload by Write() */
+		TArray64<uint8> RenderDataBytes;
+
+		friend FArchive& operator<<(FArchive& Ar, FMesh& Mesh)
+		{
+			return Ar << Mesh.ComponentIndex << Mesh.SkeletonPath << Mesh.PhysicsAssetPath << Mesh.RefSkeleton
+				<< Mesh.Bounds << Mesh.bHasVertexColors << Mesh.LODs << Mesh.Materials << Mesh.RenderData;
+		}
+	};
+
+	/** Mutable's generated objects live in the transient package, anything else can be loaded again by path */
+	static bool IsAsset(const UObject* Object)
+	{
+		return Object && Object->IsAsset() && !Object->HasAnyFlags(RF_Transient);
+	}
+
+	static FBlob AppendBlob(TArray64<uint8>& Data, const void* Source, int64 Size)
+	{
+		Data.SetNumZeroed(Align(Data.Num(), FMutableExtensionDiskCache::BlobAlignment));
+
+		FBlob Blob;
+		Blob.Offset = Data.Num();
+		Blob.Size = Size;
+		Data.Append(static_cast<const uint8*>(Source), Size);
+		return Blob;
+	}
+
+	/** Only the CPU copy can be cached, Mutable may already have discarded it after upload */
+	static bool IsMipResident(const FTexture2DMipMap& Mip)
+	{
+		return Mip.BulkData.IsBulkDataLoaded() && Mip.BulkData.GetBulkDataSize() > 0;
+	}
+
+	/** Serializing render data whose CPU copy was discarded after upload writes empty buffers */
+	static bool AreBuffersResident(const FSkeletalMeshRenderData& RenderData)
+	{
+		for (const FSkeletalMeshLODRenderData& LOD : RenderData.LODRenderData)
+		{
+			const FRawStaticIndexBuffer16or32Interface* IndexBuffer = LOD.MultiSizeIndexContainer.GetIndexBuffer();
+			const FSkinWeightDataVertexBuffer* WeightBuffer = LOD.SkinWeightVertexBuffer.GetDataVertexBuffer();
+			if (LOD.GetNumVertices() == 0 || !IndexBuffer || IndexBuffer->Num() == 0 ||
+				!LOD.StaticVertexBuffers.PositionVertexBuffer.GetVertexData() ||
+				!LOD.StaticVertexBuffers.StaticMeshVertexBuffer.GetTangentData() ||
+				!LOD.StaticVertexBuffers.StaticMeshVertexBuffer.GetTexCoordData() ||
+				!WeightBuffer || !WeightBuffer->GetWeightData())
+			{
+				return false;
+			}
+		}
+		return RenderData.LODRenderData.Num() > 0;
+	}
+
+	/** Copies the mips now, Mutable or the render thread may change or discard them once the game thread moves on */
+	static bool PrepareTexture(UTexture* Texture, FTexture& Entry)
+	{
+		if (IsAsset(Texture))
+		{
+			Entry.AssetPath = Texture->GetPathName();
+			return true;
+		}
+
+		UTexture2D* Texture2D = Cast<UTexture2D>(Texture);
+		const FTexturePlatformData* PlatformData = Texture2D ? Texture2D->GetPlatformData() : nullptr;
+		if (!PlatformData || PlatformData->Mips.Num() == 0 || !Algo::AllOf(PlatformData->Mips, &IsMipResident))
+		{
+			return false;
+		}
+
+		Entry.SizeX = PlatformData->SizeX;
+		Entry.SizeY = PlatformData->SizeY;
+		Entry.PixelFormat = static_cast<uint8>(PlatformData->PixelFormat);
+		Entry.CompressionSettings = static_cast<uint8>(Texture2D->CompressionSettings);
+		Entry.LODGroup = static_cast<uint8>(Texture2D->LODGroup);
+		Entry.bSRGB = Texture2D->SRGB;
+
+		Entry.MipData.Reserve(PlatformData->Mips.Num());
+		for (const FTexture2DMipMap& Mip : PlatformData->Mips)
+		{
+			const uint8* MipData = static_cast<const uint8*>(Mip.BulkData.LockReadOnly());
+			Entry.MipData.Emplace(MipData, Mip.BulkData.GetBulkDataSize());
+			Mip.BulkData.Unlock();
+		}
+		return true;
+	}
+
+	static void WriteTexture(FTexture& Entry, TArray64<uint8>& Data)
+	{
+		for (TArray64<uint8>& MipData : Entry.MipData)
+		{
+			Entry.Mips.Add(AppendBlob(Data, MipData.GetData(), MipData.Num()));
+			MipData.Empty();
+		}
+	}
+
+	static UTexture* CreateTexture(const FTexture& Entry, TArray<TPair<UTexture2D*, const FTexture*>>& OutCreated)
+	{
+		if (!Entry.AssetPath.IsEmpty())
+		{
+			return Cast<UTexture>(FSoftObjectPath(Entry.AssetPath).ResolveObject());
+		}
+
+		UTexture2D* Texture = UTexture2D::CreateTransient(Entry.SizeX, Entry.SizeY, static_cast<EPixelFormat>(Entry.PixelFormat));
+		if (!Texture)
+		{
+			return nullptr;
+		}
+
+		Texture->CompressionSettings = static_cast<TextureCompressionSettings>(Entry.CompressionSettings);
+		Texture->LODGroup = static_cast<TextureGroup>(Entry.LODGroup);
+		Texture->SRGB = Entry.bSRGB;
+		Texture->NeverStream = true;
+		OutCreated.Emplace(Texture, &Entry);
+		return Texture;
+	}
+
+	/** Nothing else references the texture until its resource is initialized */
+	static void ReadTexture(UTexture2D* Texture, const FTexture& Entry, const uint8* Data)
+	{
+		FTexturePlatformData* PlatformData = Texture->GetPlatformData();
+		PlatformData->Mips.Empty(Entry.Mips.Num());
+		for (int32 MipIndex = 0; MipIndex < Entry.Mips.Num(); MipIndex++)
+		{
+			const FBlob& Blob = Entry.Mips[MipIndex];
+			FTexture2DMipMap* Mip = new FTexture2DMipMap(FMath::Max(1, Entry.SizeX >> MipIndex), FMath::Max(1, Entry.SizeY >> MipIndex));
+			PlatformData->Mips.Add(Mip);
+
+			Mip->BulkData.Lock(LOCK_READ_WRITE);
+			FMemory::Memcpy(Mip->BulkData.Realloc(Blob.Size), Data + Blob.Offset, Blob.Size);
+			Mip->BulkData.Unlock();
+		}
+	}
+
+	static bool PrepareMaterial(const FSkeletalMaterial& SkeletalMaterial, FMaterial& Entry)
+	{
+		Entry.SlotName = SkeletalMaterial.MaterialSlotName;
+		Entry.UVChannelData = SkeletalMaterial.UVChannelData;
+
+		UMaterialInterface* Material = SkeletalMaterial.MaterialInterface;
+		if (!Material || IsAsset(Material))
+		{
+			Entry.ParentPath = Material ? Material->GetPathName() : FString();
+			return true;
+		}
+
+		UMaterialInstanceDynamic* Dynamic = Cast<UMaterialInstanceDynamic>(Material);
+		if (!Dynamic || !IsAsset(Dynamic->Parent))
+		{
+			return false;
+		}
+
+		Entry.ParentPath = Dynamic->Parent->GetPathName();
+		Entry.bDynamic = true;
+		for (const FScalarParameterValue& Parameter : Dynamic->ScalarParameterValues)
+		{
+			Entry.ScalarParameters.Emplace(Parameter.ParameterInfo.Name, Parameter.ParameterValue);
+		}
+		for (const FVectorParameterValue& Parameter : Dynamic->VectorParameterValues)
+		{
+			Entry.VectorParameters.Emplace(Parameter.ParameterInfo.Name, Parameter.ParameterValue);
+		}
+		for (const FTextureParameterValue& Parameter : Dynamic->TextureParameterValues)
+		{
+			FTexture& Texture = Entry.TextureParameters.AddDefaulted_GetRef();
+			Texture.Parameter = Parameter.ParameterInfo.Name;
+			if (!PrepareTexture(Parameter.ParameterValue, Texture))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool CreateMaterial(const FMaterial& Entry, FSkeletalMaterial& OutMaterial,
+		TArray<TPair<UTexture2D*, const FTexture*>>& OutTextures)
+	{
+		OutMaterial.MaterialSlotName = Entry.SlotName;
+		OutMaterial.UVChannelData = Entry.UVChannelData;
+		if (Entry.ParentPath.IsEmpty())
+		{
+			return true;
+		}
+
+		UMaterialInterface* Parent = Cast<UMaterialInterface>(FSoftObjectPath(Entry.ParentPath).ResolveObject());
+		if (!Parent)
+		{
+			return false;
+		}
+
+		if (!Entry.bDynamic)
+		{
+			OutMaterial.MaterialInterface = Parent;
+			return true;
+		}
+
+		UMaterialInstanceDynamic* Dynamic = UMaterialInstanceDynamic::Create(Parent, GetTransientPackage());
+		for (const TPair<FName, float>& Parameter : Entry.ScalarParameters)
+		{
+			Dynamic->SetScalarParameterValue(Parameter.Key, Parameter.Value);
+		}
+		for (const TPair<FName, FLinearColor>& Parameter : Entry.VectorParameters)
+		{
+			Dynamic->SetVectorParameterValue(Parameter.Key, Parameter.Value);
+		}
+		for (const FTexture& Texture : Entry.TextureParameters)
+		{
+			UTexture* ParameterValue = CreateTexture(Texture, OutTextures);
+			if (!ParameterValue)
+			{
+				return false;
+			}
+			Dynamic->SetTextureParameterValue(Texture.Parameter, ParameterValue);
+		}
+
+		OutMaterial.MaterialInterface = Dynamic;
+		return true;
+	}
+
+	static bool PrepareMesh(USkeletalMesh* SkeletalMesh, FMesh& Entry)
+	{
+		if (!SkeletalMesh->GetResourceForRendering() || SkeletalMesh->GetMorphTargets().Num() > 0 ||
+			SkeletalMesh->GetMeshClothingAssets().Num() > 0 || !IsAsset(SkeletalMesh->GetSkeleton()) ||
+			(SkeletalMesh->GetPhysicsAsset() && !IsAsset(SkeletalMesh->GetPhysicsAsset())) ||
+			!AreBuffersResident(*SkeletalMesh->GetResourceForRendering()))
+		{
+			return false;
+		}
+
+		Entry.SkeletonPath = SkeletalMesh->GetSkeleton()->GetPathName();
+		Entry.PhysicsAssetPath = SkeletalMesh->GetPhysicsAsset() ? SkeletalMesh->GetPhysicsAsset()->GetPathName() : FString();
+		Entry.RefSkeleton = SkeletalMesh->GetRefSkeleton();
+		Entry.Bounds = SkeletalMesh->GetImportedBounds();
+		Entry.bHasVertexColors = SkeletalMesh->GetHasVertexColors();
+
+		for (int32 LODIndex = 0; LODIndex < SkeletalMesh->GetLODNum(); LODIndex++)
+		{
+			const FSkeletalMeshLODInfo* LODInfo = SkeletalMesh->GetLODInfo(LODIndex);
+			FLOD& LOD = Entry.LODs.AddDefaulted_GetRef();
+			LOD.ScreenSize = LODInfo->ScreenSize.Default;
+			LOD.LODHysteresis = LODInfo->LODHysteresis;
+			LOD.LODMaterialMap = LODInfo->LODMaterialMap;
+		}
+
+		for (const FSkeletalMaterial& SkeletalMaterial : SkeletalMesh->GetMaterials())
+		{
+			if (!PrepareMaterial(SkeletalMaterial, Entry.Materials.AddDefaulted_GetRef()))
+			{
+				return false;
+			}
+		}
+
+		// Serialized now for the same reason the mips are copied, only the bytes are handed to the worker thread
+		FMemoryWriter64 Writer(Entry.RenderDataBytes);
+		SkeletalMesh->GetResourceForRendering()->Serialize(Writer, SkeletalMesh);
+		return !Writer.IsError();
+	}
+
+	static void WriteMesh(FMesh& Entry, TArray64<uint8>& Data)
+	{
+		Entry.RenderData = AppendBlob(Data, Entry.RenderDataBytes.GetData(), Entry.RenderDataBytes.Num());
+		Entry.RenderDataBytes.Empty();
+
+		for (FMaterial& Material : Entry.Materials)
+		{
+			for (FTexture& Texture : Material.TextureParameters)
+			{
+				WriteTexture(Texture, Data);
+			}
+		}
+	}
+
+	/** Everything but the render data, which is deserialized on a worker thread */
+	static USkeletalMesh* CreateMesh(const FMesh& Entry, TArray<TPair<UTexture2D*, const FTexture*>>& OutTextures)
+	{
+		USkeleton* Skeleton = Cast<USkeleton>(FSoftObjectPath(Entry.SkeletonPath).ResolveObject());
+		UPhysicsAsset* PhysicsAsset = Entry.PhysicsAssetPath.IsEmpty() ? nullptr :
+			Cast<UPhysicsAsset>(FSoftObjectPath(Entry.PhysicsAssetPath).ResolveObject());
+		if (!Skeleton || (!Entry.PhysicsAssetPath.IsEmpty() && !PhysicsAsset))
+		{
+			return nullptr;
+		}
+
+		TArray<FSkeletalMaterial> Materials;
+		for (const FMaterial& Material : Entry.Materials)
+		{
+			if (!CreateMaterial(Material, Materials.AddDefaulted_GetRef(), OutTextures))
+			{
+				return nullptr;
+			}
+		}
+
+		USkeletalMesh* SkeletalMesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+		SkeletalMesh->SetSkeleton(Skeleton);
+		SkeletalMesh->SetPhysicsAsset(PhysicsAsset);
+		SkeletalMesh->SetRefSkeleton(Entry.RefSkeleton);
+		SkeletalMesh->CalculateInvRefMatrices();
+		SkeletalMesh->SetImportedBounds(Entry.Bounds);
+		SkeletalMesh->SetHasVertexColors(Entry.bHasVertexColors);
+		SkeletalMesh->SetMaterials(Materials);
+		for (const FLOD& LOD : Entry.LODs)
+		{
+			FSkeletalMeshLODInfo& LODInfo = SkeletalMesh->AddLODInfo();
+			LODInfo.ScreenSize = LOD.ScreenSize;
+			LODInfo.LODHysteresis = LOD.LODHysteresis;
+			LODInfo.LODMaterialMap = LOD.LODMaterialMap;
+		}
+		SkeletalMesh->SetResourceForRendering(MakeUnique<FSkeletalMeshRenderData>());
+		return SkeletalMesh;
+	}
+
+	/** Read straight from the mapped payload, the render data makes its own copy. The blob was checked by IsBlobValid() */
+	static bool ReadMesh(USkeletalMesh* SkeletalMesh, const FMesh& Entry, const uint8* Data)
+	{
+		FMemoryReaderView Reader(MakeMemoryView(Data + Entry.RenderData.Offset, static_cast<uint64>(Entry.RenderData.Size)));
+		SkeletalMesh->GetResourceForRendering()->Serialize(Reader, SkeletalMesh);
+		return !Reader.IsError() && SkeletalMesh->GetResourceForRendering()->LODRenderData.Num() == Entry.LODs.Num();
+	}
+
+	static bool IsBlobValid(const FBlob& Blob, int64 FileSize)
+	{
+		return Blob.Offset >= 0 && Blob.Size >= 0 && Blob.Offset + Blob.Size <= FileSize;
+	}
+
+	static bool AreBlobsValid(const TArray<FMesh>& Meshes, int64 FileSize)
+	{
+		for (const FMesh& Mesh : Meshes)
+		{
+			if (!IsBlobValid(Mesh.RenderData, FileSize))
+			{
+				return false;
+			}
+			for (const FMaterial& Material : Mesh.Materials)
+			{
+				for (const FTexture& Texture : Material.TextureParameters)
+				{
+					for (const FBlob& Mip : Texture.Mips)
+					{
+						if (!IsBlobValid(Mip, FileSize))
+						{
+							return false;
+						}
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	/** Maps the entry when the platform supports it, otherwise loads it whole */
+	struct FEntryFile
+	{
+		TUniquePtr<IMappedFileHandle> MappedHandle;
+		TUniquePtr<IMappedFileRegion> MappedRegion;
+		TArray64<uint8> Loaded;
+
+		const uint8* Data = nullptr;
+		int64 Size = 0;
+
+		bool Open(const FString& Filename)
+		{
+			MappedHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+			if (MappedHandle)
+			{
+				MappedRegion.Reset(MappedHandle->MapRegion());
+			}
+
+			if (MappedRegion)
+			{
+				Data = MappedRegion->GetMappedPtr();
+				Size = MappedRegion->GetMappedSize();
+			}
+			else if (FFileHelper::LoadFileToArray(Loaded, *Filename, FILEREAD_Silent))
+			{
+				Data = Loaded.GetData();
+				Size = Loaded.Num();
+			}
+			return Data != nullptr;
+		}
+
+		void Close()
+		{
+			MappedRegion.Reset();
+			MappedHandle.Reset();
+			Loaded.Empty();
+			Data = nullptr;
+			Size = 0;
+		}
+	};
+}
+
+uint64 FMutableExtensionDiskCache::GetObjectVersion(const UCustomizableObject* CustomizableObject)
+{
+	const uint32 PathHash = GetTypeHash(CustomizableObject->GetPathName());
+	return (static_cast<uint64>(PathHash) << 32) ^ GetTypeHash(CustomizableObject->GetCompilationGuid());
+}
+
+FString FMutableExtensionDiskCache::GetDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("MutableExtension") / TEXT("DiskCache");
+}
+
+FString FMutableExtensionDiskCache::GetEntryFilename(const UCustomizableObject* CustomizableObject, uint64 DescriptorHash)
+{
+	return GetDirectory() / FString::Printf(TEXT("%s-%016llx.%s"), *CustomizableObject->GetName(), DescriptorHash,
+		MutableExtensionDiskCache::Extension);
+}
+
+/** Contents of an entry with its payload already copied out of the generated objects */
+struct FMutableDiskCacheWrite
+{
+	FString Filename;
+	MutableExtensionDiskCache::FHeader Header;
+	TArray<MutableExtensionDiskCache::FMesh> Meshes;
+};
+
+TSharedPtr<FMutableDiskCacheWrite> FMutableExtensionDiskCache::PrepareWrite(const UCustomizableObjectInstance* Instance,
+	uint64 DescriptorHash)
+{
+	using namespace MutableExtensionDiskCache;
+
+	MUTABLE_EXTENSION_SCOPE(FMutableExtensionDiskCache::PrepareWrite);
+
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	if (!CustomizableObject)
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FMutableDiskCacheWrite> Entry = MakeShared<FMutableDiskCacheWrite>();
+	Entry->Filename = GetEntryFilename(CustomizableObject, DescriptorHash);
+	Entry->Header.Magic = MutableExtensionDiskCache::Magic;
+	Entry->Header.FormatVersion = MutableExtensionDiskCache::FormatVersion;
+	Entry->Header.ObjectVersion = GetObjectVersion(CustomizableObject);
+	Entry->Header.DescriptorHash = DescriptorHash;
+
+	for (int32 ComponentIndex = 0; ComponentIndex < CustomizableObject->GetComponentCount(); ComponentIndex++)
+	{
+		USkeletalMesh* SkeletalMesh = Instance->GetSkeletalMesh(ComponentIndex);
+		if (!SkeletalMesh)
+		{
+			continue;
+		}
+
+		FMesh& Mesh = Entry->Meshes.AddDefaulted_GetRef();
+		Mesh.ComponentIndex = ComponentIndex;
+		if (!PrepareMesh(SkeletalMesh, Mesh))
+		{
+			UE_LOG(LogMutableExtension, Verbose, TEXT("[ %s ] { %s } component %d can't be cached"),
+				*FString(__FUNCTION__), *GetNameSafe(Instance), ComponentIndex);
+			return nullptr;
+		}
+	}
+
+	return Entry->Meshes.Num() > 0 ? Entry : nullptr;
+}
+
+FMutableDiskCacheWriteResult FMutableExtensionDiskCache::Write(FMutableDiskCacheWrite& Entry, int64 MaxBytes)
+{
+	using namespace MutableExtensionDiskCache;
+
+	MUTABLE_EXTENSION_SCOPE(FMutableExtensionDiskCache::Write);
+
+	FMutableDiskCacheWriteResult Result;
+
+	// The header is written last, once the contents are known, but the payload always starts aligned after it
+	TArray64<uint8> Data;
+	Data.SetNumZeroed(BlobAlignment);
+
+	for (FMesh& Mesh : Entry.Meshes)
+	{
+		WriteMesh(Mesh, Data);
+	}
+
+	TArray64<uint8> ContentsBytes;
+	FMemoryWriter64 ContentsWriter(ContentsBytes);
+	ContentsWriter << Entry.Meshes;
+
+	FHeader Header = Entry.Header;
+	Header.Contents = AppendBlob(Data, ContentsBytes.GetData(), ContentsBytes.Num());
+
+	FMemoryWriter64 HeaderWriter(Data);
+	HeaderWriter << Header;
+
+	// Written aside and moved into place, so a reader never sees a partial entry
+	const FString TempFilename = Entry.Filename + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Data, *TempFilename) || !IFileManager::Get().Move(*Entry.Filename, *TempFilename))
+	{
+		UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] failed to write %s"), *FString(__FUNCTION__), *Entry.Filename);
+		return Result;
+	}
+
+	Result.BytesWritten = Data.Num();
+	Trim(MaxBytes, Result.NumEvicted, Result.EvictedBytes);
+	return Result;
+}
+
+void FMutableExtensionDiskCache::Trim(int64 MaxBytes, int32& OutNumEvicted, int64& OutEvictedBytes)
+{
+	OutNumEvicted = 0;
+	OutEvictedBytes = 0;
+	if (MaxBytes <= 0)
+	{
+		return;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(FMutableExtensionDiskCache::Trim);
+
+	// Every write trims, one at a time is enough
+	static FCriticalSection TrimCritical;
+	FScopeLock Lock(&TrimCritical);
+
+	struct FEntryStat
+	{
+		FString Filename;
+		FDateTime ModificationTime;
+		int64 Size;
+	};
+
+	TArray<FEntryStat> Entries;
+	int64 TotalBytes = 0;
+	IFileManager::Get().IterateDirectoryStat(*GetDirectory(), [&Entries, &TotalBytes](const TCHAR* Filename, const FFileStatData& Stat)
+	{
+		if (!Stat.bIsDirectory && FPaths::GetExtension(Filename) == MutableExtensionDiskCache::Extension)
+		{
+			Entries.Add({ Filename, Stat.ModificationTime, Stat.FileSize });
+			TotalBytes += Stat.FileSize;
+		}
+		return true;
+	});
+
+	if (TotalBytes <= MaxBytes)
+	{
+		return;
+	}
+
+	// Reading an entry touches it, so the oldest were used least recently
+	Algo::SortBy(Entries, &FEntryStat::ModificationTime);
+	for (const FEntryStat& Entry : Entries)
+	{
+		if (TotalBytes <= MaxBytes)
+		{
+			break;
+		}
+
+		// Windows refuses while a read has it mapped, it is in use anyway. Elsewhere the read keeps its mapping of the
+		// unlinked file until it finishes
+		if (IFileManager::Get().Delete(*Entry.Filename, false, false, true))
+		{
+			TotalBytes -= Entry.Size;
+			OutNumEvicted++;
+			OutEvictedBytes += Entry.Size;
+		}
+	}
+}
+
+struct FMutableDiskCacheRead::FState
+{
+	FString Filename;
+	uint64 ObjectVersion = 0;
+	uint64 DescriptorHash = 0;
+
+	/** Decoded on a worker thread */
+	MutableExtensionDiskCache::FEntryFile File;
+	TArray<MutableExtensionDiskCache::FMesh> Entries;
+	EMutableDiskCacheRead DecodeResult = EMutableDiskCacheRead::Missing;
+
+	/** Created on the game thread, then filled on a worker thread */
+	TArray<USkeletalMesh*> CreatedMeshes;
+	TArray<TPair<UTexture2D*, const MutableExtensionDiskCache::FTexture*>> CreatedTextures;
+	bool bDeserialized = false;
+
+	void Decode()
+	{
+		using namespace MutableExtensionDiskCache;
+
+		MUTABLE_EXTENSION_SCOPE(FMutableDiskCacheRead::Decode);
+
+		DecodeResult = DecodeEntry();
+		if (DecodeResult == EMutableDiskCacheRead::Hit)
+		{
+			// Least recently used entries are evicted first
+			IFileManager::Get().SetTimeStamp(*Filename, FDateTime::UtcNow());
+		}
+	}
+
+	EMutableDiskCacheRead DecodeEntry()
+	{
+		using namespace MutableExtensionDiskCache;
+
+		if (!IFileManager::Get().FileExists(*Filename) || !File.Open(Filename))
+		{
+			return EMutableDiskCacheRead::Missing;
+		}
+
+		if (File.Size < FMutableExtensionDiskCache::BlobAlignment)
+		{
+			return EMutableDiskCacheRead::Invalid;
+		}
+
+		FHeader Header;
+		FMemoryReaderView HeaderReader(MakeMemoryView(File.Data, FMutableExtensionDiskCache::BlobAlignment));
+		HeaderReader << Header;
+		if (Header.Magic != MutableExtensionDiskCache::Magic)
+		{
+			return EMutableDiskCacheRead::Invalid;
+		}
+
+		// Same file name, different descriptor, or a different compilation of the object
+		if (Header.FormatVersion != MutableExtensionDiskCache::FormatVersion || Header.DescriptorHash != DescriptorHash ||
+			Header.ObjectVersion != ObjectVersion)
+		{
+			return EMutableDiskCacheRead::Stale;
+		}
+
+		if (!IsBlobValid(Header.Contents, File.Size))
+		{
+			return EMutableDiskCacheRead::Invalid;
+		}
+
+		FMemoryReaderView ContentsReader(MakeMemoryView(File.Data + Header.Contents.Offset, static_cast<uint64>(Header.Contents.Size)));
+		ContentsReader << Entries;
+		if (ContentsReader.IsError() || Entries.Num() == 0 || !AreBlobsValid(Entries, File.Size))
+		{
+			return EMutableDiskCacheRead::Invalid;
+		}
+		return EMutableDiskCacheRead::Hit;
+	}
+
+	void GetReferencedAssets(TArray<FSoftObjectPath>& OutAssets) const
+	{
+		using namespace MutableExtensionDiskCache;
+
+		const auto AddAsset = [&OutAssets](const FString& Path)
+		{
+			if (!Path.IsEmpty())
+			{
+				OutAssets.AddUnique(FSoftObjectPath(Path));
+			}
+		};
+
+		for (const FMesh& Mesh : Entries)
+		{
+			AddAsset(Mesh.SkeletonPath);
+			AddAsset(Mesh.PhysicsAssetPath);
+			for (const FMaterial& Material : Mesh.Materials)
+			{
+				AddAsset(Material.ParentPath);
+				for (const FTexture& Texture : Material.TextureParameters)
+				{
+					AddAsset(Texture.AssetPath);
+				}
+			}
+		}
+	}
+
+	void Deserialize()
+	{
+		using namespace MutableExtensionDiskCache;
+
+		MUTABLE_EXTENSION_SCOPE(FMutableDiskCacheRead::Deserialize);
+
+		for (int32 Index = 0; Index < Entries.Num(); Index++)
+		{
+			if (!ReadMesh(CreatedMeshes[Index], Entries[Index], File.Data))
+			{
+				return;
+			}
+		}
+		for (const TPair<UTexture2D*, const FTexture*>& Texture : CreatedTextures)
+		{
+			ReadTexture(Texture.Key, *Texture.Value, File.Data);
+		}
+		bDeserialized = true;
+	}
+};
+
+FMutableDiskCacheRead::FMutableDiskCacheRead(const UCustomizableObject* CustomizableObject, uint64 DescriptorHash)
+	: State(MakeUnique<FState>())
+{
+	State->Filename = FMutableExtensionDiskCache::GetEntryFilename(CustomizableObject, DescriptorHash);
+	State->ObjectVersion = FMutableExtensionDiskCache::GetObjectVersion(CustomizableObject);
+	State->DescriptorHash = DescriptorHash;
+
+	Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [State = State.Get()]()
+	{
+		State->Decode();
+	});
+}
+
+FMutableDiskCacheRead::~FMutableDiskCacheRead()
+{
+	Task.Wait();
+	if (LoadHandle.IsValid())
+	{
+		LoadHandle->CancelHandle();
+	}
+}
+
+bool FMutableDiskCacheRead::Tick()
+{
+	if (Phase == EPhase::Complete)
+	{
+		return true;
+	}
+
+	if (!Task.IsCompleted())
+	{
+		return false;
+	}
+
+	if (Phase == EPhase::Decode)
+	{
+		if (State->DecodeResult != EMutableDiskCacheRead::Hit)
+		{
+			Complete(State->DecodeResult);
+			return true;
+		}
+
+		TArray<FSoftObjectPath> Assets;
+		State->GetReferencedAssets(Assets);
+		if (Assets.Num() > 0)
+		{
+			LoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Assets));
+		}
+		Phase = EPhase::LoadAssets;
+	}
+
+	if (Phase == EPhase::LoadAssets)
+	{
+		if (LoadHandle.IsValid() && !LoadHandle->HasLoadCompleted())
+		{
+			return false;
+		}
+
+		if (!CreateObjects())
+		{
+			Complete(EMutableDiskCacheRead::Invalid);
+			return true;
+		}
+
+		Phase = EPhase::Deserialize;
+		Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [State = State.Get()]()
+		{
+			State->Deserialize();
+		});
+		return false;
+	}
+
+	Complete(InitResources() ? EMutableDiskCacheRead::Hit : EMutableDiskCacheRead::Invalid);
+	return true;
+}
+
+bool FMutableDiskCacheRead::CreateObjects()
+{
+	using namespace MutableExtensionDiskCache;
+
+	MUTABLE_EXTENSION_SCOPE(FMutableDiskCacheRead::CreateObjects);
+
+	const double StartTime = FPlatformTime::Seconds();
+	ON_SCOPE_EXIT
+	{
+		GameThreadTime += FPlatformTime::Seconds() - StartTime;
+	};
+
+	for (const FMesh& Mesh : State->Entries)
+	{
+		USkeletalMesh* SkeletalMesh = CreateMesh(Mesh, State->CreatedTextures);
+		if (!SkeletalMesh)
+		{
+			UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] failed to load the assets of component %d from %s"),
+				*FString(__FUNCTION__), Mesh.ComponentIndex, *State->Filename);
+			return false;
+		}
+		State->CreatedMeshes.Add(SkeletalMesh);
+	}
+	return true;
+}
+
+bool FMutableDiskCacheRead::InitResources()
+{
+	MUTABLE_EXTENSION_SCOPE(FMutableDiskCacheRead::InitResources);
+
+	const double StartTime = FPlatformTime::Seconds();
+	ON_SCOPE_EXIT
+	{
+		GameThreadTime += FPlatformTime::Seconds() - StartTime;
+	};
+
+	if (!State->bDeserialized)
+	{
+		UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] failed to read render data from %s"),
+			*FString(__FUNCTION__), *State->Filename);
+		return false;
+	}
+
+	for (const TPair<UTexture2D*, const MutableExtensionDiskCache::FTexture*>& Texture : State->CreatedTextures)
+	{
+		Texture.Key->UpdateResource();
+	}
+	for (int32 Index = 0; Index < State->CreatedMeshes.Num(); Index++)
+	{
+		State->CreatedMeshes[Index]->InitResources();
+		Meshes.Add(State->Entries[Index].ComponentIndex, State->CreatedMeshes[Index]);
+	}
+	return true;
+}
+
+void FMutableDiskCacheRead::Complete(EMutableDiskCacheRead InResult)
+{
+	Result = InResult;
+	Phase = EPhase::Complete;
+	BytesRead = Result == EMutableDiskCacheRead::Hit ? State->File.Size : 0;
+
+	// Whatever was created holds its own copy, and the assets are referenced by it
+	State->File.Close();
+	State->Entries.Empty();
+	State->CreatedMeshes.Empty();
+	State->CreatedTextures.Empty();
+	if (LoadHandle.IsValid())
+	{
+		LoadHandle->ReleaseHandle();
+		LoadHandle.Reset();
+	}
+}
+
+void FMutableDiskCacheRead::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(State->CreatedMeshes);
+	for (TPair<UTexture2D*, const MutableExtensionDiskCache::FTexture*>& Texture : State->CreatedTextures)
+	{
+		Collector.AddReferencedObject(Texture.Key);
+	}
+	for (TPair<int32, USkeletalMesh*>& Mesh : Meshes)
+	{
+		Collector.AddReferencedObject(Mesh.Value);
+	}
+}
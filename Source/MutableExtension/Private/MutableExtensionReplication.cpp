@@ -0,0 +1,282 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionReplication.h"
+
+#include "EngineUtils.h"
+#include "MutableExtensionComponent.h"
+#include "MutableExtensionLog.h"
+#include "Math/Float16.h"
+#include "Serialization/BitWriter.h"
+#include "MuCO/CustomizableObject.h"
+#include "MuCO/CustomizableObjectInstance.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(MutableExtensionReplication)
+
+namespace MutableExtensionReplication
+{
+	static int32 FindIntParameterOption(const UCustomizableObject* CustomizableObject, int32 ParameterIndex,
+		const FString& Option)
+	{
+		const int32 NumOptions = CustomizableObject->GetIntParameterNumOptions(ParameterIndex);
+		for (int32 OptionIndex = 0; OptionIndex < NumOptions; OptionIndex++)
+		{
+			if (CustomizableObject->GetIntParameterAvailableOption(ParameterIndex, OptionIndex) == Option)
+			{
+				return OptionIndex;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	static FAutoConsoleCommandWithWorld ReplicationStatsCommand(
+		TEXT("MutableExtension.Replication.Stats"),
+		TEXT("Log descriptor replication bandwidth and apply latency of every UMutableExtensionComponent in the world"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			const TCHAR* NetMode = World->GetNetMode() == NM_Client ? TEXT("Client") : TEXT("Authority");
+			for (TObjectIterator<UMutableExtensionComponent> It; It; ++It)
+			{
+				if (It->GetWorld() != World || !It->bReplicateDescriptors)
+				{
+					continue;
+				}
+
+				const FMutableReplicationStats& Stats = It->GetReplicationStats();
+				UE_LOG(LogMutableExtension, Log, TEXT("[ %s ] { %s } sent %d changes (%d parameters, %.1f bits per change), received %d changes (%d parameters), applied %d updates (latency avg %.2fms max %.2fms)"),
+					NetMode, *GetNameSafe(It->GetOwner()), Stats.NumChangesSent, Stats.NumParametersSent,
+					Stats.AverageBitsPerChange, Stats.NumChangesReceived, Stats.NumParametersReceived, Stats.NumUpdatesApplied,
+					Stats.AverageApplyLatency * 1000.f, Stats.MaxApplyLatency * 1000.f);
+			}
+		}));
+}
+
+bool FMutableReplicatedParameter::Capture(const UCustomizableObjectInstance* Instance, int32 InParameterIndex,
+	EMutableReplicationPrecision Precision)
+{
+	const UCustomizableObject* CustomizableObject = Instance->GetCustomizableObject();
+	const FString& ParameterName = CustomizableObject->GetParameterName(InParameterIndex);
+	ParameterIndex = static_cast<uint16>(InParameterIndex);
+	bQuantized = false;
+	Color = FLinearColor::Transparent;
+
+	switch (CustomizableObject->GetParameterTypeByIndex(InParameterIndex))
+	{
+	case EMutableParameterType::Bool:
+		Type = EMutableReplicatedParameterType::Bool;
+		Value = Instance->GetBoolParameterSelectedOption(ParameterName) ? 1 : 0;
+		return true;
+	case EMutableParameterType::Int:
+		{
+			// Offset by one so that no selection is still a valid packed value
+			const FString& Option = Instance->GetIntParameterSelectedOption(ParameterName);
+			Type = EMutableReplicatedParameterType::Int;
+			Value = MutableExtensionReplication::FindIntParameterOption(CustomizableObject, InParameterIndex, Option) + 1;
+			return true;
+		}
+	case EMutableParameterType::Float:
+		{
+			const float FloatValue = Instance->GetFloatParameterSelectedOption(ParameterName);
+			Type = EMutableReplicatedParameterType::Float;
+			bQuantized = Precision == EMutableReplicationPrecision::Quantized;
+			Value = bQuantized ? FFloat16(FloatValue).Encoded : FMath::AsUInt(FloatValue);
+			return true;
+		}
+	case EMutableParameterType::Color:
+		{
+			const FLinearColor ColorValue = Instance->GetColorParameterSelectedOption(ParameterName);
+			Type = EMutableReplicatedParameterType::Color;
+			bQuantized = Precision == EMutableReplicationPrecision::Quantized;
+			Value = bQuantized ? ColorValue.QuantizeRound().DWColor() : 0;
+			Color = bQuantized ? FLinearColor::Transparent : ColorValue;
+			return true;
+		}
+	default:
+		return false;
+	}
+}
+
+void FMutableReplicatedParameter::Apply(UCustomizableObjectInstance* Instance) const
+{
+	const UCustomizableObject* CustomizableObject = Instance->GetCustomizableObject();
+	if (!CustomizableObject || ParameterIndex >= CustomizableObject->GetParameterCount())
+	{
+		return;
+	}
+
+	const FString& ParameterName = CustomizableObject->GetParameterName(ParameterIndex);
+	switch (Type)
+	{
+	case EMutableReplicatedParameterType::Bool:
+		Instance->SetBoolParameterSelectedOption(ParameterName, Value != 0);
+		break;
+	case EMutableReplicatedParameterType::Int:
+		{
+			const int32 OptionIndex = static_cast<int32>(Value) - 1;
+			if (OptionIndex >= 0 && OptionIndex < CustomizableObject->GetIntParameterNumOptions(ParameterIndex))
+			{
+				Instance->SetIntParameterSelectedOption(ParameterName,
+					CustomizableObject->GetIntParameterAvailableOption(ParameterIndex, OptionIndex));
+			}
+			break;
+		}
+	case EMutableReplicatedParameterType::Float:
+		if (bQuantized)
+		{
+			FFloat16 Half;
+			Half.Encoded = static_cast<uint16>(Value);
+			Instance->SetFloatParameterSelectedOption(ParameterName, Half.GetFloat());
+		}
+		else
+		{
+			Instance->SetFloatParameterSelectedOption(ParameterName, FMath::AsFloat(Value));
+		}
+		break;
+	case EMutableReplicatedParameterType::Color:
+		Instance->SetColorParameterSelectedOption(ParameterName, bQuantized ? FColor(Value).ReinterpretAsLinear() : Color);
+		break;
+	}
+}
+
+bool FMutableReplicatedParameter::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 PackedComponentIndex = ComponentIndex;
+	uint32 PackedParameterIndex = ParameterIndex;
+	Ar.SerializeIntPacked(PackedComponentIndex);
+	Ar.SerializeIntPacked(PackedParameterIndex);
+
+	uint8 PackedType = static_cast<uint8>(Type);
+	Ar.SerializeBits(&PackedType, 2);
+
+	switch (static_cast<EMutableReplicatedParameterType>(PackedType))
+	{
+	case EMutableReplicatedParameterType::Bool:
+		{
+			uint8 PackedValue = Value != 0;
+			Ar.SerializeBits(&PackedValue, 1);
+			Value = PackedValue;
+			break;
+		}
+	case EMutableReplicatedParameterType::Int:
+		Ar.SerializeIntPacked(Value);
+		break;
+	case EMutableReplicatedParameterType::Float:
+		{
+			uint8 PackedQuantized = bQuantized;
+			Ar.SerializeBits(&PackedQuantized, 1);
+			bQuantized = PackedQuantized != 0;
+			if (bQuantized)
+			{
+				uint16 PackedValue = static_cast<uint16>(Value);
+				Ar << PackedValue;
+				Value = PackedValue;
+			}
+			else
+			{
+				Ar << Value;
+			}
+			break;
+		}
+	case EMutableReplicatedParameterType::Color:
+		{
+			uint8 PackedQuantized = bQuantized;
+			Ar.SerializeBits(&PackedQuantized, 1);
+			bQuantized = PackedQuantized != 0;
+			if (bQuantized)
+			{
+				Ar << Value;
+			}
+			else
+			{
+				Ar << Color;
+			}
+			break;
+		}
+	}
+
+	if (Ar.IsLoading())
+	{
+		ComponentIndex = static_cast<uint16>(PackedComponentIndex);
+		ParameterIndex = static_cast<uint16>(PackedParameterIndex);
+		Type = static_cast<EMutableReplicatedParameterType>(PackedType);
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+int32 FMutableReplicatedDescriptor::Capture(const UCustomizableObjectInstance* Instance, int32 ComponentIndex,
+	int64& OutNumBits, EMutableReplicationPrecision Precision)
+{
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	if (!CustomizableObject || !ensure(ComponentIndex <= MAX_uint16))
+	{
+		return 0;
+	}
+
+	// Reused to measure what each changed parameter costs on the wire
+	FBitWriter Writer(0, true);
+
+	int32 NumChanged = 0;
+	const int32 NumParameters = FMath::Min<int32>(CustomizableObject->GetParameterCount(), MAX_uint16 + 1);
+	for (int32 ParameterIndex = 0; ParameterIndex < NumParameters; ParameterIndex++)
+	{
+		FMutableReplicatedParameter Captured;
+		Captured.ComponentIndex = static_cast<uint16>(ComponentIndex);
+		if (!Captured.Capture(Instance, ParameterIndex, Precision))
+		{
+			continue;
+		}
+
+		FMutableReplicatedParameter* Parameter;
+		if (const int32* Index = ParameterIndices.Find(Captured.GetKey()))
+		{
+			Parameter = &Parameters[*Index];
+			if (Parameter->HasSameValue(Captured))
+			{
+				continue;
+			}
+			Parameter->Type = Captured.Type;
+			Parameter->bQuantized = Captured.bQuantized;
+			Parameter->Value = Captured.Value;
+			Parameter->Color = Captured.Color;
+		}
+		else
+		{
+			ParameterIndices.Add(Captured.GetKey(), Parameters.Num());
+			Parameter = &Parameters.Add_GetRef(Captured);
+		}
+
+		MarkItemDirty(*Parameter);
+		NumChanged++;
+
+		bool bSuccess;
+		Writer.Reset();
+		Parameter->NetSerialize(Writer, nullptr, bSuccess);
+		OutNumBits += Writer.GetNumBits();
+	}
+	return NumChanged;
+}
+
+void FMutableReplicatedDescriptor::Reset()
+{
+	Parameters.Reset();
+	ParameterIndices.Reset();
+	MarkArrayDirty();
+}
+
+void FMutableReplicatedDescriptor::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
+{
+	if (Owner)
+	{
+		Owner->ApplyReplicatedParameters(AddedIndices);
+	}
+}
+
+void FMutableReplicatedDescriptor::PostReplicatedChange(const TArrayView<int32>& ChangedIndices, int32 FinalSize)
+{
+	if (Owner)
+	{
+		Owner->ApplyReplicatedParameters(ChangedIndices);
+	}
+}
@@ -0,0 +1,782 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionSnapshot.h"
+
+#include "MutableExtensionComponent.h"
+#include "MutableExtensionLog.h"
+#include "MutableExtensionTrace.h"
+#include "MutableExtensionTypes.h"
+#include "EngineUtils.h"
+#include "Async/ParallelFor.h"
+#include "GameFramework/Actor.h"
+#include "Hash/CityHash.h"
+#include "Memory/MemoryView.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "MuCO/CustomizableObject.h"
+#include "MuCO/CustomizableObjectInstance.h"
+#include "MuCO/CustomizableSkeletalComponent.h"
+
+namespace MutableExtensionSnapshot
+{
+	static constexpr uint32 Magic = 0x5357584D;
+
+	enum class EParameterType : uint8
+	{
+		Bool,
+		Int,
+		Float,
+		Color,
+	};
+
+	/** Name and value of a parameter. Int options are string indices, floats and colors are stored as their bits */
+	struct FParameter
+	{
+		uint32 Name = 0;
+		EParameterType Type = EParameterType::Bool;
+		uint32 Value[4] = {};
+
+		bool operator==(const FParameter& Other) const
+		{
+			return Name == Other.Name && Type == Other.Type && FMemory::Memcmp(Value, Other.Value, sizeof(Value)) == 0;
+		}
+
+		friend uint32 GetTypeHash(const FParameter& Parameter)
+		{
+			return HashCombineFast(HashCombineFast(Parameter.Name, static_cast<uint32>(Parameter.Type)),
+				FCrc::MemCrc32(Parameter.Value, sizeof(Parameter.Value)));
+		}
+
+		friend FArchive& operator<<(FArchive& Ar, FParameter& Parameter)
+		{
+			uint8 PackedType = static_cast<uint8>(Parameter.Type);
+			Ar.SerializeIntPacked(Parameter.Name);
+			Ar << PackedType;
+			Parameter.Type = static_cast<EParameterType>(PackedType);
+
+			switch (Parameter.Type)
+			{
+			case EParameterType::Bool:
+			case EParameterType::Int:
+				Ar.SerializeIntPacked(Parameter.Value[0]);
+				break;
+			case EParameterType::Float:
+				Ar << Parameter.Value[0];
+				break;
+			case EParameterType::Color:
+				Ar << Parameter.Value[0] << Parameter.Value[1] << Parameter.Value[2] << Parameter.Value[3];
+				break;
+			default:
+				Ar.SetError();
+				break;
+			}
+			return Ar;
+		}
+	};
+
+	struct FComponent
+	{
+		uint32 Name = 0;
+		uint32 Descriptor = 0;
+
+		/** Name, made an FName on a worker thread when applying */
+		FName ComponentName;
+	};
+
+	struct FActor
+	{
+		uint32 Id = 0;
+		TArray<FComponent> Components;
+
+		/** Id, made an FName on a worker thread when applying */
+		FName SnapshotId;
+	};
+
+	/** Every parameter of a descriptor, resolved on a worker thread */
+	struct FDecodedDescriptor
+	{
+		uint32 Object = 0;
+		TArray<uint32> Parameters;
+		bool bValid = false;
+	};
+
+	/** A parameter of a Customizable Object, copied on the game thread so worker threads never query the object */
+	struct FObjectParameter
+	{
+		EMutableParameterType Type = EMutableParameterType::None;
+
+		/** Int parameters only */
+		TArray<FString> Options;
+	};
+
+	/** A Customizable Object used by the matched instances, and which of the snapshot's parameters still apply to it */
+	struct FResolvedObject
+	{
+		/** Index into the snapshot's objects, or INDEX_NONE if the snapshot has no descriptors for it */
+		int32 Object = INDEX_NONE;
+
+		/** Every parameter the object has by name, only gathered if the snapshot has descriptors for it */
+		TMap<FString, FObjectParameter> ObjectParameters;
+
+		/** By snapshot parameter index, one element each so worker threads never write the same word */
+		TArray<bool> Applies;
+
+		/** Parameters already queued for resolving, game thread only */
+		TBitArray<> Queued;
+	};
+
+	/** A component in the world matched to a component in the snapshot */
+	struct FMatch
+	{
+		UMutableExtensionComponent* ExtensionComponent = nullptr;
+		UCustomizableSkeletalComponent* MutableComponent = nullptr;
+		uint32 Descriptor = 0;
+		int32 Object = 0;
+	};
+
+	struct FResolveWork
+	{
+		int32 Object = 0;
+		uint32 Parameter = 0;
+	};
+
+	/** FString keys compare case insensitively by default, but parameter names and options don't */
+	struct FStringKeyFuncs : TDefaultMapKeyFuncs<FString, uint32, false>
+	{
+		static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+		static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+	};
+
+	/** Strings, objects, parameters and descriptors, each stored once however many instances use them */
+	struct FTables
+	{
+		TArray<FString> Strings;
+		TMap<FString, uint32, FDefaultSetAllocator, FStringKeyFuncs> StringIndices;
+
+		TArray<uint32> Objects;
+		TMap<uint32, uint32> ObjectIndices;
+
+		TArray<FParameter> Parameters;
+		TMap<FParameter, uint32> ParameterIndices;
+
+		TArray<TArray<uint8>> Descriptors;
+		TMultiMap<uint64, uint32> DescriptorIndices;
+
+		uint32 AddString(const FString& String)
+		{
+			if (const uint32* Index = StringIndices.Find(String))
+			{
+				return *Index;
+			}
+			return StringIndices.Add(String, Strings.Add(String));
+		}
+
+		uint32 AddObject(const UCustomizableObject* CustomizableObject)
+		{
+			const uint32 Path = AddString(GetPathNameSafe(CustomizableObject));
+			if (const uint32* Index = ObjectIndices.Find(Path))
+			{
+				return *Index;
+			}
+			return ObjectIndices.Add(Path, Objects.Add(Path));
+		}
+
+		uint32 AddParameter(const FParameter& Parameter)
+		{
+			if (const uint32* Index = ParameterIndices.Find(Parameter))
+			{
+				return *Index;
+			}
+			return ParameterIndices.Add(Parameter, Parameters.Add(Parameter));
+		}
+
+		bool CaptureParameter(const UCustomizableObjectInstance* Instance, int32 ParameterIndex, FParameter& OutParameter)
+		{
+			const UCustomizableObject* CustomizableObject = Instance->GetCustomizableObject();
+			const FString& ParameterName = CustomizableObject->GetParameterName(ParameterIndex);
+
+			switch (CustomizableObject->GetParameterTypeByIndex(ParameterIndex))
+			{
+			case EMutableParameterType::Bool:
+				OutParameter.Type = EParameterType::Bool;
+				OutParameter.Value[0] = Instance->GetBoolParameterSelectedOption(ParameterName) ? 1 : 0;
+				break;
+			case EMutableParameterType::Int:
+				OutParameter.Type = EParameterType::Int;
+				OutParameter.Value[0] = AddString(Instance->GetIntParameterSelectedOption(ParameterName));
+				break;
+			case EMutableParameterType::Float:
+				{
+					const float Value = Instance->GetFloatParameterSelectedOption(ParameterName);
+					OutParameter.Type = EParameterType::Float;
+					FMemory::Memcpy(OutParameter.Value, &Value, sizeof(Value));
+					break;
+				}
+			case EMutableParameterType::Color:
+				{
+					static_assert(sizeof(FLinearColor) == sizeof(FParameter::Value));
+					const FLinearColor Value = Instance->GetColorParameterSelectedOption(ParameterName);
+					OutParameter.Type = EParameterType::Color;
+					FMemory::Memcpy(OutParameter.Value, &Value, sizeof(Value));
+					break;
+				}
+			default:
+				return false;
+			}
+
+			OutParameter.Name = AddString(ParameterName);
+			return true;
+		}
+
+		uint32 AddDescriptor(const UCustomizableObjectInstance* Instance)
+		{
+			const UCustomizableObject* CustomizableObject = Instance->GetCustomizableObject();
+
+			TArray<uint32> ParameterIndices;
+			const int32 NumParameters = CustomizableObject->GetParameterCount();
+			ParameterIndices.Reserve(NumParameters);
+			for (int32 ParameterIndex = 0; ParameterIndex < NumParameters; ParameterIndex++)
+			{
+				FParameter Parameter;
+				if (CaptureParameter(Instance, ParameterIndex, Parameter))
+				{
+					ParameterIndices.Add(AddParameter(Parameter));
+				}
+			}
+
+			// Sorted so that the deltas between indices are small, and so equal descriptors encode identically
+			ParameterIndices.Sort();
+
+			TArray<uint8> Descriptor;
+			FMemoryWriter Ar(Descriptor);
+			uint32 Object = AddObject(CustomizableObject);
+			uint32 NumIndices = ParameterIndices.Num();
+			Ar.SerializeIntPacked(Object);
+			Ar.SerializeIntPacked(NumIndices);
+			uint32 PreviousIndex = 0;
+			for (const uint32 Index : ParameterIndices)
+			{
+				uint32 Delta = Index - PreviousIndex;
+				Ar.SerializeIntPacked(Delta);
+				PreviousIndex = Index;
+			}
+
+			const uint64 Hash = CityHash64(reinterpret_cast<const char*>(Descriptor.GetData()), Descriptor.Num());
+			TArray<uint32, TInlineAllocator<1>> Candidates;
+			DescriptorIndices.MultiFind(Hash, Candidates);
+			for (const uint32 Candidate : Candidates)
+			{
+				if (Descriptors[Candidate] == Descriptor)
+				{
+					return Candidate;
+				}
+			}
+
+			const uint32 Index = Descriptors.Add(MoveTemp(Descriptor));
+			DescriptorIndices.Add(Hash, Index);
+			return Index;
+		}
+	};
+
+	static void SerializeString(FArchive& Ar, FString& String)
+	{
+		if (Ar.IsLoading())
+		{
+			uint32 Length = 0;
+			Ar.SerializeIntPacked(Length);
+			if (Ar.IsError() || static_cast<int64>(Length) > Ar.TotalSize() - Ar.Tell())
+			{
+				Ar.SetError();
+				return;
+			}
+			TArray<UTF8CHAR> Chars;
+			Chars.SetNumUninitialized(Length);
+			Ar.Serialize(Chars.GetData(), Length);
+			String = FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Chars.GetData()), Length));
+		}
+		else
+		{
+			const FTCHARToUTF8 Chars(*String);
+			uint32 Length = Chars.Length();
+			Ar.SerializeIntPacked(Length);
+			Ar.Serialize(const_cast<ANSICHAR*>(Chars.Get()), Length);
+		}
+	}
+
+	/** Read a packed count, rejecting any that couldn't possibly fit in what is left of the data */
+	static uint32 ReadCount(FArchive& Ar)
+	{
+		uint32 Count = 0;
+		Ar.SerializeIntPacked(Count);
+		if (Ar.IsError() || static_cast<int64>(Count) > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return 0;
+		}
+		return Count;
+	}
+
+	static bool DecodeDescriptor(FMemoryView View, uint32 NumObjects, uint32 NumParameters, FDecodedDescriptor& OutDescriptor)
+	{
+		FMemoryReaderView Ar(View);
+		Ar.SerializeIntPacked(OutDescriptor.Object);
+		const uint32 NumIndices = ReadCount(Ar);
+		if (Ar.IsError() || OutDescriptor.Object >= NumObjects)
+		{
+			return false;
+		}
+
+		OutDescriptor.Parameters.Reserve(NumIndices);
+		uint32 Index = 0;
+		for (uint32 Count = 0; Count < NumIndices; Count++)
+		{
+			uint32 Delta = 0;
+			Ar.SerializeIntPacked(Delta);
+			Index += Delta;
+			if (Ar.IsError() || Index >= NumParameters)
+			{
+				return false;
+			}
+			OutDescriptor.Parameters.Add(Index);
+		}
+		return true;
+	}
+
+	/** Copy what ParameterApplies() needs to know about each of the object's parameters, game thread only */
+	static void GatherObjectParameters(const UCustomizableObject* CustomizableObject, TMap<FString, FObjectParameter>& OutParameters)
+	{
+		const int32 NumParameters = CustomizableObject->GetParameterCount();
+		OutParameters.Reserve(NumParameters);
+		for (int32 ParameterIndex = 0; ParameterIndex < NumParameters; ParameterIndex++)
+		{
+			FObjectParameter& ObjectParameter = OutParameters.Add(CustomizableObject->GetParameterName(ParameterIndex));
+			ObjectParameter.Type = CustomizableObject->GetParameterTypeByIndex(ParameterIndex);
+			if (ObjectParameter.Type != EMutableParameterType::Int)
+			{
+				continue;
+			}
+
+			const int32 NumOptions = CustomizableObject->GetIntParameterNumOptions(ParameterIndex);
+			ObjectParameter.Options.Reserve(NumOptions);
+			for (int32 OptionIndex = 0; OptionIndex < NumOptions; OptionIndex++)
+			{
+				ObjectParameter.Options.Add(CustomizableObject->GetIntParameterAvailableOption(ParameterIndex, OptionIndex));
+			}
+		}
+	}
+
+	/**
+	 * Parameters the object no longer has, or has with a different type or options, keep their current value
+	 * Called on worker threads, so only reads the copy made by GatherObjectParameters()
+	 */
+	static bool ParameterApplies(const TMap<FString, FObjectParameter>& ObjectParameters, const FParameter& Parameter, const TArray<FString>& Strings)
+	{
+		const FObjectParameter* ObjectParameter = ObjectParameters.Find(Strings[Parameter.Name]);
+		if (!ObjectParameter)
+		{
+			return false;
+		}
+
+		switch (ObjectParameter->Type)
+		{
+		case EMutableParameterType::Bool:
+			return Parameter.Type == EParameterType::Bool;
+		case EMutableParameterType::Int:
+			return Parameter.Type == EParameterType::Int && ObjectParameter->Options.Contains(Strings[Parameter.Value[0]]);
+		case EMutableParameterType::Float:
+			return Parameter.Type == EParameterType::Float;
+		case EMutableParameterType::Color:
+			return Parameter.Type == EParameterType::Color;
+		default:
+			return false;
+		}
+	}
+
+	/** Set a parameter already known to apply to the instance's object */
+	static void ApplyParameter(UCustomizableObjectInstance* Instance, const FParameter& Parameter, const TArray<FString>& Strings)
+	{
+		const FString& ParameterName = Strings[Parameter.Name];
+		switch (Parameter.Type)
+		{
+		case EParameterType::Bool:
+			Instance->SetBoolParameterSelectedOption(ParameterName, Parameter.Value[0] != 0);
+			break;
+		case EParameterType::Int:
+			Instance->SetIntParameterSelectedOption(ParameterName, Strings[Parameter.Value[0]]);
+			break;
+		case EParameterType::Float:
+			{
+				float Value;
+				FMemory::Memcpy(&Value, Parameter.Value, sizeof(Value));
+				Instance->SetFloatParameterSelectedOption(ParameterName, Value);
+				break;
+			}
+		case EParameterType::Color:
+			{
+				FLinearColor Value;
+				FMemory::Memcpy(&Value, Parameter.Value, sizeof(Value));
+				Instance->SetColorParameterSelectedOption(ParameterName, Value);
+				break;
+			}
+		}
+	}
+}
+
+bool FMutableWorldSnapshot::Save(const UWorld* World, TArray<uint8>& OutData, FMutableSnapshotStats& OutStats)
+{
+	MUTABLE_EXTENSION_SCOPE(FMutableWorldSnapshot::Save);
+
+	using namespace MutableExtensionSnapshot;
+
+	OutData.Reset();
+	OutStats = {};
+	if (!World)
+	{
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FTables Tables;
+	TArray<FActor> Actors;
+	for (TObjectIterator<UMutableExtensionComponent> It; It; ++It)
+	{
+		if (It->GetWorld() != World || !IsValid(*It))
+		{
+			continue;
+		}
+
+		FActor Actor;
+		for (const UCustomizableSkeletalComponent* Component : It->GetMutableInitializingComponents())
+		{
+			const UCustomizableObjectInstance* Instance = IsValid(Component) ? Component->CustomizableObjectInstance : nullptr;
+			if (Instance && Instance->GetCustomizableObject())
+			{
+				Actor.Components.Add({ Tables.AddString(Component->GetName()), Tables.AddDescriptor(Instance) });
+			}
+		}
+
+		if (Actor.Components.Num() > 0)
+		{
+			Actor.Id = Tables.AddString(It->GetSnapshotId().ToString());
+			OutStats.NumInstances += Actor.Components.Num();
+			Actors.Add(MoveTemp(Actor));
+		}
+	}
+
+	if (Actors.Num() == 0)
+	{
+		return false;
+	}
+
+	FMemoryWriter Ar(OutData);
+	uint32 PackedMagic = Magic;
+	uint32 PackedVersion = FormatVersion;
+	Ar << PackedMagic << PackedVersion;
+
+	uint32 Count = Tables.Strings.Num();
+	Ar.SerializeIntPacked(Count);
+	for (FString& String : Tables.Strings)
+	{
+		SerializeString(Ar, String);
+	}
+
+	Count = Tables.Objects.Num();
+	Ar.SerializeIntPacked(Count);
+	for (uint32& Object : Tables.Objects)
+	{
+		Ar.SerializeIntPacked(Object);
+	}
+
+	Count = Tables.Parameters.Num();
+	Ar.SerializeIntPacked(Count);
+	for (FParameter& Parameter : Tables.Parameters)
+	{
+		Ar << Parameter;
+	}
+
+	Count = Tables.Descriptors.Num();
+	Ar.SerializeIntPacked(Count);
+	for (TArray<uint8>& Descriptor : Tables.Descriptors)
+	{
+		uint32 Size = Descriptor.Num();
+		Ar.SerializeIntPacked(Size);
+		Ar.Serialize(Descriptor.GetData(), Descriptor.Num());
+	}
+
+	Count = Actors.Num();
+	Ar.SerializeIntPacked(Count);
+	for (FActor& Actor : Actors)
+	{
+		Ar.SerializeIntPacked(Actor.Id);
+		uint32 NumComponents = Actor.Components.Num();
+		Ar.SerializeIntPacked(NumComponents);
+		for (FComponent& Component : Actor.Components)
+		{
+			Ar.SerializeIntPacked(Component.Name);
+			Ar.SerializeIntPacked(Component.Descriptor);
+		}
+	}
+
+	OutStats.SizeBytes = OutData.Num();
+	OutStats.NumActors = Actors.Num();
+	OutStats.NumUniqueDescriptors = Tables.Descriptors.Num();
+	OutStats.NumUniqueParameters = Tables.Parameters.Num();
+	OutStats.NumStrings = Tables.Strings.Num();
+	OutStats.EncodeTimeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	return true;
+}
+
+bool FMutableWorldSnapshot::Apply(const UWorld* World, const TArray<uint8>& Data,
+	TMap<UMutableExtensionComponent*, TArray<UCustomizableSkeletalComponent*>>& OutRestored, FMutableSnapshotStats& OutStats)
+{
+	MUTABLE_EXTENSION_SCOPE(FMutableWorldSnapshot::Apply);
+
+	using namespace MutableExtensionSnapshot;
+
+	OutRestored.Reset();
+	OutStats = {};
+	if (!World)
+	{
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FMemoryReader Ar(Data);
+	uint32 PackedMagic = 0;
+	uint32 PackedVersion = 0;
+	Ar << PackedMagic << PackedVersion;
+	if (Ar.IsError() || PackedMagic != Magic || PackedVersion != FormatVersion)
+	{
+		return false;
+	}
+
+	// The tables are small, only the descriptors and names are worth decoding in parallel
+	TArray<FString> Strings;
+	Strings.SetNum(ReadCount(Ar));
+	for (FString& String : Strings)
+	{
+		SerializeString(Ar, String);
+	}
+
+	TArray<uint32> Objects;
+	Objects.SetNum(ReadCount(Ar));
+	for (uint32& Object : Objects)
+	{
+		Ar.SerializeIntPacked(Object);
+		if (Object >= static_cast<uint32>(Strings.Num()))
+		{
+			Ar.SetError();
+		}
+	}
+
+	TArray<FParameter> Parameters;
+	Parameters.SetNum(ReadCount(Ar));
+	for (FParameter& Parameter : Parameters)
+	{
+		Ar << Parameter;
+		if (Parameter.Name >= static_cast<uint32>(Strings.Num()) ||
+			(Parameter.Type == EParameterType::Int && Parameter.Value[0] >= static_cast<uint32>(Strings.Num())))
+		{
+			Ar.SetError();
+		}
+	}
+
+	TArray<FMemoryView> DescriptorViews;
+	DescriptorViews.SetNum(ReadCount(Ar));
+	for (FMemoryView& View : DescriptorViews)
+	{
+		const uint32 Size = ReadCount(Ar);
+		View = MakeMemoryView(Data.GetData() + Ar.Tell(), Size);
+		Ar.Seek(Ar.Tell() + Size);
+	}
+
+	TArray<FActor> Actors;
+	Actors.SetNum(ReadCount(Ar));
+	for (FActor& Actor : Actors)
+	{
+		Ar.SerializeIntPacked(Actor.Id);
+		Actor.Components.SetNum(ReadCount(Ar));
+		for (FComponent& Component : Actor.Components)
+		{
+			Ar.SerializeIntPacked(Component.Name);
+			Ar.SerializeIntPacked(Component.Descriptor);
+			if (Component.Name >= static_cast<uint32>(Strings.Num()) ||
+				Component.Descriptor >= static_cast<uint32>(DescriptorViews.Num()))
+			{
+				Ar.SetError();
+			}
+		}
+		if (Actor.Id >= static_cast<uint32>(Strings.Num()))
+		{
+			Ar.SetError();
+		}
+		if (Ar.IsError())
+		{
+			break;
+		}
+	}
+
+	if (Ar.IsError())
+	{
+		return false;
+	}
+
+	// One task per descriptor or actor, each is worth far more than the cost of scheduling it
+	TArray<FDecodedDescriptor> Descriptors;
+	Descriptors.SetNum(DescriptorViews.Num());
+	ParallelFor(TEXT("MutableExtension.Snapshot.Decode"), Descriptors.Num() + Actors.Num(), 1, [&](int32 Index)
+	{
+		if (Index < Descriptors.Num())
+		{
+			Descriptors[Index].bValid = DecodeDescriptor(DescriptorViews[Index], Objects.Num(), Parameters.Num(), Descriptors[Index]);
+			return;
+		}
+
+		FActor& Actor = Actors[Index - Descriptors.Num()];
+		Actor.SnapshotId = FName(Strings[Actor.Id]);
+		for (FComponent& Component : Actor.Components)
+		{
+			Component.ComponentName = FName(Strings[Component.Name]);
+		}
+	});
+
+	TMap<FString, int32> ObjectsByPath;
+	for (int32 Object = 0; Object < Objects.Num(); Object++)
+	{
+		ObjectsByPath.Add(Strings[Objects[Object]], Object);
+	}
+
+	TMap<FName, UMutableExtensionComponent*> ExtensionComponents;
+	for (TObjectIterator<UMutableExtensionComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && IsValid(*It) && It->GetOwner())
+		{
+			ExtensionComponents.Add(It->GetSnapshotId(), *It);
+		}
+	}
+
+	// Match on the game thread, where the components can be found, touching each Customizable Object's path only once
+	TArray<FMatch> Matches;
+	TArray<FResolvedObject> ResolvedObjects;
+	TMap<const UCustomizableObject*, int32> ResolvedObjectIndices;
+	TInlineComponentArray<UCustomizableSkeletalComponent*> MutableComponents;
+	for (const FActor& Actor : Actors)
+	{
+		OutStats.NumInstances += Actor.Components.Num();
+
+		UMutableExtensionComponent* const* ExtensionComponent = ExtensionComponents.Find(Actor.SnapshotId);
+		if (!ExtensionComponent)
+		{
+			OutStats.NumUnmatched += Actor.Components.Num();
+			continue;
+		}
+
+		MutableComponents.Reset();
+		(*ExtensionComponent)->GetOwner()->GetComponents(MutableComponents);
+
+		for (const FComponent& Component : Actor.Components)
+		{
+			const FDecodedDescriptor& Descriptor = Descriptors[Component.Descriptor];
+			UCustomizableSkeletalComponent* const* MutableComponent = MutableComponents.FindByPredicate(
+				[&Component](const UCustomizableSkeletalComponent* Candidate)
+				{
+					return Candidate->GetFName() == Component.ComponentName;
+				});
+			const UCustomizableObjectInstance* Instance = MutableComponent ? (*MutableComponent)->CustomizableObjectInstance : nullptr;
+			const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+			if (!CustomizableObject || !Descriptor.bValid)
+			{
+				OutStats.NumUnmatched++;
+				continue;
+			}
+
+			int32 ResolvedIndex;
+			if (const int32* Found = ResolvedObjectIndices.Find(CustomizableObject))
+			{
+				ResolvedIndex = *Found;
+			}
+			else
+			{
+				FResolvedObject& Resolved = ResolvedObjects.AddDefaulted_GetRef();
+				if (const int32* Object = ObjectsByPath.Find(GetPathNameSafe(CustomizableObject)))
+				{
+					Resolved.Object = *Object;
+					GatherObjectParameters(CustomizableObject, Resolved.ObjectParameters);
+					Resolved.Applies.SetNumZeroed(Parameters.Num());
+					Resolved.Queued.Init(false, Parameters.Num());
+				}
+				ResolvedIndex = ResolvedObjectIndices.Add(CustomizableObject, ResolvedObjects.Num() - 1);
+			}
+
+			if (ResolvedObjects[ResolvedIndex].Object != static_cast<int32>(Descriptor.Object))
+			{
+				OutStats.NumUnmatched++;
+				continue;
+			}
+
+			Matches.Add({ *ExtensionComponent, *MutableComponent, Component.Descriptor, ResolvedIndex });
+		}
+	}
+
+	// Each parameter is resolved once per Customizable Object, however many descriptors and instances share it
+	TArray<FResolveWork> ResolveWork;
+	TSet<TPair<int32, uint32>> QueuedDescriptors;
+	for (const FMatch& Match : Matches)
+	{
+		bool bAlreadyQueued = false;
+		QueuedDescriptors.Add({ Match.Object, Match.Descriptor }, &bAlreadyQueued);
+		if (bAlreadyQueued)
+		{
+			continue;
+		}
+
+		FResolvedObject& Resolved = ResolvedObjects[Match.Object];
+		for (const uint32 Parameter : Descriptors[Match.Descriptor].Parameters)
+		{
+			if (!Resolved.Queued[Parameter])
+			{
+				Resolved.Queued[Parameter] = true;
+				ResolveWork.Add({ Match.Object, Parameter });
+			}
+		}
+	}
+
+	ParallelFor(TEXT("MutableExtension.Snapshot.Resolve"), ResolveWork.Num(), 1, [&](int32 Index)
+	{
+		const FResolveWork& Work = ResolveWork[Index];
+		FResolvedObject& Resolved = ResolvedObjects[Work.Object];
+		Resolved.Applies[Work.Parameter] = ParameterApplies(Resolved.ObjectParameters, Parameters[Work.Parameter], Strings);
+	});
+
+	// Only the precomputed values are left to set on the game thread
+	for (const FMatch& Match : Matches)
+	{
+		const FResolvedObject& Resolved = ResolvedObjects[Match.Object];
+		UCustomizableObjectInstance* Instance = Match.MutableComponent->CustomizableObjectInstance;
+		for (const uint32 Parameter : Descriptors[Match.Descriptor].Parameters)
+		{
+			if (Resolved.Applies[Parameter])
+			{
+				ApplyParameter(Instance, Parameters[Parameter], Strings);
+			}
+		}
+		OutRestored.FindOrAdd(Match.ExtensionComponent).Add(Match.MutableComponent);
+	}
+
+	if (OutStats.NumUnmatched > 0)
+	{
+		UE_LOG(LogMutableExtension, Verbose, TEXT("[ %s ] { %s } %d of %d instances in the snapshot were not found in the world"),
+			*FString(__FUNCTION__), *GetNameSafe(World), OutStats.NumUnmatched, OutStats.NumInstances);
+	}
+
+	OutStats.SizeBytes = Data.Num();
+	OutStats.NumActors = Actors.Num();
+	OutStats.NumUniqueDescriptors = Descriptors.Num();
+	OutStats.NumUniqueParameters = Parameters.Num();
+	OutStats.NumStrings = Strings.Num();
+	OutStats.DecodeTimeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	return true;
+}
@@ -0,0 +1,2188 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionSubsystem.h"
+
+#include "MutableExtensionDiskCache.h"
+#include "MutableExtensionLog.h"
+#include "MutableExtensionSnapshot.h"
+#include "MutableExtensionTrace.h"
+#include "MutableFunctionLib.h"
+#include "Algo/Sort.h"
+#include "Algo/StableSort.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "Tasks/Task.h"
+#include "MuCO/CustomizableObject.h"
+#include "MuCO/CustomizableObjectInstance.h"
+#include "MuCO/CustomizableObjectInstancePrivate.h"
+#include "MuCO/CustomizableSkeletalComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(MutableExtensionSubsystem)
+
+/** Benchmark capture is for development and test runs, it compiles out of Shipping */
+#define MUTABLEEXTENSION_BENCHMARK_ENABLED (!UE_BUILD_SHIPPING)
+
+namespace MutableExtensionCVars
+{
+	static int32 MaxInFlightUpdates = 8;
+	FAutoConsoleVariableRef CVarMaxInFlightUpdates(
+		TEXT("MutableExtension.Scheduler.MaxInFlightUpdates"),
+		MaxInFlightUpdates,
+		TEXT("Maximum number of updates dispatched to Mutable that have not yet completed. 0 = Unlimited"),
+		ECVF_Default);
+
+	static float MaxDispatchMs = 2.f;
+	FAutoConsoleVariableRef CVarMaxDispatchMs(
+		TEXT("MutableExtension.Scheduler.MaxDispatchMs"),
+		MaxDispatchMs,
+		TEXT("Maximum game thread time in milliseconds spent dispatching queued updates per tick. 0 = Unlimited"),
+		ECVF_Default);
+
+	static bool bDeferOffScreen = false;
+	FAutoConsoleVariableRef CVarDeferOffScreen(
+		TEXT("MutableExtension.Scheduler.DeferOffScreen"),
+		bDeferOffScreen,
+		TEXT("If true, queued updates for actors that are off-screen for every local player are not dispatched until they come into view or MaxOffScreenDeferral elapses"),
+		ECVF_Default);
+
+	static float MaxOffScreenDeferral = 5.f;
+	FAutoConsoleVariableRef CVarMaxOffScreenDeferral(
+		TEXT("MutableExtension.Scheduler.MaxOffScreenDeferral"),
+		MaxOffScreenDeferral,
+		TEXT("Maximum time in seconds an off-screen update is deferred before it is dispatched anyway. 0 = Never dispatch while off-screen"),
+		ECVF_Default);
+
+	static float PriorityPerSecondWaited = 1.f;
+	FAutoConsoleVariableRef CVarPriorityPerSecondWaited(
+		TEXT("MutableExtension.Scheduler.PriorityPerSecondWaited"),
+		PriorityPerSecondWaited,
+		TEXT("Priority added for every second an update has been queued, prevents insignificant updates from starving"),
+		ECVF_Default);
+
+	static int32 MaxCacheSizeMB = 512;
+	FAutoConsoleVariableRef CVarMaxCacheSizeMB(
+		TEXT("MutableExtension.Cache.MaxSizeMB"),
+		MaxCacheSizeMB,
+		TEXT("Estimated size in megabytes of shared instances to keep once nothing references them. Referenced instances are never evicted"),
+		ECVF_Default);
+
+	static float BackgroundPriorityScale = 0.1f;
+	FAutoConsoleVariableRef CVarBackgroundPriorityScale(
+		TEXT("MutableExtension.Scheduler.BackgroundPriorityScale"),
+		BackgroundPriorityScale,
+		TEXT("Significance multiplier for background updates, such as full detail refinement of progressive initialization"),
+		ECVF_Default);
+
+	static float UpdateTimeout = 10.f;
+	FAutoConsoleVariableRef CVarUpdateTimeout(
+		TEXT("MutableExtension.Scheduler.Timeout"),
+		UpdateTimeout,
+		TEXT("Seconds an update can be in flight before it is considered stalled and retried. 0 = Never"),
+		ECVF_Default);
+
+	static int32 MaxAttempts = 3;
+	FAutoConsoleVariableRef CVarMaxAttempts(
+		TEXT("MutableExtension.Scheduler.MaxAttempts"),
+		MaxAttempts,
+		TEXT("Number of times an update is dispatched before it is completed as timed out"),
+		ECVF_Default);
+
+	static float RetryBackoff = 0.5f;
+	FAutoConsoleVariableRef CVarRetryBackoff(
+		TEXT("MutableExtension.Scheduler.RetryBackoff"),
+		RetryBackoff,
+		TEXT("Seconds to wait before the first retry, doubled for each subsequent attempt"),
+		ECVF_Default);
+
+	static bool bRetryDiscarded = true;
+	FAutoConsoleVariableRef CVarRetryDiscarded(
+		TEXT("MutableExtension.Scheduler.RetryDiscarded"),
+		bRetryDiscarded,
+		TEXT("If true, updates that Mutable discards or replaces are retried the same as stalled updates"),
+		ECVF_Default);
+
+	static int32 MaxMeshSwapsPerFrame = 4;
+	FAutoConsoleVariableRef CVarMaxMeshSwapsPerFrame(
+		TEXT("MutableExtension.MeshSwap.MaxPerFrame"),
+		MaxMeshSwapsPerFrame,
+		TEXT("Maximum number of generated meshes bound per tick when UMutableExtensionComponent::bDeferMeshSwap is enabled. 0 = Unlimited"),
+		ECVF_Default);
+
+	static float MaxMeshSwapWait = 2.f;
+	FAutoConsoleVariableRef CVarMaxMeshSwapWait(
+		TEXT("MutableExtension.MeshSwap.MaxWait"),
+		MaxMeshSwapWait,
+		TEXT("Seconds a generated mesh waits for its textures to stream in before it is bound regardless"),
+		ECVF_Default);
+
+	static float MeshSwapPrestreamSeconds = 5.f;
+	FAutoConsoleVariableRef CVarMeshSwapPrestreamSeconds(
+		TEXT("MutableExtension.MeshSwap.PrestreamSeconds"),
+		MeshSwapPrestreamSeconds,
+		TEXT("Seconds the textures of a generated mesh are forced resident for while it waits to be bound"),
+		ECVF_Default);
+
+	static int32 MemoryBudgetMB = 0;
+	FAutoConsoleVariableRef CVarMemoryBudgetMB(
+		TEXT("MutableExtension.Memory.BudgetMB"),
+		MemoryBudgetMB,
+		TEXT("Generated meshes, materials and textures of registered instances above this are released, least significant first. 0 is unlimited"),
+		ECVF_Default);
+
+	static float MemoryCheckInterval = 0.5f;
+	FAutoConsoleVariableRef CVarMemoryCheckInterval(
+		TEXT("MutableExtension.Memory.CheckInterval"),
+		MemoryCheckInterval,
+		TEXT("Seconds between checking the memory budget and restoring released instances that became significant"),
+		ECVF_Default);
+
+	static float EvictBelowSignificance = 1.f;
+	FAutoConsoleVariableRef CVarEvictBelowSignificance(
+		TEXT("MutableExtension.Memory.EvictBelowSignificance"),
+		EvictBelowSignificance,
+		TEXT("On-screen instances are only released below this significance, off-screen instances always can be"),
+		ECVF_Default);
+
+	static float RestoreAboveSignificance = 2.f;
+	FAutoConsoleVariableRef CVarRestoreAboveSignificance(
+		TEXT("MutableExtension.Memory.RestoreAboveSignificance"),
+		RestoreAboveSignificance,
+		TEXT("Released instances are regenerated once on-screen at or above this significance. Keep above EvictBelowSignificance to avoid thrashing"),
+		ECVF_Default);
+
+	static int32 MaxSpeculationMB = 64;
+	FAutoConsoleVariableRef CVarMaxSpeculationMB(
+		TEXT("MutableExtension.Speculation.MaxMB"),
+		MaxSpeculationMB,
+		TEXT("Generated speculative candidates above this are evicted, oldest first. 0 disables speculative generation"),
+		ECVF_Default);
+
+	static bool bDiskCacheEnabled = true;
+	FAutoConsoleVariableRef CVarDiskCacheEnabled(
+		TEXT("MutableExtension.DiskCache.Enabled"),
+		bDiskCacheEnabled,
+		TEXT("If false, components with bUseDiskCache neither read nor write Saved/MutableExtension/DiskCache"),
+		ECVF_Default);
+
+	static int32 DiskCacheMaxMB = 1024;
+	FAutoConsoleVariableRef CVarDiskCacheMaxMB(
+		TEXT("MutableExtension.DiskCache.MaxMB"),
+		DiskCacheMaxMB,
+		TEXT("Least recently used disk cache entries are deleted once the cache grows beyond this. 0 is unlimited"),
+		ECVF_Default);
+
+#if MUTABLEEXTENSION_BENCHMARK_ENABLED
+	static int32 MaxBenchmarkFrames = 108000;
+	FAutoConsoleVariableRef CVarMaxBenchmarkFrames(
+		TEXT("MutableExtension.Benchmark.MaxFrames"),
+		MaxBenchmarkFrames,
+		TEXT("Maximum number of frame times kept for hitch percentiles, the oldest are overwritten"),
+		ECVF_Default);
+
+	static int32 MaxBenchmarkInitializations = 10000;
+	FAutoConsoleVariableRef CVarMaxBenchmarkInitializations(
+		TEXT("MutableExtension.Benchmark.MaxInitializations"),
+		MaxBenchmarkInitializations,
+		TEXT("Maximum number of initialization times kept for percentiles, the oldest are overwritten"),
+		ECVF_Default);
+
+	FAutoConsoleCommandWithWorld CmdResetBenchmark(
+		TEXT("MutableExtension.Benchmark.Reset"),
+		TEXT("Start capturing a new Mutable Extension benchmark, until MutableExtension.Benchmark.Write"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(World))
+			{
+				Subsystem->ResetBenchmark();
+			}
+		}));
+
+	FAutoConsoleCommandWithWorldAndArgs CmdWriteBenchmark(
+		TEXT("MutableExtension.Benchmark.Write"),
+		TEXT("Write the Mutable Extension benchmark results captured since MutableExtension.Benchmark.Reset as JSON. Optional: Filename"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UMutableExtensionSubsystem* Subsystem = UMutableExtensionSubsystem::Get(World))
+			{
+				Subsystem->WriteBenchmark(Args.Num() > 0 ? Args[0] : FString());
+			}
+		}));
+#endif
+}
+
+namespace MutableExtensionBenchmark
+{
+	/** @return Value at Percentile (0-1) of an already sorted array */
+	static float GetPercentile(const TArray<float>& Sorted, float Percentile)
+	{
+		if (Sorted.Num() == 0)
+		{
+			return 0.f;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	}
+
+	static void WritePercentiles(TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>& Writer, const FString& Name, TArray<float> Values)
+	{
+		Values.Sort();
+		Writer.WriteObjectStart(Name);
+		Writer.WriteValue(TEXT("count"), Values.Num());
+		Writer.WriteValue(TEXT("p50"), GetPercentile(Values, 0.5f));
+		Writer.WriteValue(TEXT("p90"), GetPercentile(Values, 0.9f));
+		Writer.WriteValue(TEXT("p99"), GetPercentile(Values, 0.99f));
+		Writer.WriteValue(TEXT("max"), Values.Num() > 0 ? Values.Last() : 0.f);
+		Writer.WriteObjectEnd();
+	}
+
+	/** Ring buffer, once Samples holds MaxSamples the oldest is overwritten */
+	static void AddSample(TArray<float>& Samples, int32& NextIndex, int32 MaxSamples, float Value)
+	{
+		if (MaxSamples <= 0)
+		{
+			return;
+		}
+
+		if (Samples.Num() < MaxSamples)
+		{
+			Samples.Add(Value);
+			return;
+		}
+
+		NextIndex = NextIndex < Samples.Num() ? NextIndex : 0;
+		Samples[NextIndex++] = Value;
+	}
+}
+
+FMutableScheduledUpdate::FMutableScheduledUpdate(UCustomizableSkeletalComponent* InMutableComponent,
+	const FOnMutableScheduledUpdateCompleted& InOnCompleted, bool bInIgnoreCloseDist, bool bInForceHighPriority)
+	: MutableInstance(InMutableComponent ? InMutableComponent->CustomizableObjectInstance : nullptr)
+	, MutableComponent(InMutableComponent)
+	, OnCompleted(InOnCompleted)
+	, bIgnoreCloseDist(bInIgnoreCloseDist)
+	, bForceHighPriority(bInForceHighPriority)
+	, bInitialization(false)
+	, bByInstance(false)
+	, bBackground(false)
+	, Priority(0.f)
+	, DescriptorHash(0)
+	, UpdateResult(EUpdateResult::Error)
+	, Attempt(0)
+	, DispatchId(0)
+	, bTimedOut(false)
+	, bAbandoned(false)
+	, RetryTime(0.0)
+	, EnqueueTime(0.0)
+	, RequeueTime(0.0)
+	, DispatchTime(0.0)
+	, CompleteTime(0.0)
+{}
+
+UMutableExtensionSubsystem* UMutableExtensionSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UMutableExtensionSubsystem>() : nullptr;
+}
+
+void UMutableExtensionSubsystem::Deinitialize()
+{
+	while (ThreadedRequests.Dequeue()) {}
+	QueuedUpdates.Reset();
+	InFlightUpdates.Reset();
+	ViewPoints.Reset();
+	SchedulerStats = {};
+	PoolStats = {};
+	RecentGenerationTimes.Reset();
+	NextGenerationTimeIndex = 0;
+	ComponentsPendingMeshSwap.Reset();
+	OnInstanceTimedOut.Clear();
+
+	CachedInstances.Reset();
+	CachedInstanceHashes.Reset();
+	CacheStats = {};
+	DescriptorHashes.Reset();
+
+	SpeculativeCandidates.Reset();
+	SpeculativeInFlight = nullptr;
+	SpeculationStats = {};
+
+	DiskCachedInstances.Reset();
+	DiskCacheWrites.Reset();
+	DiskCacheReads.Reset();
+	for (FPendingDiskCacheWrite& Pending : DiskCacheWriteTasks)
+	{
+		Pending.Task.Wait();
+	}
+	DiskCacheWriteTasks.Reset();
+	DiskCacheStats = {};
+
+	InstanceMemory.Reset();
+	MemoryStats = {};
+	NextMemoryCheckTime = 0.0;
+
+	bBenchmarkCapturing = false;
+	BenchmarkInitializationTimes.Empty();
+	BenchmarkFrameTimes.Empty();
+
+	SnapshotRestoringComponents.Reset();
+	SnapshotRestoreTime = 0.0;
+	SnapshotStats = {};
+	OnWorldSnapshotRestored.Clear();
+
+	RegisteredComponents.Reset();
+	RegisteredInstances.Reset();
+	RegisteredStatuses.Reset();
+	RegisteredIndices.Reset();
+	FMemory::Memzero(RegisteredStatusCounts);
+
+	Super::Deinitialize();
+}
+
+void UMutableExtensionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+#if MUTABLEEXTENSION_BENCHMARK_ENABLED
+	if (bBenchmarkCapturing)
+	{
+		MutableExtensionBenchmark::AddSample(BenchmarkFrameTimes, NextBenchmarkFrame, MutableExtensionCVars::MaxBenchmarkFrames,
+			static_cast<float>(FApp::GetDeltaTime() * 1000.0));
+		BenchmarkPeakUsedPhysical = FMath::Max<uint64>(BenchmarkPeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+	}
+#endif
+
+	DrainThreadedRequests();
+	TickDiskCache();
+	CheckInFlightTimeouts();
+	PrioritizeQueuedUpdates();
+	DispatchQueuedUpdates();
+	DispatchSpeculation();
+	ApplyMeshSwaps();
+	EnforceMemoryBudget();
+	CheckSnapshotRestored();
+}
+
+TStatId UMutableExtensionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMutableExtensionSubsystem, STATGROUP_Tickables);
+}
+
+bool UMutableExtensionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	// Preview worlds can contain mutable characters too (e.g. blueprint editor, character creator preview)
+	return Super::DoesSupportWorldType(WorldType) || WorldType == EWorldType::EditorPreview || WorldType == EWorldType::GamePreview;
+}
+
+void UMutableExtensionSubsystem::EnqueueUpdate(UCustomizableSkeletalComponent* MutableComponent,
+	const FOnMutableScheduledUpdateCompleted& OnCompleted, bool bIgnoreCloseDist, bool bForceHighPriority)
+{
+	FMutableScheduledUpdate& Update = QueuedUpdates.Emplace_GetRef(MutableComponent, OnCompleted, bIgnoreCloseDist, bForceHighPriority);
+	Update.EnqueueTime = FPlatformTime::Seconds();
+
+	// Released by the memory budget or read from the disk cache, so this is a first generation and can't be valid to
+	// update yet
+	if (MutableComponent && (ClearInstanceReleased(MutableComponent->CustomizableObjectInstance) ||
+		DiskCachedInstances.Remove(MutableComponent->CustomizableObjectInstance) > 0))
+	{
+		Update.bInitialization = true;
+		Update.bByInstance = true;
+	}
+
+	SchedulerStats.QueueDepth = QueuedUpdates.Num();
+	SchedulerStats.PeakQueueDepth = FMath::Max(SchedulerStats.PeakQueueDepth, SchedulerStats.QueueDepth);
+}
+
+void UMutableExtensionSubsystem::EnqueueInitialization(UCustomizableObjectInstance* Instance,
+	UCustomizableSkeletalComponent* MutableComponent, const FOnMutableScheduledUpdateCompleted& OnCompleted,
+	double RequestTime)
+{
+	// Initialization has always ignored distance and been high priority within Mutable
+	FMutableScheduledUpdate& Update = QueuedUpdates.Emplace_GetRef(MutableComponent, OnCompleted, true, true);
+	Update.MutableInstance = Instance;
+	Update.bInitialization = true;
+	Update.bByInstance = true;
+	Update.EnqueueTime = RequestTime > 0.0 ? RequestTime : FPlatformTime::Seconds();
+
+	// Generated from scratch, whatever was released or read from the disk cache is replaced
+	ClearInstanceReleased(Instance);
+	DiskCachedInstances.Remove(Instance);
+
+	SchedulerStats.QueueDepth = QueuedUpdates.Num();
+	SchedulerStats.PeakQueueDepth = FMath::Max(SchedulerStats.PeakQueueDepth, SchedulerStats.QueueDepth);
+}
+
+void UMutableExtensionSubsystem::EnqueueStagedUpdate(UCustomizableObjectInstance* Instance,
+	UCustomizableSkeletalComponent* MutableComponent, const FOnMutableScheduledUpdateCompleted& OnCompleted,
+	bool bForceHighPriority)
+{
+	// Distance is measured from the components using an instance, and nothing uses this one
+	FMutableScheduledUpdate& Update = QueuedUpdates.Emplace_GetRef(MutableComponent, OnCompleted, true, bForceHighPriority);
+	Update.MutableInstance = Instance;
+	Update.bByInstance = true;
+	Update.EnqueueTime = FPlatformTime::Seconds();
+
+	SchedulerStats.QueueDepth = QueuedUpdates.Num();
+	SchedulerStats.PeakQueueDepth = FMath::Max(SchedulerStats.PeakQueueDepth, SchedulerStats.QueueDepth);
+}
+
+void UMutableExtensionSubsystem::EnqueueRefinement(UCustomizableObjectInstance* Instance,
+	UCustomizableSkeletalComponent* MutableComponent, const FOnMutableScheduledUpdateCompleted& OnCompleted)
+{
+	FMutableScheduledUpdate& Update = QueuedUpdates.Emplace_GetRef(MutableComponent, OnCompleted, false, false);
+	Update.MutableInstance = Instance;
+	Update.bByInstance = true;
+	Update.bBackground = true;
+	Update.EnqueueTime = FPlatformTime::Seconds();
+
+	SchedulerStats.QueueDepth = QueuedUpdates.Num();
+	SchedulerStats.PeakQueueDepth = FMath::Max(SchedulerStats.PeakQueueDepth, SchedulerStats.QueueDepth);
+}
+
+bool UMutableExtensionSubsystem::IsQueued(const UCustomizableObjectInstance* Instance) const
+{
+	return QueuedUpdates.ContainsByPredicate([Instance](const FMutableScheduledUpdate& Update)
+	{
+		return Update.MutableInstance.Get() == Instance;
+	});
+}
+
+bool UMutableExtensionSubsystem::IsInFlight(const UCustomizableObjectInstance* Instance) const
+{
+	return InFlightUpdates.ContainsByPredicate([Instance](const FMutableScheduledUpdate& Update)
+	{
+		return Update.MutableInstance.Get() == Instance;
+	});
+}
+
+int32 UMutableExtensionSubsystem::CancelUpdates(const UCustomizableObjectInstance* Instance)
+{
+	if (!Instance)
+	{
+		return 0;
+	}
+
+	auto IsForInstance = [Instance](const FMutableScheduledUpdate& Update)
+	{
+		return Update.MutableInstance.Get() == Instance;
+	};
+
+	// Somebody else is sharing it and waiting on this generation, let it finish without us
+	const bool bKeepGenerating = IsCachedInstance(Instance) && GetCachedInstanceRefCount(Instance) > 1;
+
+	int32 NumCancelled = 0;
+	for (int32 i = QueuedUpdates.Num() - 1; i >= 0; --i)
+	{
+		FMutableScheduledUpdate& Update = QueuedUpdates[i];
+		if (!IsForInstance(Update))
+		{
+			continue;
+		}
+
+		if (bKeepGenerating && Update.bInitialization)
+		{
+			Update.bAbandoned = true;
+			Update.OnCompleted.Unbind();
+			continue;
+		}
+
+		QueuedUpdates.RemoveAt(i, 1, EAllowShrinking::No);
+		NumCancelled++;
+	}
+
+	for (FMutableScheduledUpdate& Update : InFlightUpdates)
+	{
+		if (IsForInstance(Update) && !Update.bAbandoned)
+		{
+			Update.bAbandoned = true;
+			Update.OnCompleted.Unbind();
+			SchedulerStats.TotalAbandoned++;
+		}
+	}
+
+	SchedulerStats.TotalCancelled += NumCancelled;
+	SchedulerStats.EstimatedSavedMs += NumCancelled * GetGenerationTimePercentile(0.5f) * 1000.f;
+	SchedulerStats.QueueDepth = QueuedUpdates.Num();
+	return NumCancelled;
+}
+
+void UMutableExtensionSubsystem::SubmitRuntimeUpdate(UMutableExtensionComponent* ExtensionComponent,
+	USkeletalMeshComponent* OwningComponent, UCustomizableSkeletalComponent* MutableComponent, bool bIgnoreCloseDist,
+	bool bForceHighPriority)
+{
+	FMutableThreadedRequest Request;
+	Request.ExtensionComponent = ExtensionComponent;
+	Request.OwningComponent = OwningComponent;
+	Request.MutableComponent = MutableComponent;
+	Request.bIgnoreCloseDist = bIgnoreCloseDist;
+	Request.bForceHighPriority = bForceHighPriority;
+	Request.SubmitTime = FPlatformTime::Seconds();
+	ThreadedRequests.Enqueue(MoveTemp(Request));
+}
+
+void UMutableExtensionSubsystem::SubmitInitialization(UMutableExtensionComponent* ExtensionComponent,
+	const TArray<UCustomizableSkeletalComponent*>& MutableComponents, const FOnMutableExtensionSimpleDelegate& OnInitialized)
+{
+	FMutableThreadedRequest Request;
+	Request.ExtensionComponent = ExtensionComponent;
+	Request.InitializingComponents.Reserve(MutableComponents.Num());
+	for (UCustomizableSkeletalComponent* MutableComponent : MutableComponents)
+	{
+		Request.InitializingComponents.Add(MutableComponent);
+	}
+	Request.OnInitialized = OnInitialized;
+	Request.bInitialization = true;
+	Request.SubmitTime = FPlatformTime::Seconds();
+	ThreadedRequests.Enqueue(MoveTemp(Request));
+}
+
+void UMutableExtensionSubsystem::DrainThreadedRequests()
+{
+	SchedulerStats.LastFrameThreadedRequests = 0;
+	if (ThreadedRequests.IsEmpty())
+	{
+		return;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::DrainThreadedRequests);
+
+	const double Now = FPlatformTime::Seconds();
+	TArray<UCustomizableSkeletalComponent*> InitializingComponents;
+	while (TOptional<FMutableThreadedRequest> Request = ThreadedRequests.Dequeue())
+	{
+		const double Latency = Now - Request->SubmitTime;
+		SchedulerStats.TotalThreadedRequests++;
+		SchedulerStats.LastFrameThreadedRequests++;
+		SchedulerStats.TotalThreadedLatency += Latency;
+		SchedulerStats.AverageThreadedLatency = SchedulerStats.TotalThreadedLatency / SchedulerStats.TotalThreadedRequests;
+		SchedulerStats.MaxThreadedLatency = FMath::Max<float>(SchedulerStats.MaxThreadedLatency, Latency);
+
+		// Destroyed since it was submitted, nobody is waiting on this
+		UMutableExtensionComponent* ExtensionComponent = Request->ExtensionComponent.Get();
+		if (!ExtensionComponent)
+		{
+			continue;
+		}
+
+		if (Request->bInitialization)
+		{
+			InitializingComponents.Reset();
+			for (const TWeakObjectPtr<UCustomizableSkeletalComponent>& MutableComponent : Request->InitializingComponents)
+			{
+				if (MutableComponent.IsValid())
+				{
+					InitializingComponents.Add(MutableComponent.Get());
+				}
+			}
+
+			FOnMutableExtensionSimpleDelegate& OnMutableInitialized = ExtensionComponent->RequestMutableInitialization(InitializingComponents);
+			if (Request->OnInitialized.IsBound())
+			{
+				OnMutableInitialized = Request->OnInitialized;
+			}
+			continue;
+		}
+
+		EMutableExtensionRuntimeUpdateError Error;
+		if (!ExtensionComponent->RuntimeUpdateMutableComponent(Request->OwningComponent.Get(), Request->MutableComponent.Get(),
+			Error, Request->bIgnoreCloseDist, Request->bForceHighPriority))
+		{
+			UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] { %s } failed to submit threaded runtime update: %s"),
+				*FString(__FUNCTION__), *GetNameSafe(ExtensionComponent->GetOwner()),
+				*UMutableFunctionLib::ParseRuntimeUpdateError(Error, true));
+		}
+	}
+}
+
+void UMutableExtensionSubsystem::EnqueueMeshSwap(UMutableExtensionComponent* ExtensionComponent,
+	const TArray<UMaterialInterface*>& NewMaterials)
+{
+	ComponentsPendingMeshSwap.AddUnique(ExtensionComponent);
+	UMutableFunctionLib::PrestreamMaterialTextures(NewMaterials, MutableExtensionCVars::MeshSwapPrestreamSeconds);
+}
+
+void UMutableExtensionSubsystem::ApplyMeshSwaps()
+{
+	SchedulerStats.LastFrameMeshSwaps = 0;
+	if (ComponentsPendingMeshSwap.Num() == 0)
+	{
+		return;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::ApplyMeshSwaps);
+
+	const int32 MaxSwaps = MutableExtensionCVars::MaxMeshSwapsPerFrame > 0 ? MutableExtensionCVars::MaxMeshSwapsPerFrame : MAX_int32;
+	for (int32 i = 0; i < ComponentsPendingMeshSwap.Num() && SchedulerStats.LastFrameMeshSwaps < MaxSwaps;)
+	{
+		UMutableExtensionComponent* ExtensionComponent = ComponentsPendingMeshSwap[i].Get();
+		if (ExtensionComponent)
+		{
+			SchedulerStats.LastFrameMeshSwaps += ExtensionComponent->ApplyReadyMeshSwaps(
+				MaxSwaps - SchedulerStats.LastFrameMeshSwaps, MutableExtensionCVars::MaxMeshSwapWait);
+		}
+
+		if (!ExtensionComponent || !ExtensionComponent->HasPendingMeshSwaps())
+		{
+			ComponentsPendingMeshSwap.RemoveAt(i, 1, EAllowShrinking::No);
+			continue;
+		}
+		++i;
+	}
+	SchedulerStats.TotalMeshSwaps += SchedulerStats.LastFrameMeshSwaps;
+}
+
+float UMutableExtensionSubsystem::GetGenerationTimePercentile(float Percentile) const
+{
+	if (RecentGenerationTimes.Num() == 0)
+	{
+		return 0.f;
+	}
+
+	TArray<float, TInlineAllocator<NumRecentGenerationTimes>> Sorted(RecentGenerationTimes);
+	Sorted.Sort();
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+	return Sorted[Index];
+}
+
+void UMutableExtensionSubsystem::CheckInFlightTimeouts()
+{
+	const float Timeout = MutableExtensionCVars::UpdateTimeout;
+	if (Timeout <= 0.f || InFlightUpdates.Num() == 0)
+	{
+		return;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::CheckInFlightTimeouts);
+
+	// Completion can re-enter the scheduler, so pull them all out first
+	TArray<FMutableScheduledUpdate, TInlineAllocator<8>> StalledUpdates;
+	const double Now = FPlatformTime::Seconds();
+	for (int32 i = InFlightUpdates.Num() - 1; i >= 0; --i)
+	{
+		if (Now - InFlightUpdates[i].DispatchTime >= Timeout)
+		{
+			StalledUpdates.Add(MoveTemp(InFlightUpdates[i]));
+			InFlightUpdates.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		}
+	}
+	SchedulerStats.NumInFlight = InFlightUpdates.Num();
+
+	for (FMutableScheduledUpdate& Update : StalledUpdates)
+	{
+		// Nobody is waiting on it
+		if (Update.bAbandoned)
+		{
+			CompleteUpdate(Update);
+			continue;
+		}
+
+		SchedulerStats.TotalStalled++;
+
+		UCustomizableObjectInstance* Instance = Update.MutableInstance.Get();
+		UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] { %s } did not complete within %.1fs (attempt %d of %d)"),
+			*FString(__FUNCTION__), *GetNameSafe(Instance), Timeout, Update.Attempt + 1, MutableExtensionCVars::MaxAttempts);
+
+		if (RetryUpdate(Update))
+		{
+			continue;
+		}
+
+		SchedulerStats.TotalTimedOut++;
+		Update.bTimedOut = true;
+		Update.UpdateResult = EUpdateResult::Error;
+		CompleteUpdate(Update);
+
+		if (Instance)
+		{
+			OnInstanceTimedOut.Broadcast(Instance);
+		}
+	}
+}
+
+bool UMutableExtensionSubsystem::RetryUpdate(FMutableScheduledUpdate& Update)
+{
+	if (Update.Attempt + 1 >= MutableExtensionCVars::MaxAttempts || !Update.MutableInstance.IsValid())
+	{
+		return false;
+	}
+
+	// Keep the original EnqueueTime so the retry has already aged and isn't starved, its own wait starts now
+	Update.RequeueTime = FPlatformTime::Seconds();
+	Update.RetryTime = Update.RequeueTime + MutableExtensionCVars::RetryBackoff * FMath::Pow(2.f, Update.Attempt);
+	Update.Attempt++;
+	QueuedUpdates.Add(MoveTemp(Update));
+
+	SchedulerStats.TotalRetried++;
+	SchedulerStats.QueueDepth = QueuedUpdates.Num();
+	return true;
+}
+
+void UMutableExtensionSubsystem::PrioritizeQueuedUpdates()
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::PrioritizeQueuedUpdates);
+
+	SchedulerStats.NumDeferredOffScreen = 0;
+	if (QueuedUpdates.Num() == 0)
+	{
+		return;
+	}
+
+	UMutableFunctionLib::GatherLocalViewPoints(GetWorld(), ViewPoints);
+
+	const double Now = FPlatformTime::Seconds();
+	for (FMutableScheduledUpdate& Update : QueuedUpdates)
+	{
+		bool bOffScreen;
+		const UCustomizableSkeletalComponent* MutableComponent = Update.MutableComponent.Get();
+		Update.Priority = UMutableFunctionLib::GetUpdateSignificance(MutableComponent, ViewPoints, bOffScreen);
+
+		if (Update.bBackground)
+		{
+			Update.Priority *= MutableExtensionCVars::BackgroundPriorityScale;
+		}
+		else if (MutableComponent && UMutableFunctionLib::IsActorLocallyControlled(MutableComponent->GetOwner()))
+		{
+			// Locally controlled actors are also prioritized within Mutable itself
+			Update.bForceHighPriority = true;
+		}
+
+		const float WaitTime = Now - Update.EnqueueTime;
+		Update.Priority += WaitTime * MutableExtensionCVars::PriorityPerSecondWaited;
+
+		if (bOffScreen && MutableExtensionCVars::bDeferOffScreen && !Update.bForceHighPriority)
+		{
+			if (MutableExtensionCVars::MaxOffScreenDeferral <= 0.f || WaitTime < MutableExtensionCVars::MaxOffScreenDeferral)
+			{
+				Update.Priority = -1.f;
+				SchedulerStats.NumDeferredOffScreen++;
+			}
+		}
+	}
+
+	// Stable so equal priorities remain first come first served
+	Algo::StableSortBy(QueuedUpdates, [](const FMutableScheduledUpdate& Update) { return Update.Priority; }, TGreater<>());
+}
+
+void UMutableExtensionSubsystem::DispatchQueuedUpdates()
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::DispatchQueuedUpdates);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double MaxDispatchSeconds = MutableExtensionCVars::MaxDispatchMs / 1000.0;
+	const int32 MaxInFlight = MutableExtensionCVars::MaxInFlightUpdates;
+
+	int32 NumDispatched = 0;
+	for (int32 i = 0; i < QueuedUpdates.Num();)
+	{
+		if (MaxInFlight > 0 && InFlightUpdates.Num() >= MaxInFlight)
+		{
+			break;
+		}
+
+		// Always dispatch at least one per tick so a tiny budget can't stall the queue
+		if (MaxDispatchSeconds > 0.0 && NumDispatched > 0 && FPlatformTime::Seconds() - StartTime >= MaxDispatchSeconds)
+		{
+			break;
+		}
+
+		// Deferred updates are sorted to the back of the queue
+		if (QueuedUpdates[i].Priority < 0.f)
+		{
+			break;
+		}
+
+		// An instance can only be updated once at a time, it will be dispatched after the current update completes
+		if (QueuedUpdates[i].RetryTime > StartTime || IsInFlight(QueuedUpdates[i].MutableInstance.Get()))
+		{
+			++i;
+			continue;
+		}
+
+		FMutableScheduledUpdate Update = MoveTemp(QueuedUpdates[i]);
+		QueuedUpdates.RemoveAt(i, 1, EAllowShrinking::No);
+
+		DispatchUpdate(Update);
+		NumDispatched++;
+	}
+
+	SchedulerStats.QueueDepth = QueuedUpdates.Num();
+	SchedulerStats.NumInFlight = InFlightUpdates.Num();
+	SchedulerStats.LastFrameDispatched = NumDispatched;
+	SchedulerStats.LastFrameDispatchMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	MUTABLE_EXTENSION_TRACE(RecordQueue, SchedulerStats.QueueDepth, SchedulerStats.NumInFlight);
+}
+
+void UMutableExtensionSubsystem::DispatchUpdate(FMutableScheduledUpdate& Update)
+{
+	Update.DispatchTime = FPlatformTime::Seconds();
+	SchedulerStats.TotalDispatched++;
+
+	if (Update.Attempt > 0)
+	{
+		const double WaitTime = Update.DispatchTime - Update.RequeueTime;
+		SchedulerStats.TotalRetriesDispatched++;
+		SchedulerStats.TotalRetryWaitTime += WaitTime;
+		SchedulerStats.AverageRetryWaitTime = SchedulerStats.TotalRetryWaitTime / SchedulerStats.TotalRetriesDispatched;
+		SchedulerStats.MaxRetryWaitTime = FMath::Max<float>(SchedulerStats.MaxRetryWaitTime, WaitTime);
+	}
+	else
+	{
+		const double WaitTime = Update.DispatchTime - Update.EnqueueTime;
+		SchedulerStats.TotalWaitTime += WaitTime;
+		SchedulerStats.AverageWaitTime = SchedulerStats.TotalWaitTime / (SchedulerStats.TotalDispatched - SchedulerStats.TotalRetriesDispatched);
+		SchedulerStats.MaxWaitTime = FMath::Max<float>(SchedulerStats.MaxWaitTime, WaitTime);
+		MUTABLE_EXTENSION_TRACE(RecordWait, WaitTime);
+	}
+
+	UCustomizableObjectInstance* Instance = Update.MutableInstance.Get();
+	UCustomizableSkeletalComponent* MutableComponent = Update.MutableComponent.Get();
+
+	// Owner was destroyed while queued, the requester still has the update pending so it has to be told
+	// Validity may also have changed while queued, updates by instance don't go through the component
+	if (!Instance || (!Update.bByInstance && (!MutableComponent ||
+		MutableComponent->CustomizableObjectInstance != Instance ||
+		!UMutableFunctionLib::IsMutableMeshValidToUpdate(MutableComponent))))
+	{
+		Update.UpdateResult = EUpdateResult::Error;
+		CompleteUpdate(Update);
+		return;
+	}
+
+	// Parameters may still change after this point, remember what was actually generated
+	Update.DescriptorHash = GetDescriptorHash(Instance);
+
+	// Zero is never used, so a default constructed update can't match
+	if (++LastDispatchId == 0)
+	{
+		++LastDispatchId;
+	}
+	Update.DispatchId = LastDispatchId;
+
+	// Mutable will often complete on the game thread before UpdateSkeletalMeshAsyncResult() returns
+	InFlightUpdates.Add(Update);
+
+	const FInstanceUpdateNativeDelegate Delegate = FInstanceUpdateNativeDelegate::CreateUObject(this,
+		&ThisClass::OnScheduledUpdateCompleted, Update.DispatchId);
+	if (Update.bByInstance)
+	{
+		Instance->UpdateSkeletalMeshAsyncResult(Delegate, Update.bIgnoreCloseDist, Update.bForceHighPriority);
+	}
+	else
+	{
+		UMutableFunctionLib::UpdateMutableMesh_Callback(MutableComponent, Delegate, Update.bIgnoreCloseDist, Update.bForceHighPriority);
+	}
+}
+
+void UMutableExtensionSubsystem::OnScheduledUpdateCompleted(const FUpdateContext& Result, uint32 DispatchId)
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::OnScheduledUpdateCompleted);
+
+	// Not by instance, the instance may have been dispatched again since this attempt stalled
+	const int32 Index = InFlightUpdates.IndexOfByPredicate([DispatchId](const FMutableScheduledUpdate& Update)
+	{
+		return Update.DispatchId == DispatchId;
+	});
+
+	if (Index == INDEX_NONE)
+	{
+		SchedulerStats.TotalLateCompletions++;
+		UE_LOG(LogMutableExtension, Verbose, TEXT("[ %s ] { %s } ignored completion of an attempt that was already retried or timed out"),
+			*FString(__FUNCTION__), *GetNameSafe(Result.Instance));
+		return;
+	}
+
+	FMutableScheduledUpdate Update = MoveTemp(InFlightUpdates[Index]);
+	InFlightUpdates.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	SchedulerStats.NumInFlight = InFlightUpdates.Num();
+
+	Update.UpdateResult = Result.UpdateResult;
+	const float GenerationTime = FPlatformTime::Seconds() - Update.DispatchTime;
+	MUTABLE_EXTENSION_TRACE(RecordGeneration, GenerationTime, Update.UpdateResult);
+	MUTABLE_EXTENSION_TRACE(RecordQueue, SchedulerStats.QueueDepth, SchedulerStats.NumInFlight);
+
+	SchedulerStats.MaxGenerationTime = FMath::Max(SchedulerStats.MaxGenerationTime, GenerationTime);
+	if (RecentGenerationTimes.Num() < NumRecentGenerationTimes)
+	{
+		RecentGenerationTimes.Add(GenerationTime);
+	}
+	else
+	{
+		RecentGenerationTimes[NextGenerationTimeIndex] = GenerationTime;
+		NextGenerationTimeIndex = (NextGenerationTimeIndex + 1) % NumRecentGenerationTimes;
+	}
+
+	// Mutable threw the update away, usually because something else updated the instance outside of the scheduler
+	const bool bDiscarded = Update.UpdateResult == EUpdateResult::ErrorDiscarded || Update.UpdateResult == EUpdateResult::ErrorReplaced;
+	if (bDiscarded && !Update.bAbandoned && MutableExtensionCVars::bRetryDiscarded && RetryUpdate(Update))
+	{
+		return;
+	}
+
+	CompleteUpdate(Update);
+}
+
+void UMutableExtensionSubsystem::CompleteUpdate(FMutableScheduledUpdate& Update)
+{
+	Update.CompleteTime = FPlatformTime::Seconds();
+	SchedulerStats.TotalCompleted++;
+
+	UpdateRegisteredInstance(Update.MutableInstance.Get());
+
+	UCustomizableObjectInstance* Instance = Update.MutableInstance.Get();
+	const UCustomizableSkeletalComponent* MutableComponent = Update.MutableComponent.Get();
+	const USkeletalMeshComponent* MeshComponent = MutableComponent ? UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(MutableComponent) : nullptr;
+	AccountInstanceMemory(Instance, MeshComponent);
+
+	// Whoever was generating a shared instance cancelled, so the cache has to be told instead
+	if (Update.bAbandoned && Update.bInitialization && Instance && IsCachedInstance(Instance))
+	{
+		OnCachedInstanceGenerated(Instance, UMutableFunctionLib::IsUpdateResultValid(Update.UpdateResult) && !Update.bTimedOut,
+			UMutableFunctionLib::GetGeneratedResourceSize(MeshComponent));
+	}
+
+	Update.OnCompleted.ExecuteIfBound(Update);
+}
+
+UCustomizableObjectInstance* UMutableExtensionSubsystem::AcquireCachedInstance(uint64 DescriptorHash, bool& bGenerated)
+{
+	bGenerated = false;
+
+	FMutableCachedInstance* Entry = CachedInstances.Find(DescriptorHash);
+	if (!Entry || !IsValid(Entry->Instance))
+	{
+		CacheStats.Misses++;
+		return nullptr;
+	}
+
+	CacheStats.Hits++;
+	Entry->RefCount++;
+	Entry->LastUsedTime = FPlatformTime::Seconds();
+	bGenerated = Entry->bGenerated;
+	return Entry->Instance;
+}
+
+void UMutableExtensionSubsystem::AddCachedInstance(uint64 DescriptorHash, UCustomizableObjectInstance* Instance,
+	const TArray<uint8>& Descriptor)
+{
+	if (!Instance || CachedInstances.Contains(DescriptorHash) || CachedInstanceHashes.Contains(Instance))
+	{
+		return;
+	}
+
+	FMutableCachedInstance& Entry = CachedInstances.Add(DescriptorHash);
+	Entry.Instance = Instance;
+	Entry.Descriptor = Descriptor;
+	Entry.RefCount = 1;
+	Entry.LastUsedTime = FPlatformTime::Seconds();
+	CachedInstanceHashes.Add(Instance, DescriptorHash);
+
+	CacheStats.NumEntries = CachedInstances.Num();
+}
+
+void UMutableExtensionSubsystem::OnCachedInstanceGenerated(UCustomizableObjectInstance* Instance, bool bSuccess,
+	int64 SizeBytes)
+{
+	const uint64* DescriptorHash = CachedInstanceHashes.Find(Instance);
+	if (!DescriptorHash)
+	{
+		return;
+	}
+
+	const uint64 Hash = *DescriptorHash;
+	const bool bPrewarm = PrewarmInFlight.Remove(Instance) > 0;
+
+	// Anyone already sharing it will see the failure on the instance itself, but nobody else should receive it
+	if (!bSuccess)
+	{
+		RemoveCachedInstance(Instance);
+	}
+	else
+	{
+		FMutableCachedInstance& Entry = CachedInstances.FindChecked(Hash);
+		Entry.bGenerated = true;
+		CacheStats.SizeBytes += SizeBytes - Entry.SizeBytes;
+		Entry.SizeBytes = SizeBytes;
+	}
+
+	if (bPrewarm)
+	{
+		CompletePrewarm(Instance, bSuccess);
+	}
+
+	if (bSuccess)
+	{
+		TrimCache();
+	}
+}
+
+void UMutableExtensionSubsystem::ReleaseCachedInstance(UCustomizableObjectInstance* Instance)
+{
+	const uint64* DescriptorHash = CachedInstanceHashes.Find(Instance);
+	if (!DescriptorHash)
+	{
+		return;
+	}
+
+	FMutableCachedInstance& Entry = CachedInstances.FindChecked(*DescriptorHash);
+	Entry.RefCount = FMath::Max(0, Entry.RefCount - 1);
+	Entry.LastUsedTime = FPlatformTime::Seconds();
+
+	// Nobody will ever finish generating it
+	if (Entry.RefCount == 0 && !Entry.bGenerated)
+	{
+		RemoveCachedInstance(Instance);
+		return;
+	}
+
+	TrimCache();
+}
+
+void UMutableExtensionSubsystem::RemoveCachedInstance(UCustomizableObjectInstance* Instance)
+{
+	uint64 DescriptorHash;
+	if (!CachedInstanceHashes.RemoveAndCopyValue(Instance, DescriptorHash))
+	{
+		return;
+	}
+
+	FMutableCachedInstance Entry;
+	if (CachedInstances.RemoveAndCopyValue(DescriptorHash, Entry))
+	{
+		CacheStats.SizeBytes -= Entry.SizeBytes;
+	}
+	CacheStats.NumEntries = CachedInstances.Num();
+
+	// Failed, evicted or changed by its only user
+	ForgetPrewarmedDescriptor(Instance);
+}
+
+void UMutableExtensionSubsystem::RestoreCachedInstanceDescriptor(UCustomizableObjectInstance* Instance)
+{
+	const uint64* DescriptorHash = CachedInstanceHashes.Find(Instance);
+	if (!DescriptorHash)
+	{
+		return;
+	}
+
+	const FMutableCachedInstance& Entry = CachedInstances.FindChecked(*DescriptorHash);
+	UMutableFunctionLib::LoadDescriptor(Instance, Entry.Descriptor);
+}
+
+int32 UMutableExtensionSubsystem::GetCachedInstanceRefCount(const UCustomizableObjectInstance* Instance) const
+{
+	const uint64* DescriptorHash = CachedInstanceHashes.Find(Instance);
+	return DescriptorHash ? CachedInstances.FindChecked(*DescriptorHash).RefCount : 0;
+}
+
+uint64 UMutableExtensionSubsystem::GetDescriptorHash(UCustomizableObjectInstance* Instance)
+{
+	uint64 Fingerprint;
+	if (!UMutableFunctionLib::GetDescriptorFingerprint(Instance, Fingerprint))
+	{
+		return UMutableFunctionLib::GetDescriptorHash(Instance);
+	}
+
+	FDescriptorHashEntry& Entry = DescriptorHashes.FindOrAdd(Instance);
+	if (Entry.Hash == 0 || Entry.Fingerprint != Fingerprint)
+	{
+		Entry.Fingerprint = Fingerprint;
+		Entry.Hash = UMutableFunctionLib::GetDescriptorHash(Instance);
+	}
+	return Entry.Hash;
+}
+
+void UMutableExtensionSubsystem::TrimCache()
+{
+	const int64 MaxSizeBytes = static_cast<int64>(MutableExtensionCVars::MaxCacheSizeMB) * 1024 * 1024;
+	while (CacheStats.SizeBytes > MaxSizeBytes)
+	{
+		UCustomizableObjectInstance* LeastRecentlyUsed = nullptr;
+		double OldestTime = TNumericLimits<double>::Max();
+		for (const TPair<uint64, FMutableCachedInstance>& Pair : CachedInstances)
+		{
+			const FMutableCachedInstance& Entry = Pair.Value;
+			if (Entry.RefCount == 0 && Entry.LastUsedTime < OldestTime)
+			{
+				LeastRecentlyUsed = Entry.Instance;
+				OldestTime = Entry.LastUsedTime;
+			}
+		}
+
+		// Everything remaining is in use
+		if (!LeastRecentlyUsed)
+		{
+			return;
+		}
+
+		RemoveCachedInstance(LeastRecentlyUsed);
+		CacheStats.Evictions++;
+	}
+}
+
+int32 UMutableExtensionSubsystem::PrewarmInstances(const TArray<FMutablePrewarmRequest>& Requests, int32 MaxParallel)
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::PrewarmInstances);
+
+	if (!IsPrewarming())
+	{
+		PrewarmProgress = FMutablePrewarmProgress();
+		PrewarmProgress.StartTime = FPlatformTime::Seconds();
+	}
+	MaxPrewarmParallel = FMath::Max(1, MaxParallel);
+
+	int32 NumAdded = 0;
+	TArray<uint8> Descriptor;
+	for (const FMutablePrewarmRequest& Request : Requests)
+	{
+		if (!Request.CustomizableObject)
+		{
+			continue;
+		}
+
+		UCustomizableObjectInstance* Instance = NewObject<UCustomizableObjectInstance>(this);
+		Instance->SetObject(Request.CustomizableObject);
+		if (Request.Descriptor.Num() > 0)
+		{
+			UMutableFunctionLib::LoadDescriptor(Instance, Request.Descriptor);
+		}
+
+		// Hashed the same as RequestMutableInitialization() does, so that matching instances find it
+		Descriptor.Reset();
+		UMutableFunctionLib::SaveDescriptor(Instance, Descriptor);
+		const uint64 DescriptorHash = UMutableFunctionLib::GetDescriptorHash(Instance, Descriptor);
+		if (CachedInstances.Contains(DescriptorHash))
+		{
+			continue;
+		}
+
+		AddCachedInstance(DescriptorHash, Instance, Descriptor);
+		PrewarmedHashes.Add(DescriptorHash);
+		PrewarmDescriptorHashes.Add(Instance, DescriptorHash);
+		PrewarmedInstances.Add(Instance);
+		PrewarmQueue.Add(Instance);
+		NumAdded++;
+	}
+
+	PrewarmProgress.NumRequested += NumAdded;
+	PrewarmProgress.Progress = PrewarmProgress.NumRequested > 0 ?
+		static_cast<float>(PrewarmProgress.NumCompleted) / PrewarmProgress.NumRequested : 1.f;
+
+	DispatchPrewarm();
+	return NumAdded;
+}
+
+void UMutableExtensionSubsystem::ReleasePrewarmedInstances()
+{
+	// Never dispatched, so they can't be complete
+	PrewarmProgress.NumRequested -= PrewarmQueue.Num();
+	PrewarmQueue.Reset();
+
+	for (UCustomizableObjectInstance* Instance : PrewarmedInstances)
+	{
+		if (PrewarmInFlight.Contains(Instance))
+		{
+			PrewarmReleasePending.Add(Instance);
+		}
+		else
+		{
+			ReleaseCachedInstance(Instance);
+		}
+	}
+	PrewarmedInstances.Reset();
+	PrewarmedHashes.Reset();
+	PrewarmDescriptorHashes.Reset();
+}
+
+void UMutableExtensionSubsystem::DispatchPrewarm()
+{
+	while (PrewarmInFlight.Num() < MaxPrewarmParallel && PrewarmQueue.Num() > 0)
+	{
+		UCustomizableObjectInstance* Instance = PrewarmQueue[0];
+		PrewarmQueue.RemoveAt(0, 1, EAllowShrinking::No);
+
+		// No component to score significance with, so it competes with everything else by wait time alone
+		PrewarmInFlight.Add(Instance);
+		EnqueueInitialization(Instance, nullptr,
+			FOnMutableScheduledUpdateCompleted::CreateUObject(this, &ThisClass::OnPrewarmUpdateCompleted));
+	}
+}
+
+void UMutableExtensionSubsystem::OnPrewarmUpdateCompleted(const FMutableScheduledUpdate& Update)
+{
+	UCustomizableObjectInstance* Instance = Update.MutableInstance.Get();
+	const bool bSuccess = UMutableFunctionLib::IsUpdateResultValid(Update.UpdateResult) && !Update.bTimedOut;
+	OnCachedInstanceGenerated(Instance, bSuccess, bSuccess ? UMutableFunctionLib::GetGeneratedResourceSize(Instance) : 0);
+
+	// Removed from the cache while generating, e.g. its only user changed it, but it still counts towards progress
+	if (PrewarmInFlight.Remove(Instance))
+	{
+		CompletePrewarm(Instance, bSuccess);
+	}
+}
+
+void UMutableExtensionSubsystem::CompletePrewarm(UCustomizableObjectInstance* Instance, bool bSuccess)
+{
+	if (!bSuccess)
+	{
+		UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] { %s } failed to prewarm %s"),
+			*FString(__FUNCTION__), *GetNameSafe(Instance), *GetNameSafe(Instance ? Instance->GetCustomizableObject() : nullptr));
+
+		ForgetPrewarmedDescriptor(Instance);
+		PrewarmedInstances.Remove(Instance);
+		PrewarmReleasePending.Remove(Instance);
+	}
+	else if (PrewarmReleasePending.Remove(Instance))
+	{
+		ReleaseCachedInstance(Instance);
+	}
+
+	PrewarmProgress.NumCompleted++;
+	PrewarmProgress.NumFailed += bSuccess ? 0 : 1;
+	PrewarmProgress.Progress = static_cast<float>(PrewarmProgress.NumCompleted) / FMath::Max(1, PrewarmProgress.NumRequested);
+	PrewarmProgress.ElapsedTime = FPlatformTime::Seconds() - PrewarmProgress.StartTime;
+
+	DispatchPrewarm();
+	OnPrewarmProgress.Broadcast(PrewarmProgress);
+}
+
+void UMutableExtensionSubsystem::ForgetPrewarmedDescriptor(const UCustomizableObjectInstance* Instance)
+{
+	uint64 DescriptorHash;
+	if (PrewarmDescriptorHashes.RemoveAndCopyValue(Instance, DescriptorHash))
+	{
+		PrewarmedHashes.Remove(DescriptorHash);
+	}
+}
+
+int32 UMutableExtensionSubsystem::AddSpeculativeCandidates(UCustomizableObjectInstance* Instance,
+	const TArray<TArray<uint8>>& Descriptors)
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::AddSpeculativeCandidates);
+
+	if (!IsValid(Instance) || !Instance->GetCustomizableObject())
+	{
+		return 0;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const uint64 CurrentHash = GetDescriptorHash(Instance);
+
+	int32 NumAdded = 0;
+	TArray<uint8> Descriptor;
+	for (const TArray<uint8>& CandidateDescriptor : Descriptors)
+	{
+		// Hashed after loading, the same as the instance will be once gameplay applies the same change
+		UCustomizableObjectInstance* Candidate = Instance->Clone();
+		UMutableFunctionLib::LoadDescriptor(Candidate, CandidateDescriptor);
+		Descriptor.Reset();
+		UMutableFunctionLib::SaveDescriptor(Candidate, Descriptor);
+		const uint64 DescriptorHash = UMutableFunctionLib::GetDescriptorHash(Candidate, Descriptor);
+		if (DescriptorHash == CurrentHash || FindSpeculativeCandidate(Instance, DescriptorHash) != INDEX_NONE)
+		{
+			continue;
+		}
+
+		FMutableSpeculativeCandidate& Entry = SpeculativeCandidates.AddDefaulted_GetRef();
+		Entry.Instance = Candidate;
+		Entry.SourceInstance = Instance;
+		Entry.DescriptorHash = DescriptorHash;
+		Entry.RegisterTime = Now;
+		NumAdded++;
+	}
+
+	SpeculationStats.TotalRegistered += NumAdded;
+	SpeculationStats.NumCandidates = SpeculativeCandidates.Num();
+	return NumAdded;
+}
+
+void UMutableExtensionSubsystem::ClearSpeculativeCandidates(const UCustomizableObjectInstance* Instance)
+{
+	for (int32 Index = SpeculativeCandidates.Num() - 1; Index >= 0; Index--)
+	{
+		if (SpeculativeCandidates[Index].SourceInstance.Get() == Instance)
+		{
+			RemoveSpeculativeCandidate(Index, false);
+		}
+	}
+}
+
+bool UMutableExtensionSubsystem::HasSpeculativeCandidates(const UCustomizableObjectInstance* Instance) const
+{
+	return Instance && SpeculativeCandidates.ContainsByPredicate([Instance](const FMutableSpeculativeCandidate& Entry)
+	{
+		return Entry.SourceInstance.Get() == Instance;
+	});
+}
+
+UCustomizableObjectInstance* UMutableExtensionSubsystem::TakeSpeculativeInstance(
+	const UCustomizableObjectInstance* Instance, uint64 DescriptorHash)
+{
+	const int32 Index = FindSpeculativeCandidate(Instance, DescriptorHash);
+	UCustomizableObjectInstance* Speculative = nullptr;
+	if (Index != INDEX_NONE && SpeculativeCandidates[Index].bGenerated)
+	{
+		Speculative = SpeculativeCandidates[Index].Instance;
+		SpeculationStats.SizeBytes -= SpeculativeCandidates[Index].SizeBytes;
+		SpeculativeCandidates.RemoveAtSwap(Index);
+		SpeculationStats.Hits++;
+
+		// Still likely next states of whatever replaces the instance, e.g. the other items in the same menu
+		for (FMutableSpeculativeCandidate& Entry : SpeculativeCandidates)
+		{
+			if (Entry.SourceInstance.Get() == Instance)
+			{
+				Entry.SourceInstance = Speculative;
+			}
+		}
+	}
+	else
+	{
+		// Guessed right but too late, the caller generates it now so the candidate is redundant
+		if (Index != INDEX_NONE)
+		{
+			RemoveSpeculativeCandidate(Index, false);
+		}
+		SpeculationStats.Misses++;
+	}
+
+	SpeculationStats.HitRate = static_cast<float>(SpeculationStats.Hits) / (SpeculationStats.Hits + SpeculationStats.Misses);
+	SpeculationStats.NumCandidates = SpeculativeCandidates.Num();
+	SpeculationStats.NumReady -= Speculative ? 1 : 0;
+	return Speculative;
+}
+
+int32 UMutableExtensionSubsystem::FindSpeculativeCandidate(const UCustomizableObjectInstance* Instance,
+	uint64 DescriptorHash) const
+{
+	return SpeculativeCandidates.IndexOfByPredicate([Instance, DescriptorHash](const FMutableSpeculativeCandidate& Entry)
+	{
+		return Entry.DescriptorHash == DescriptorHash && Entry.SourceInstance.Get() == Instance;
+	});
+}
+
+void UMutableExtensionSubsystem::RemoveSpeculativeCandidate(int32 Index, bool bEvicted)
+{
+	const FMutableSpeculativeCandidate& Entry = SpeculativeCandidates[Index];
+	if (Entry.bGenerated)
+	{
+		SpeculationStats.NumReady--;
+		SpeculationStats.SizeBytes -= Entry.SizeBytes;
+		SpeculationStats.TotalWasted++;
+		SpeculationStats.WastedGenerationMs += Entry.GenerationTime * 1000.f;
+		SpeculationStats.TotalEvicted += bEvicted ? 1 : 0;
+	}
+	else if (Entry.Instance == SpeculativeInFlight.Get())
+	{
+		CancelUpdates(Entry.Instance);
+		SpeculativeInFlight = nullptr;
+	}
+
+	SpeculativeCandidates.RemoveAtSwap(Index);
+	SpeculationStats.NumCandidates = SpeculativeCandidates.Num();
+}
+
+void UMutableExtensionSubsystem::DispatchSpeculation()
+{
+	// Idle priority, only one at a time and never while anything else waits for a slot
+	const int32 MaxInFlight = MutableExtensionCVars::MaxInFlightUpdates;
+	if (SpeculativeInFlight.IsValid() || SpeculativeCandidates.Num() == 0 || MutableExtensionCVars::MaxSpeculationMB <= 0 ||
+		QueuedUpdates.Num() > 0 || (MaxInFlight > 0 && InFlightUpdates.Num() >= MaxInFlight))
+	{
+		return;
+	}
+
+	// The instance they would replace is gone
+	for (int32 Index = SpeculativeCandidates.Num() - 1; Index >= 0; Index--)
+	{
+		if (!SpeculativeCandidates[Index].SourceInstance.IsValid())
+		{
+			RemoveSpeculativeCandidate(Index, false);
+		}
+	}
+
+	int32 OldestIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < SpeculativeCandidates.Num(); Index++)
+	{
+		const FMutableSpeculativeCandidate& Entry = SpeculativeCandidates[Index];
+		if (!Entry.bGenerated && (OldestIndex == INDEX_NONE || Entry.RegisterTime < SpeculativeCandidates[OldestIndex].RegisterTime))
+		{
+			OldestIndex = Index;
+		}
+	}
+
+	if (OldestIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	SpeculativeInFlight = SpeculativeCandidates[OldestIndex].Instance;
+	EnqueueRefinement(SpeculativeCandidates[OldestIndex].Instance, nullptr,
+		FOnMutableScheduledUpdateCompleted::CreateUObject(this, &ThisClass::OnSpeculativeUpdateCompleted));
+}
+
+void UMutableExtensionSubsystem::OnSpeculativeUpdateCompleted(const FMutableScheduledUpdate& Update)
+{
+	UCustomizableObjectInstance* Instance = Update.MutableInstance.Get();
+	if (SpeculativeInFlight.Get() == Instance)
+	{
+		SpeculativeInFlight = nullptr;
+	}
+
+	// Cleared or committed elsewhere while generating
+	const int32 Index = SpeculativeCandidates.IndexOfByPredicate([Instance](const FMutableSpeculativeCandidate& Entry)
+	{
+		return Entry.Instance == Instance;
+	});
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (!UMutableFunctionLib::IsUpdateResultValid(Update.UpdateResult) || Update.bTimedOut)
+	{
+		UE_LOG(LogMutableExtension, Verbose, TEXT("[ %s ] { %s } failed to generate speculative candidate: %s"),
+			*FString(__FUNCTION__), *GetNameSafe(SpeculativeCandidates[Index].SourceInstance.Get()),
+			*UMutableFunctionLib::GetUpdateResultAsString(Update.UpdateResult));
+		RemoveSpeculativeCandidate(Index, false);
+		return;
+	}
+
+	FMutableSpeculativeCandidate& Entry = SpeculativeCandidates[Index];
+	Entry.bGenerated = true;
+	Entry.GenerationTime = static_cast<float>(Update.CompleteTime - Update.DispatchTime);
+	Entry.SizeBytes = UMutableFunctionLib::GetGeneratedResourceSize(Instance);
+
+	SpeculationStats.TotalGenerated++;
+	SpeculationStats.NumReady++;
+	SpeculationStats.SizeBytes += Entry.SizeBytes;
+
+	TrimSpeculation(static_cast<int64>(MutableExtensionCVars::MaxSpeculationMB) * 1024 * 1024);
+}
+
+void UMutableExtensionSubsystem::TrimSpeculation(int64 MaxBytes)
+{
+	while (SpeculationStats.SizeBytes > MaxBytes)
+	{
+		int32 OldestIndex = INDEX_NONE;
+		for (int32 Index = 0; Index < SpeculativeCandidates.Num(); Index++)
+		{
+			const FMutableSpeculativeCandidate& Entry = SpeculativeCandidates[Index];
+			if (Entry.bGenerated && (OldestIndex == INDEX_NONE || Entry.RegisterTime < SpeculativeCandidates[OldestIndex].RegisterTime))
+			{
+				OldestIndex = Index;
+			}
+		}
+
+		if (OldestIndex == INDEX_NONE)
+		{
+			return;
+		}
+
+		UE_LOG(LogMutableExtension, Verbose, TEXT("[ %s ] { %s } evicting speculative candidate, %.2fMB"),
+			*FString(__FUNCTION__), *GetNameSafe(SpeculativeCandidates[OldestIndex].SourceInstance.Get()),
+			SpeculativeCandidates[OldestIndex].SizeBytes / (1024.f * 1024.f));
+		RemoveSpeculativeCandidate(OldestIndex, true);
+	}
+}
+
+bool UMutableExtensionSubsystem::ReadDiskCache(UCustomizableObjectInstance* Instance, uint64 DescriptorHash,
+	const FOnMutableDiskCacheRead& OnCompleted)
+{
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	if (!MutableExtensionCVars::bDiskCacheEnabled || !CustomizableObject)
+	{
+		return false;
+	}
+
+	FPendingDiskCacheRead& Pending = DiskCacheReads.AddDefaulted_GetRef();
+	Pending.Instance = Instance;
+	Pending.Read = MakeUnique<FMutableDiskCacheRead>(CustomizableObject, DescriptorHash);
+	Pending.OnCompleted = OnCompleted;
+	return true;
+}
+
+void UMutableExtensionSubsystem::WriteDiskCache(const UCustomizableObjectInstance* Instance, uint64 DescriptorHash)
+{
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	if (!MutableExtensionCVars::bDiskCacheEnabled || !CustomizableObject)
+	{
+		return;
+	}
+
+	// An entry from a previous run is only rewritten if reading it was rejected, in which case this run generated it
+	const FString Filename = FMutableExtensionDiskCache::GetEntryFilename(CustomizableObject, DescriptorHash);
+	bool bAlreadyWritten;
+	DiskCacheWrites.Add(Filename, &bAlreadyWritten);
+	if (bAlreadyWritten)
+	{
+		return;
+	}
+
+	TSharedPtr<FMutableDiskCacheWrite> Entry = FMutableExtensionDiskCache::PrepareWrite(Instance, DescriptorHash);
+	if (!Entry.IsValid())
+	{
+		return;
+	}
+
+	// The entry is only released by TickDiskCache, so its copied payload outlives the task
+	const int64 MaxBytes = static_cast<int64>(FMath::Max(0, MutableExtensionCVars::DiskCacheMaxMB)) * 1024 * 1024;
+	FPendingDiskCacheWrite& Pending = DiskCacheWriteTasks.AddDefaulted_GetRef();
+	Pending.Entry = Entry;
+	Pending.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Entry = Entry.Get(), MaxBytes]()
+	{
+		return FMutableExtensionDiskCache::Write(*Entry, MaxBytes);
+	});
+}
+
+void UMutableExtensionSubsystem::TickDiskCache()
+{
+	for (int32 Index = DiskCacheWriteTasks.Num() - 1; Index >= 0; Index--)
+	{
+		if (DiskCacheWriteTasks[Index].Task.IsCompleted())
+		{
+			const FMutableDiskCacheWriteResult& Result = DiskCacheWriteTasks[Index].Task.GetResult();
+			DiskCacheStats.Writes += Result.BytesWritten > 0 ? 1 : 0;
+			DiskCacheStats.BytesWritten += Result.BytesWritten;
+			DiskCacheStats.Evictions += Result.NumEvicted;
+			DiskCacheStats.EvictedBytes += Result.EvictedBytes;
+			DiskCacheWriteTasks.RemoveAtSwap(Index);
+		}
+	}
+
+	if (DiskCacheReads.Num() == 0)
+	{
+		return;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::TickDiskCache);
+
+	// Completion can start more reads
+	TArray<FPendingDiskCacheRead> CompletedReads;
+	for (int32 Index = DiskCacheReads.Num() - 1; Index >= 0; Index--)
+	{
+		if (DiskCacheReads[Index].Read->Tick())
+		{
+			CompletedReads.Add(MoveTemp(DiskCacheReads[Index]));
+			DiskCacheReads.RemoveAtSwap(Index);
+		}
+	}
+
+	for (const FPendingDiskCacheRead& Pending : CompletedReads)
+	{
+		UCustomizableObjectInstance* Instance = Pending.Instance.Get();
+		const EMutableDiskCacheRead Result = Pending.Read->GetResult();
+		DiskCacheStats.ReadTimeMs += Pending.Read->GetGameThreadTime() * 1000.0;
+
+		switch (Result)
+		{
+		case EMutableDiskCacheRead::Hit:
+			DiskCacheStats.Hits++;
+			DiskCacheStats.BytesRead += Pending.Read->GetBytesRead();
+			if (Instance)
+			{
+				DiskCachedInstances.Add(Instance);
+			}
+			break;
+		case EMutableDiskCacheRead::Missing:
+			DiskCacheStats.Misses++;
+			break;
+		default:
+			// Overwritten once this run generates it
+			UE_LOG(LogMutableExtension, Verbose, TEXT("[ %s ] { %s } rejected %s disk cache entry"),
+				*FString(__FUNCTION__), *GetNameSafe(Instance), Result == EMutableDiskCacheRead::Stale ? TEXT("stale") : TEXT("invalid"));
+			DiskCacheStats.Misses++;
+			DiskCacheStats.Rejected++;
+			break;
+		}
+
+		if (Instance)
+		{
+			Pending.OnCompleted.ExecuteIfBound(Result, Pending.Read->GetMeshes());
+		}
+	}
+}
+
+bool UMutableExtensionSubsystem::SaveWorldSnapshot(TArray<uint8>& OutData)
+{
+	if (!FMutableWorldSnapshot::Save(GetWorld(), OutData, SnapshotStats))
+	{
+		return false;
+	}
+
+	UE_LOG(LogMutableExtension, Log, TEXT("[ %s ] { %s } saved %d instances of %d actors in %d bytes (%d unique descriptors, %d unique parameters) in %.2fms"),
+		*FString(__FUNCTION__), *GetNameSafe(GetWorld()), SnapshotStats.NumInstances, SnapshotStats.NumActors,
+		SnapshotStats.SizeBytes, SnapshotStats.NumUniqueDescriptors, SnapshotStats.NumUniqueParameters, SnapshotStats.EncodeTimeMs);
+	return true;
+}
+
+bool UMutableExtensionSubsystem::RestoreWorldSnapshot(const TArray<uint8>& Data)
+{
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::RestoreWorldSnapshot);
+
+	TMap<UMutableExtensionComponent*, TArray<UCustomizableSkeletalComponent*>> Restored;
+	if (!FMutableWorldSnapshot::Apply(GetWorld(), Data, Restored, SnapshotStats))
+	{
+		UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] { %s } data is not a world snapshot of format version %u"),
+			*FString(__FUNCTION__), *GetNameSafe(GetWorld()), FMutableWorldSnapshot::FormatVersion);
+		return false;
+	}
+
+	struct FRestore
+	{
+		UMutableExtensionComponent* ExtensionComponent;
+		TArray<UCustomizableSkeletalComponent*> MutableComponents;
+		float Significance;
+		bool bOffScreen;
+	};
+
+	TArray<FMutableViewPoint> RestoreViewPoints;
+	UMutableFunctionLib::GatherLocalViewPoints(GetWorld(), RestoreViewPoints);
+
+	TArray<FRestore> Restores;
+	Restores.Reserve(Restored.Num());
+	for (TPair<UMutableExtensionComponent*, TArray<UCustomizableSkeletalComponent*>>& Pair : Restored)
+	{
+		// Keep every component an actor already initialized, not just those in the snapshot
+		FRestore& Restore = Restores.Add_GetRef({ Pair.Key, Pair.Key->GetMutableInitializingComponents(), 0.f, true });
+		if (Restore.MutableComponents.Num() == 0)
+		{
+			Restore.MutableComponents = MoveTemp(Pair.Value);
+		}
+
+		for (const UCustomizableSkeletalComponent* Component : Restore.MutableComponents)
+		{
+			bool bOffScreen;
+			Restore.Significance = FMath::Max(Restore.Significance,
+				UMutableFunctionLib::GetUpdateSignificance(Component, RestoreViewPoints, bOffScreen));
+			Restore.bOffScreen &= bOffScreen;
+		}
+	}
+
+	// Requested in this order, so the scheduler sees what the player is looking at first
+	Algo::Sort(Restores, [](const FRestore& A, const FRestore& B)
+	{
+		return A.bOffScreen != B.bOffScreen ? !A.bOffScreen : A.Significance > B.Significance;
+	});
+
+	SnapshotRestoringComponents.Reset(Restores.Num());
+	SnapshotRestoreTime = FPlatformTime::Seconds();
+	for (const FRestore& Restore : Restores)
+	{
+		Restore.ExtensionComponent->RequestMutableInitialization(Restore.MutableComponents);
+		SnapshotRestoringComponents.Add(Restore.ExtensionComponent);
+	}
+
+	UE_LOG(LogMutableExtension, Log, TEXT("[ %s ] { %s } restored %d of %d instances from %d bytes in %.2fms, initializing %d actors"),
+		*FString(__FUNCTION__), *GetNameSafe(GetWorld()), SnapshotStats.NumInstances - SnapshotStats.NumUnmatched,
+		SnapshotStats.NumInstances, SnapshotStats.SizeBytes, SnapshotStats.DecodeTimeMs, Restores.Num());
+
+	// Nothing matched, there is nothing to wait on
+	CheckSnapshotRestored();
+	return true;
+}
+
+void UMutableExtensionSubsystem::CheckSnapshotRestored()
+{
+	if (SnapshotRestoreTime <= 0.0)
+	{
+		return;
+	}
+
+	SnapshotRestoringComponents.RemoveAllSwap([](const TWeakObjectPtr<UMutableExtensionComponent>& Component)
+	{
+		return !Component.IsValid() || Component->HasMutableInitialized();
+	});
+
+	if (SnapshotRestoringComponents.Num() == 0)
+	{
+		SnapshotStats.RestoreToReadyTime = FPlatformTime::Seconds() - SnapshotRestoreTime;
+		SnapshotRestoreTime = 0.0;
+
+		UE_LOG(LogMutableExtension, Log, TEXT("[ %s ] { %s } world snapshot ready after %.2fs"),
+			*FString(__FUNCTION__), *GetNameSafe(GetWorld()), SnapshotStats.RestoreToReadyTime);
+		OnWorldSnapshotRestored.Broadcast(SnapshotStats);
+	}
+}
+
+void UMutableExtensionSubsystem::RegisterComponent(UCustomizableSkeletalComponent* MutableComponent)
+{
+	if (!MutableComponent)
+	{
+		return;
+	}
+
+	if (RegisteredIndices.Contains(MutableComponent))
+	{
+		UpdateRegisteredComponent(MutableComponent);
+		return;
+	}
+
+	bool bValidResult;
+	const ESkeletalMeshStatus Status = UMutableFunctionLib::GetMutableComponentStatus(MutableComponent, bValidResult);
+
+	RegisteredIndices.Add(MutableComponent, RegisteredComponents.Num());
+	RegisteredComponents.Add(MutableComponent);
+	RegisteredInstances.Add(MutableComponent->CustomizableObjectInstance);
+	RegisteredStatuses.Add(Status);
+	RegisteredStatusCounts[static_cast<int32>(Status)]++;
+}
+
+void UMutableExtensionSubsystem::UnregisterComponent(const UCustomizableSkeletalComponent* MutableComponent)
+{
+	int32 Index;
+	if (!RegisteredIndices.RemoveAndCopyValue(MutableComponent, Index))
+	{
+		return;
+	}
+
+	const TObjectKey<UCustomizableObjectInstance> Instance = RegisteredInstances[Index];
+	RegisteredStatusCounts[static_cast<int32>(RegisteredStatuses[Index])]--;
+	DescriptorHashes.Remove(Instance);
+
+	// Swap the last entry into the gap so the arrays stay dense
+	const int32 LastIndex = RegisteredComponents.Num() - 1;
+	if (Index != LastIndex)
+	{
+		RegisteredIndices.FindChecked(RegisteredComponents[LastIndex]) = Index;
+	}
+	RegisteredComponents.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	RegisteredInstances.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	RegisteredStatuses.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// The last of our components using it is gone
+	if (Instance != TObjectKey<UCustomizableObjectInstance>() && !RegisteredInstances.Contains(Instance))
+	{
+		RemoveInstanceMemory(Instance);
+		DiskCachedInstances.Remove(Instance);
+	}
+}
+
+void UMutableExtensionSubsystem::UpdateRegisteredComponent(const UCustomizableSkeletalComponent* MutableComponent)
+{
+	const int32* Index = RegisteredIndices.Find(MutableComponent);
+	if (!Index)
+	{
+		return;
+	}
+
+	bool bValidResult;
+	RegisteredInstances[*Index] = MutableComponent->CustomizableObjectInstance;
+	SetRegisteredStatus(*Index, UMutableFunctionLib::GetMutableComponentStatus(MutableComponent, bValidResult));
+}
+
+void UMutableExtensionSubsystem::UpdateRegisteredInstance(const UCustomizableObjectInstance* Instance)
+{
+	if (!Instance)
+	{
+		return;
+	}
+
+	bool bValidResult;
+	const ESkeletalMeshStatus Status = UMutableFunctionLib::GetMutableInstanceStatus(Instance, bValidResult);
+	const TObjectKey<UCustomizableObjectInstance> InstanceKey(Instance);
+	for (int32 Index = 0; Index < RegisteredInstances.Num(); Index++)
+	{
+		if (RegisteredInstances[Index] == InstanceKey)
+		{
+			SetRegisteredStatus(Index, Status);
+		}
+	}
+}
+
+bool UMutableExtensionSubsystem::GetRegisteredStatus(const UCustomizableSkeletalComponent* MutableComponent,
+	ESkeletalMeshStatus& OutStatus) const
+{
+	if (const int32* Index = RegisteredIndices.Find(MutableComponent))
+	{
+		OutStatus = RegisteredStatuses[*Index];
+		return true;
+	}
+	return false;
+}
+
+int32 UMutableExtensionSubsystem::GetNumRegisteredWithStatus(ESkeletalMeshStatus Status) const
+{
+	const int32 StatusIndex = static_cast<int32>(Status);
+	return StatusIndex < NumMeshStatuses ? RegisteredStatusCounts[StatusIndex] : 0;
+}
+
+void UMutableExtensionSubsystem::GetRegisteredComponentsWithStatus(ESkeletalMeshStatus Status,
+	TArray<UCustomizableSkeletalComponent*>& OutComponents) const
+{
+	OutComponents.Reset(GetNumRegisteredWithStatus(Status));
+	for (int32 Index = 0; Index < RegisteredStatuses.Num(); Index++)
+	{
+		if (RegisteredStatuses[Index] == Status)
+		{
+			if (UCustomizableSkeletalComponent* Component = RegisteredComponents[Index].ResolveObjectPtr())
+			{
+				OutComponents.Add(Component);
+			}
+		}
+	}
+}
+
+void UMutableExtensionSubsystem::SetRegisteredStatus(int32 Index, ESkeletalMeshStatus Status)
+{
+	ESkeletalMeshStatus& CurrentStatus = RegisteredStatuses[Index];
+	if (CurrentStatus != Status)
+	{
+		RegisteredStatusCounts[static_cast<int32>(CurrentStatus)]--;
+		RegisteredStatusCounts[static_cast<int32>(Status)]++;
+		CurrentStatus = Status;
+	}
+}
+
+bool UMutableExtensionSubsystem::IsInstanceReleased(const UCustomizableObjectInstance* Instance) const
+{
+	const FMutableInstanceMemory* Memory = InstanceMemory.Find(Instance);
+	return Memory && Memory->bReleased;
+}
+
+UCustomizableObjectInstance* UMutableExtensionSubsystem::ReleaseInstanceResources(UCustomizableObjectInstance* Instance)
+{
+	const FMutableInstanceMemory* Memory = InstanceMemory.Find(Instance);
+	if (!Memory || Memory->bReleased || !IsValid(Instance))
+	{
+		return nullptr;
+	}
+
+	// Shared instances are budgeted by the cache, anybody acquiring it expects it to be generated
+	if (IsCachedInstance(Instance) || IsQueued(Instance) || IsInFlight(Instance))
+	{
+		return nullptr;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::ReleaseInstanceResources);
+
+	const int64 SizeBytes = Memory->GetTotal();
+	UCustomizableObjectInstance* ReleasedInstance = Instance->Clone();
+
+	// Nothing may keep referencing the generated resources, but the skeleton remains for animation and physics
+	TArray<UCustomizableSkeletalComponent*, TInlineAllocator<4>> MutableComponents;
+	TArray<UMutableExtensionComponent*, TInlineAllocator<2>> ExtensionComponents;
+	const TObjectKey<UCustomizableObjectInstance> InstanceKey(Instance);
+	for (int32 Index = 0; Index < RegisteredInstances.Num(); Index++)
+	{
+		UCustomizableSkeletalComponent* MutableComponent = RegisteredInstances[Index] == InstanceKey ?
+			RegisteredComponents[Index].ResolveObjectPtr() : nullptr;
+		if (!MutableComponent)
+		{
+			continue;
+		}
+
+		if (USkeletalMeshComponent* MeshComponent = UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(MutableComponent))
+		{
+			MeshComponent->SetSkeletalMesh(UMutableFunctionLib::GetReferenceSkeletalMesh(MutableComponent), false);
+			MeshComponent->EmptyOverrideMaterials();
+		}
+
+		MutableComponents.Add(MutableComponent);
+		const AActor* Owner = MutableComponent->GetOwner();
+		if (UMutableExtensionComponent* ExtensionComponent = Owner ? Owner->FindComponentByClass<UMutableExtensionComponent>() : nullptr)
+		{
+			ExtensionComponents.AddUnique(ExtensionComponent);
+		}
+	}
+
+	// Accounted to the copy before anything asks whether it is released
+	InstanceMemory.Remove(Instance);
+	InstanceMemory.Add(ReleasedInstance).bReleased = true;
+	DescriptorHashes.Remove(Instance);
+
+	MemoryStats.UsedBytes -= SizeBytes;
+	MemoryStats.NumReleased++;
+	MemoryStats.TotalEvictions++;
+	MemoryStats.TotalEvictedBytes += SizeBytes;
+
+	for (UMutableExtensionComponent* ExtensionComponent : ExtensionComponents)
+	{
+		ExtensionComponent->ReleaseInstance(Instance, ReleasedInstance);
+	}
+
+	// Not initialized through an extension component
+	for (UCustomizableSkeletalComponent* MutableComponent : MutableComponents)
+	{
+		if (MutableComponent->CustomizableObjectInstance == Instance)
+		{
+			MutableComponent->SetCustomizableObjectInstance(ReleasedInstance);
+			UpdateRegisteredComponent(MutableComponent);
+		}
+	}
+
+	UE_LOG(LogMutableExtension, Verbose, TEXT("[ %s ] { %s } released %lld bytes"),
+		*FString(__FUNCTION__), *GetNameSafe(Instance), SizeBytes);
+
+	return ReleasedInstance;
+}
+
+bool UMutableExtensionSubsystem::RestoreInstanceResources(UCustomizableObjectInstance* Instance)
+{
+	if (!ClearInstanceReleased(Instance))
+	{
+		return false;
+	}
+
+	// Any of its components will do, they all share the instance
+	UCustomizableSkeletalComponent* MutableComponent = nullptr;
+	const int32 Index = RegisteredInstances.IndexOfByKey(TObjectKey<UCustomizableObjectInstance>(Instance));
+	if (Index != INDEX_NONE)
+	{
+		MutableComponent = RegisteredComponents[Index].ResolveObjectPtr();
+	}
+
+	EnqueueInitialization(Instance, MutableComponent,
+		FOnMutableScheduledUpdateCompleted::CreateUObject(this, &ThisClass::OnInstanceRestored));
+	return true;
+}
+
+bool UMutableExtensionSubsystem::ClearInstanceReleased(const UCustomizableObjectInstance* Instance)
+{
+	FMutableInstanceMemory* Memory = InstanceMemory.Find(Instance);
+	if (!Memory || !Memory->bReleased)
+	{
+		return false;
+	}
+
+	Memory->bReleased = false;
+	MemoryStats.NumReleased--;
+	MemoryStats.TotalRestores++;
+	return true;
+}
+
+void UMutableExtensionSubsystem::OnInstanceRestored(const FMutableScheduledUpdate& Update)
+{
+	if (!UMutableFunctionLib::IsUpdateResultValid(Update.UpdateResult) || Update.bTimedOut)
+	{
+		UE_LOG(LogMutableExtension, Warning, TEXT("[ %s ] { %s } failed to regenerate after being released: %s"),
+			*FString(__FUNCTION__), *GetNameSafe(Update.MutableInstance.Get()),
+			*UMutableFunctionLib::GetUpdateResultAsString(Update.UpdateResult));
+	}
+}
+
+void UMutableExtensionSubsystem::RemoveInstanceMemory(TObjectKey<UCustomizableObjectInstance> Instance)
+{
+	FMutableInstanceMemory Memory;
+	if (InstanceMemory.RemoveAndCopyValue(Instance, Memory))
+	{
+		MemoryStats.UsedBytes -= Memory.GetTotal();
+		MemoryStats.NumReleased -= Memory.bReleased ? 1 : 0;
+		MemoryStats.NumInstances = InstanceMemory.Num();
+	}
+}
+
+void UMutableExtensionSubsystem::PruneInstanceMemory()
+{
+	if (InstanceMemory.Num() == 0)
+	{
+		return;
+	}
+
+	const TSet<TObjectKey<UCustomizableObjectInstance>> Registered(RegisteredInstances);
+
+	for (auto It = InstanceMemory.CreateIterator(); It; ++It)
+	{
+		if (!Registered.Contains(It.Key()))
+		{
+			MemoryStats.UsedBytes -= It.Value().GetTotal();
+			MemoryStats.NumReleased -= It.Value().bReleased ? 1 : 0;
+			It.RemoveCurrent();
+		}
+	}
+	MemoryStats.NumInstances = InstanceMemory.Num();
+
+	// Collected without their components unregistering
+	for (auto It = DiskCachedInstances.CreateIterator(); It; ++It)
+	{
+		if (!It->ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UMutableExtensionSubsystem::AccountInstanceMemory(const UCustomizableObjectInstance* Instance,
+	const USkeletalMeshComponent* MeshComponent)
+{
+	if (!Instance || !MeshComponent || !RegisteredInstances.Contains(TObjectKey<UCustomizableObjectInstance>(Instance)))
+	{
+		return;
+	}
+
+	FMutableInstanceMemory& Memory = InstanceMemory.FindOrAdd(Instance);
+	MemoryStats.UsedBytes -= Memory.GetTotal();
+
+	const bool bReleased = Memory.bReleased;
+	Memory = UMutableFunctionLib::GetGeneratedMemory(MeshComponent);
+	Memory.bReleased = bReleased;
+
+	MemoryStats.UsedBytes += Memory.GetTotal();
+	MemoryStats.PeakUsedBytes = FMath::Max(MemoryStats.PeakUsedBytes, MemoryStats.UsedBytes);
+	MemoryStats.NumInstances = InstanceMemory.Num();
+}
+
+void UMutableExtensionSubsystem::EnforceMemoryBudget()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Now < NextMemoryCheckTime)
+	{
+		return;
+	}
+	NextMemoryCheckTime = Now + MutableExtensionCVars::MemoryCheckInterval;
+	MemoryStats.BudgetBytes = static_cast<int64>(FMath::Max(0, MutableExtensionCVars::MemoryBudgetMB)) * 1024 * 1024;
+
+	PruneInstanceMemory();
+
+	// Speculative candidates only get what registered instances leave of the budget, and always go first
+	if (MemoryStats.BudgetBytes > 0)
+	{
+		TrimSpeculation(FMath::Max<int64>(0, MemoryStats.BudgetBytes - MemoryStats.UsedBytes));
+	}
+
+	if (InstanceMemory.Num() == 0 || (MemoryStats.BudgetBytes == 0 && MemoryStats.NumReleased == 0))
+	{
+		return;
+	}
+
+	MUTABLE_EXTENSION_SCOPE(UMutableExtensionSubsystem::EnforceMemoryBudget);
+
+	struct FMemoryCandidate
+	{
+		UCustomizableObjectInstance* Instance;
+		float Significance;
+		bool bOffScreen;
+	};
+
+	// The most significant component decides for the whole instance
+	UMutableFunctionLib::GatherLocalViewPoints(GetWorld(), ViewPoints);
+	TArray<FMemoryCandidate> Candidates;
+	TMap<TObjectKey<UCustomizableObjectInstance>, int32> CandidateIndices;
+	for (int32 Index = 0; Index < RegisteredComponents.Num(); Index++)
+	{
+		const UCustomizableSkeletalComponent* MutableComponent = RegisteredComponents[Index].ResolveObjectPtr();
+		if (!MutableComponent || !InstanceMemory.Contains(RegisteredInstances[Index]) ||
+			TObjectKey<UCustomizableObjectInstance>(MutableComponent->CustomizableObjectInstance) != RegisteredInstances[Index])
+		{
+			continue;
+		}
+
+		bool bOffScreen;
+		const float Significance = UMutableFunctionLib::GetUpdateSignificance(MutableComponent, ViewPoints, bOffScreen);
+		if (const int32* CandidateIndex = CandidateIndices.Find(RegisteredInstances[Index]))
+		{
+			FMemoryCandidate& Candidate = Candidates[*CandidateIndex];
+			Candidate.Significance = FMath::Max(Candidate.Significance, Significance);
+			Candidate.bOffScreen &= bOffScreen;
+		}
+		else
+		{
+			CandidateIndices.Add(RegisteredInstances[Index], Candidates.Num());
+			Candidates.Add({ MutableComponent->CustomizableObjectInstance, Significance, bOffScreen });
+		}
+	}
+
+	for (const FMemoryCandidate& Candidate : Candidates)
+	{
+		const bool bSignificant = !Candidate.bOffScreen && Candidate.Significance >= MutableExtensionCVars::RestoreAboveSignificance;
+		if (IsInstanceReleased(Candidate.Instance) && (bSignificant || MemoryStats.BudgetBytes == 0))
+		{
+			RestoreInstanceResources(Candidate.Instance);
+		}
+	}
+
+	if (MemoryStats.BudgetBytes == 0 || MemoryStats.UsedBytes <= MemoryStats.BudgetBytes)
+	{
+		return;
+	}
+
+	Algo::SortBy(Candidates, &FMemoryCandidate::Significance);
+	for (const FMemoryCandidate& Candidate : Candidates)
+	{
+		if (MemoryStats.UsedBytes <= MemoryStats.BudgetBytes)
+		{
+			break;
+		}
+
+		if (Candidate.bOffScreen || Candidate.Significance < MutableExtensionCVars::EvictBelowSignificance)
+		{
+			ReleaseInstanceResources(Candidate.Instance);
+		}
+	}
+}
+
+void UMutableExtensionSubsystem::ResetBenchmark()
+{
+	BenchmarkStartTime = FPlatformTime::Seconds();
+	BenchmarkStartCompleted = SchedulerStats.TotalCompleted;
+	BenchmarkInitializationTimes.Reset();
+	BenchmarkFrameTimes.Reset();
+	NextBenchmarkInitialization = 0;
+	NextBenchmarkFrame = 0;
+	BenchmarkStartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	BenchmarkPeakUsedPhysical = BenchmarkStartUsedPhysical;
+	bBenchmarkCapturing = MUTABLEEXTENSION_BENCHMARK_ENABLED;
+}
+
+bool UMutableExtensionSubsystem::WriteBenchmark(FString Filename)
+{
+	bBenchmarkCapturing = false;
+
+	if (Filename.IsEmpty())
+	{
+		Filename = FPaths::ProjectSavedDir() / TEXT("MutableExtension") /
+			FString::Printf(TEXT("Benchmark-%s.json"), *FDateTime::Now().ToString());
+	}
+
+	const double Elapsed = FPlatformTime::Seconds() - (BenchmarkStartTime > 0.0 ? BenchmarkStartTime : GStartTime);
+	const int32 NumCompleted = SchedulerStats.TotalCompleted - BenchmarkStartCompleted;
+	const FPlatformMemoryStats PlatformMemoryStats = FPlatformMemory::GetStats();
+	const uint64 PeakUsedPhysical = FMath::Max<uint64>(BenchmarkPeakUsedPhysical, PlatformMemoryStats.UsedPhysical);
+
+	FString Json;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("world"), GetNameSafe(GetWorld()));
+	Writer->WriteValue(TEXT("elapsedSeconds"), Elapsed);
+	Writer->WriteValue(TEXT("updatesCompleted"), NumCompleted);
+	Writer->WriteValue(TEXT("updatesPerSecond"), Elapsed > 0.0 ? NumCompleted / Elapsed : 0.0);
+	Writer->WriteValue(TEXT("skippedUnchanged"), SchedulerStats.TotalSkippedUnchanged);
+	Writer->WriteValue(TEXT("peakQueueDepth"), SchedulerStats.PeakQueueDepth);
+	Writer->WriteValue(TEXT("averageWaitMs"), SchedulerStats.AverageWaitTime * 1000.f);
+	Writer->WriteValue(TEXT("maxWaitMs"), SchedulerStats.MaxWaitTime * 1000.f);
+	Writer->WriteValue(TEXT("cacheHits"), CacheStats.Hits);
+	Writer->WriteValue(TEXT("cacheMisses"), CacheStats.Misses);
+	// Growth since ResetBenchmark() belongs to this run, the process totals include everything loaded before it
+	Writer->WriteValue(TEXT("peakUsedPhysicalGrowthBytes"), static_cast<int64>(PeakUsedPhysical) - static_cast<int64>(BenchmarkStartUsedPhysical));
+	Writer->WriteValue(TEXT("usedPhysicalGrowthBytes"), static_cast<int64>(PlatformMemoryStats.UsedPhysical) - static_cast<int64>(BenchmarkStartUsedPhysical));
+	Writer->WriteValue(TEXT("processPeakUsedPhysicalBytes"), static_cast<int64>(PlatformMemoryStats.PeakUsedPhysical));
+	Writer->WriteValue(TEXT("processUsedPhysicalBytes"), static_cast<int64>(PlatformMemoryStats.UsedPhysical));
+	MutableExtensionBenchmark::WritePercentiles(*Writer, TEXT("timeToInitializedSeconds"), BenchmarkInitializationTimes);
+	MutableExtensionBenchmark::WritePercentiles(*Writer, TEXT("frameTimeMs"), BenchmarkFrameTimes);
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	if (!FFileHelper::SaveStringToFile(Json, *Filename))
+	{
+		UE_LOG(LogMutableExtension, Error, TEXT("[ %s ] Failed to write benchmark to { %s }"), *FString(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	UE_LOG(LogMutableExtension, Log, TEXT("[ %s ] Wrote benchmark to { %s }"), *FString(__FUNCTION__), *Filename);
+	return true;
+}
+
+void UMutableExtensionSubsystem::NotifyInitializationCompleted(float Seconds)
+{
+#if MUTABLEEXTENSION_BENCHMARK_ENABLED
+	if (bBenchmarkCapturing)
+	{
+		MutableExtensionBenchmark::AddSample(BenchmarkInitializationTimes, NextBenchmarkInitialization,
+			MutableExtensionCVars::MaxBenchmarkInitializations, Seconds);
+	}
+#endif
+}
@@ -0,0 +1,109 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionTrace.h"
+
+#if MUTABLEEXTENSION_STATS_ENABLED
+
+#include "MuCO/CustomizableObjectInstance.h"
+
+#if MUTABLEEXTENSION_CSV_ENABLED
+CSV_DEFINE_CATEGORY(MutableExtension, true);
+#endif
+
+#if MUTABLEEXTENSION_TRACE_ENABLED
+
+UE_TRACE_CHANNEL_DEFINE(MutableExtensionChannel);
+
+TRACE_DECLARE_INT_COUNTER(MutableExtension_QueueDepth, TEXT("MutableExtension/QueueDepth"));
+TRACE_DECLARE_INT_COUNTER(MutableExtension_InFlight, TEXT("MutableExtension/InFlight"));
+TRACE_DECLARE_FLOAT_COUNTER(MutableExtension_WaitMs, TEXT("MutableExtension/WaitMs"));
+TRACE_DECLARE_FLOAT_COUNTER(MutableExtension_GenerationMs, TEXT("MutableExtension/GenerationMs"));
+TRACE_DECLARE_FLOAT_COUNTER(MutableExtension_CompletionLatencyMs, TEXT("MutableExtension/CompletionLatencyMs"));
+
+TRACE_DECLARE_INT_COUNTER(MutableExtension_ResultSuccess, TEXT("MutableExtension/Result/Success"));
+TRACE_DECLARE_INT_COUNTER(MutableExtension_ResultWarning, TEXT("MutableExtension/Result/Warning"));
+TRACE_DECLARE_INT_COUNTER(MutableExtension_ResultError, TEXT("MutableExtension/Result/Error"));
+TRACE_DECLARE_INT_COUNTER(MutableExtension_ResultErrorOptimized, TEXT("MutableExtension/Result/ErrorOptimized"));
+TRACE_DECLARE_INT_COUNTER(MutableExtension_ResultErrorReplaced, TEXT("MutableExtension/Result/ErrorReplaced"));
+TRACE_DECLARE_INT_COUNTER(MutableExtension_ResultErrorDiscarded, TEXT("MutableExtension/Result/ErrorDiscarded"));
+TRACE_DECLARE_INT_COUNTER(MutableExtension_ResultError16BitBoneIndex, TEXT("MutableExtension/Result/Error16BitBoneIndex"));
+
+#define MUTABLE_EXTENSION_COUNTER_SET(Counter, Value) TRACE_COUNTER_SET(Counter, Value)
+#define MUTABLE_EXTENSION_COUNTER_INCREMENT(Counter) TRACE_COUNTER_INCREMENT(Counter)
+
+#else
+
+#define MUTABLE_EXTENSION_COUNTER_SET(Counter, Value)
+#define MUTABLE_EXTENSION_COUNTER_INCREMENT(Counter)
+
+#endif
+
+namespace MutableExtensionTrace
+{
+	void RecordWait(double Seconds)
+	{
+		const float Ms = Seconds * 1000.0;
+		MUTABLE_EXTENSION_COUNTER_SET(MutableExtension_WaitMs, Ms);
+		CSV_CUSTOM_STAT(MutableExtension, WaitMs, Ms, ECsvCustomStatOp::Max);
+		CSV_CUSTOM_STAT(MutableExtension, Dispatched, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	void RecordGeneration(double Seconds, EUpdateResult Result)
+	{
+		const float Ms = Seconds * 1000.0;
+		MUTABLE_EXTENSION_COUNTER_SET(MutableExtension_GenerationMs, Ms);
+		CSV_CUSTOM_STAT(MutableExtension, GenerationMs, Ms, ECsvCustomStatOp::Max);
+
+		switch (Result)
+		{
+		case EUpdateResult::Success:
+			MUTABLE_EXTENSION_COUNTER_INCREMENT(MutableExtension_ResultSuccess);
+			CSV_CUSTOM_STAT(MutableExtension, ResultSuccess, 1, ECsvCustomStatOp::Accumulate);
+			break;
+		case EUpdateResult::Warning:
+			MUTABLE_EXTENSION_COUNTER_INCREMENT(MutableExtension_ResultWarning);
+			CSV_CUSTOM_STAT(MutableExtension, ResultWarning, 1, ECsvCustomStatOp::Accumulate);
+			break;
+		case EUpdateResult::Error:
+			MUTABLE_EXTENSION_COUNTER_INCREMENT(MutableExtension_ResultError);
+			CSV_CUSTOM_STAT(MutableExtension, ResultError, 1, ECsvCustomStatOp::Accumulate);
+			break;
+		case EUpdateResult::ErrorOptimized:
+			MUTABLE_EXTENSION_COUNTER_INCREMENT(MutableExtension_ResultErrorOptimized);
+			CSV_CUSTOM_STAT(MutableExtension, ResultErrorOptimized, 1, ECsvCustomStatOp::Accumulate);
+			break;
+		case EUpdateResult::ErrorReplaced:
+			MUTABLE_EXTENSION_COUNTER_INCREMENT(MutableExtension_ResultErrorReplaced);
+			CSV_CUSTOM_STAT(MutableExtension, ResultErrorReplaced, 1, ECsvCustomStatOp::Accumulate);
+			break;
+		case EUpdateResult::ErrorDiscarded:
+			MUTABLE_EXTENSION_COUNTER_INCREMENT(MutableExtension_ResultErrorDiscarded);
+			CSV_CUSTOM_STAT(MutableExtension, ResultErrorDiscarded, 1, ECsvCustomStatOp::Accumulate);
+			break;
+		case EUpdateResult::Error16BitBoneIndex:
+			MUTABLE_EXTENSION_COUNTER_INCREMENT(MutableExtension_ResultError16BitBoneIndex);
+			CSV_CUSTOM_STAT(MutableExtension, ResultError16BitBoneIndex, 1, ECsvCustomStatOp::Accumulate);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void RecordCompletionLatency(double Seconds)
+	{
+		const float Ms = Seconds * 1000.0;
+		MUTABLE_EXTENSION_COUNTER_SET(MutableExtension_CompletionLatencyMs, Ms);
+		CSV_CUSTOM_STAT(MutableExtension, CompletionLatencyMs, Ms, ECsvCustomStatOp::Max);
+	}
+
+	void RecordQueue(int32 QueueDepth, int32 NumInFlight)
+	{
+		MUTABLE_EXTENSION_COUNTER_SET(MutableExtension_QueueDepth, QueueDepth);
+		MUTABLE_EXTENSION_COUNTER_SET(MutableExtension_InFlight, NumInFlight);
+		CSV_CUSTOM_STAT(MutableExtension, QueueDepth, QueueDepth, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(MutableExtension, InFlight, NumInFlight, ECsvCustomStatOp::Set);
+	}
+}
+
+#endif
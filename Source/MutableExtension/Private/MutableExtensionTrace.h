@@ -0,0 +1,63 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Trace/Trace.h"
+
+enum class EUpdateResult : uint8;
+
+/**
+ * Unreal Insights channel and CSV profiler category for the Mutable Extension pipeline
+ * Enable with -trace=cpu,counters,MutableExtension and -csvCategories=MutableExtension
+ * Insights compiles out in Shipping and without trace. CSV stats follow CSV_PROFILER on their own, so servers built
+ * without trace still have them for soak captures
+ */
+#define MUTABLEEXTENSION_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+#define MUTABLEEXTENSION_CSV_ENABLED (CSV_PROFILER)
+#define MUTABLEEXTENSION_STATS_ENABLED (MUTABLEEXTENSION_TRACE_ENABLED || MUTABLEEXTENSION_CSV_ENABLED)
+
+#if MUTABLEEXTENSION_TRACE_ENABLED
+
+UE_TRACE_CHANNEL_EXTERN(MutableExtensionChannel);
+
+TRACE_DECLARE_INT_COUNTER_EXTERN(MutableExtension_QueueDepth);
+TRACE_DECLARE_INT_COUNTER_EXTERN(MutableExtension_InFlight);
+TRACE_DECLARE_FLOAT_COUNTER_EXTERN(MutableExtension_WaitMs);
+TRACE_DECLARE_FLOAT_COUNTER_EXTERN(MutableExtension_GenerationMs);
+TRACE_DECLARE_FLOAT_COUNTER_EXTERN(MutableExtension_CompletionLatencyMs);
+
+#define MUTABLE_EXTENSION_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#Name, MutableExtensionChannel)
+
+#else
+
+#define MUTABLE_EXTENSION_SCOPE(Name)
+
+#endif
+
+#if MUTABLEEXTENSION_STATS_ENABLED
+
+namespace MutableExtensionTrace
+{
+	/** Time between an update being queued and dispatched to Mutable */
+	void RecordWait(double Seconds);
+
+	/** Time between dispatch to Mutable and Mutable reporting a result */
+	void RecordGeneration(double Seconds, EUpdateResult Result);
+
+	/** Time between Mutable reporting a result and our listeners being told */
+	void RecordCompletionLatency(double Seconds);
+
+	void RecordQueue(int32 QueueDepth, int32 NumInFlight);
+}
+
+#define MUTABLE_EXTENSION_TRACE(Function, ...) MutableExtensionTrace::Function(__VA_ARGS__)
+
+#else
+
+#define MUTABLE_EXTENSION_TRACE(Function, ...)
+
+#endif
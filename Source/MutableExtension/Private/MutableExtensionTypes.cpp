@@ -10,7 +10,13 @@
 FMutablePendingRuntimeUpdate::FMutablePendingRuntimeUpdate(UCustomizableObjectInstance* InMutableInstance,
 	UCustomizableSkeletalComponent* InMutableComponent, USkeletalMeshComponent* InOwningComponent)
 	: UpdateResult(EUpdateResult::Error)
+	, Outcome(EMutableExtensionUpdateOutcome::Generated)
 	, MutableInstance(InMutableInstance)
 	, MutableComponent(InMutableComponent)
 	, OwningComponent(InOwningComponent)
+	, NumRequests(1)
+	, CompletedTime(0.0)
+	, bDirty(false)
+	, bFollowUpIgnoreCloseDist(false)
+	, bFollowUpForceHighPriority(false)
 {}
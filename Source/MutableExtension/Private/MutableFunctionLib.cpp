@@ -6,8 +6,18 @@
 #include "MutableExtensionComponent.h"
 #include "MutableExtensionLog.h"
 #include "MutableExtensionTypes.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/SkeletalMesh.h"
 #include "GameFramework/PlayerState.h"
+#include "Hash/CityHash.h"
+#include "Hash/xxhash.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Materials/MaterialInterface.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "MuCO/CustomizableObject.h"
 #include "MuCO/CustomizableObjectInstancePrivate.h"
+#include "MuCO/CustomizableObjectSystem.h"
 #include "MuCO/CustomizableSkeletalComponent.h"
 
 
@@ -22,8 +32,14 @@ ESkeletalMeshStatus UMutableFunctionLib::GetMutableComponentStatus(
 		return ESkeletalMeshStatus::Error;
 	}
 	
-	UCustomizableObjectInstance* Instance = Component->CustomizableObjectInstance;
-	UCustomizableInstancePrivate* PrivateInstance = Instance ? Instance->GetPrivate() : nullptr;
+	return GetMutableInstanceStatus(Component->CustomizableObjectInstance, bValidResult);
+}
+
+ESkeletalMeshStatus UMutableFunctionLib::GetMutableInstanceStatus(const UCustomizableObjectInstance* Instance,
+	bool& bValidResult)
+{
+	bValidResult = false;
+	const UCustomizableInstancePrivate* PrivateInstance = Instance ? Instance->GetPrivate() : nullptr;
 	if (PrivateInstance)
 	{
 		bValidResult = true;
@@ -85,6 +101,19 @@ void UMutableFunctionLib::UpdateMutableMesh_Callback(const UCustomizableSkeletal
 		bIgnoreCloseDist, bForceHighPriority);
 }
 
+void UMutableFunctionLib::UpdateMutableMesh_Callback(const UCustomizableSkeletalComponent* MutableMesh,
+	const FInstanceUpdateNativeDelegate& InstanceUpdateDelegate, bool bIgnoreCloseDist, bool bForceHighPriority)
+{
+	if (!IsMutableMeshValidToUpdate(MutableMesh))
+	{
+		ErrorOnFailedValidation(MutableMesh);
+		return;
+	}
+
+	MutableMesh->CustomizableObjectInstance->UpdateSkeletalMeshAsyncResult(InstanceUpdateDelegate,
+		bIgnoreCloseDist, bForceHighPriority);
+}
+
 USkeletalMeshComponent* UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(
 	const UCustomizableSkeletalComponent* Component)
 {
@@ -98,6 +127,385 @@ USkeletalMeshComponent* UMutableFunctionLib::GetSkeletalMeshCompFromMutableComp(
 	return OwningComponent;
 }
 
+USkeletalMesh* UMutableFunctionLib::GetReferenceSkeletalMesh(const UCustomizableSkeletalComponent* Component)
+{
+	const UCustomizableObjectInstance* Instance = Component ? Component->CustomizableObjectInstance.Get() : nullptr;
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	return CustomizableObject ? CustomizableObject->GetRefSkeletalMesh(Component->GetComponentIndex()) : nullptr;
+}
+
+void UMutableFunctionLib::SaveDescriptor(UCustomizableObjectInstance* Instance, TArray<uint8>& OutDescriptor)
+{
+	OutDescriptor.Reset();
+	if (!Instance)
+	{
+		return;
+	}
+
+	FMemoryWriter Writer { OutDescriptor, true };
+	Instance->SaveDescriptor(Writer, false);
+}
+
+void UMutableFunctionLib::LoadDescriptor(UCustomizableObjectInstance* Instance, const TArray<uint8>& Descriptor)
+{
+	if (!Instance || Descriptor.Num() == 0)
+	{
+		return;
+	}
+
+	FMemoryReader Reader { Descriptor, true };
+	Instance->LoadDescriptor(Reader);
+}
+
+uint64 UMutableFunctionLib::GetDescriptorHash(const UCustomizableObjectInstance* Instance, const TArray<uint8>& Descriptor)
+{
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	const FString ObjectPath = GetPathNameSafe(CustomizableObject);
+	const uint64 ObjectHash = CityHash64(reinterpret_cast<const char*>(*ObjectPath), ObjectPath.Len() * sizeof(TCHAR));
+	return CityHash64WithSeed(reinterpret_cast<const char*>(Descriptor.GetData()), Descriptor.Num(), ObjectHash);
+}
+
+uint64 UMutableFunctionLib::GetDescriptorHash(UCustomizableObjectInstance* Instance)
+{
+	TArray<uint8> Descriptor;
+	SaveDescriptor(Instance, Descriptor);
+	return GetDescriptorHash(Instance, Descriptor);
+}
+
+namespace MutableExtensionFingerprint
+{
+	static void UpdateString(FXxHash64Builder& Builder, const FString& String)
+	{
+		// Length first, so that consecutive strings can't run into each other
+		const int32 Length = String.Len();
+		Builder.Update(&Length, sizeof(Length));
+		Builder.Update(*String, Length * sizeof(TCHAR));
+	}
+}
+
+bool UMutableFunctionLib::GetDescriptorFingerprint(const UCustomizableObjectInstance* Instance, uint64& OutFingerprint)
+{
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	if (!CustomizableObject)
+	{
+		return false;
+	}
+
+	using namespace MutableExtensionFingerprint;
+
+	FXxHash64Builder Builder;
+	UpdateString(Builder, GetPathNameSafe(CustomizableObject));
+	UpdateString(Builder, Instance->GetCurrentState());
+	const int32 MinLOD = Instance->GetCurrentMinLOD();
+	Builder.Update(&MinLOD, sizeof(MinLOD));
+
+	const int32 NumParameters = CustomizableObject->GetParameterCount();
+	for (int32 ParameterIndex = 0; ParameterIndex < NumParameters; ParameterIndex++)
+	{
+		if (CustomizableObject->IsParameterMultidimensional(ParameterIndex))
+		{
+			return false;
+		}
+
+		const FString& ParameterName = CustomizableObject->GetParameterName(ParameterIndex);
+		switch (CustomizableObject->GetParameterTypeByIndex(ParameterIndex))
+		{
+		case EMutableParameterType::Bool:
+			{
+				const bool bValue = Instance->GetBoolParameterSelectedOption(ParameterName);
+				Builder.Update(&bValue, sizeof(bValue));
+				break;
+			}
+		case EMutableParameterType::Int:
+			UpdateString(Builder, Instance->GetIntParameterSelectedOption(ParameterName));
+			break;
+		case EMutableParameterType::Float:
+			{
+				const float Value = Instance->GetFloatParameterSelectedOption(ParameterName);
+				Builder.Update(&Value, sizeof(Value));
+				break;
+			}
+		case EMutableParameterType::Color:
+			{
+				const FLinearColor Value = Instance->GetColorParameterSelectedOption(ParameterName);
+				Builder.Update(&Value, sizeof(Value));
+				break;
+			}
+		case EMutableParameterType::Texture:
+			{
+				const FName Value = Instance->GetTextureParameterSelectedOption(ParameterName);
+				const uint32 ComparisonIndex = Value.GetComparisonIndex().ToUnstableInt();
+				const int32 Number = Value.GetNumber();
+				Builder.Update(&ComparisonIndex, sizeof(ComparisonIndex));
+				Builder.Update(&Number, sizeof(Number));
+				break;
+			}
+		default:
+			return false;
+		}
+	}
+
+	OutFingerprint = Builder.Finalize().Hash;
+	return true;
+}
+
+namespace MutableExtensionMemory
+{
+	/** Add the material, and any of its textures that weren't counted yet */
+	static void AccountMaterial(UMaterialInterface* Material, FMutableInstanceMemory& Memory,
+		TSet<UTexture*>& CountedTextures, TArray<UTexture*>& UsedTextures)
+	{
+		if (!Material)
+		{
+			return;
+		}
+
+		// Mutable generates dynamic instances, anything else is an asset that isn't ours to count
+		if (Material->IsA<UMaterialInstanceDynamic>())
+		{
+			Memory.MaterialBytes += Material->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+
+		UsedTextures.Reset();
+		Material->GetUsedTextures(UsedTextures, EMaterialQualityLevel::Num, true, ERHIFeatureLevel::Num, true);
+		for (UTexture* Texture : UsedTextures)
+		{
+			bool bAlreadyCounted;
+			CountedTextures.Add(Texture, &bAlreadyCounted);
+			if (Texture && !bAlreadyCounted)
+			{
+				Memory.TextureBytes += Texture->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+			}
+		}
+	}
+}
+
+FMutableInstanceMemory UMutableFunctionLib::GetGeneratedMemory(const USkeletalMeshComponent* MeshComponent)
+{
+	FMutableInstanceMemory Memory;
+	if (!MeshComponent)
+	{
+		return Memory;
+	}
+
+	if (USkeletalMesh* SkeletalMesh = MeshComponent->GetSkeletalMeshAsset())
+	{
+		Memory.MeshBytes = SkeletalMesh->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+	}
+
+	// Materials commonly share textures, only count each once
+	TSet<UTexture*> CountedTextures;
+	TArray<UTexture*> UsedTextures;
+	for (UMaterialInterface* Material : MeshComponent->GetMaterials())
+	{
+		MutableExtensionMemory::AccountMaterial(Material, Memory, CountedTextures, UsedTextures);
+	}
+	return Memory;
+}
+
+int64 UMutableFunctionLib::GetGeneratedResourceSize(const USkeletalMeshComponent* MeshComponent)
+{
+	const FMutableInstanceMemory Memory = GetGeneratedMemory(MeshComponent);
+	return Memory.MeshBytes + Memory.TextureBytes;
+}
+
+int64 UMutableFunctionLib::GetGeneratedResourceSize(const UCustomizableObjectInstance* Instance)
+{
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	if (!CustomizableObject)
+	{
+		return 0;
+	}
+
+	FMutableInstanceMemory Memory;
+	TSet<UTexture*> CountedTextures;
+	TArray<UTexture*> UsedTextures;
+	for (int32 ComponentIndex = 0; ComponentIndex < CustomizableObject->GetComponentCount(); ComponentIndex++)
+	{
+		USkeletalMesh* SkeletalMesh = Instance->GetSkeletalMesh(ComponentIndex);
+		if (!SkeletalMesh)
+		{
+			continue;
+		}
+
+		Memory.MeshBytes += SkeletalMesh->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		for (const FSkeletalMaterial& Material : SkeletalMesh->GetMaterials())
+		{
+			MutableExtensionMemory::AccountMaterial(Material.MaterialInterface, Memory, CountedTextures, UsedTextures);
+		}
+	}
+	return Memory.MeshBytes + Memory.TextureBytes;
+}
+
+int32 UMutableFunctionLib::GetInstanceMinLOD(const UCustomizableObjectInstance* Instance)
+{
+	return Instance ? Instance->GetCurrentMinLOD() : 0;
+}
+
+void UMutableFunctionLib::SetInstanceMinLOD(UCustomizableObjectInstance* Instance, int32 MinLOD)
+{
+	const UCustomizableObject* CustomizableObject = Instance ? Instance->GetCustomizableObject() : nullptr;
+	if (!CustomizableObject)
+	{
+		return;
+	}
+
+	const int32 LeastDetailedLOD = FMath::Max(0, Instance->GetNumLODsAvailable() - 1);
+	MinLOD = MinLOD == INDEX_NONE ? LeastDetailedLOD : FMath::Clamp(MinLOD, 0, LeastDetailedLOD);
+
+	TArray<uint16> RequestedLODsPerComponent;
+	RequestedLODsPerComponent.Init(MinLOD, CustomizableObject->GetComponentCount());
+
+	// We schedule the update ourselves, so whatever Mutable would have requested is ignored
+	FMutableInstanceUpdateMap RequestedUpdates;
+	Instance->SetRequestedLODs(MinLOD, LeastDetailedLOD, RequestedLODsPerComponent, RequestedUpdates);
+}
+
+void UMutableFunctionLib::SetMeshAndOverrideMaterials(USkeletalMeshComponent* MeshComponent, USkeletalMesh* SkeletalMesh,
+	const TArray<TObjectPtr<UMaterialInterface>>& OverrideMaterials)
+{
+	if (!MeshComponent)
+	{
+		return;
+	}
+
+	MeshComponent->SetSkeletalMesh(SkeletalMesh, false);
+	MeshComponent->EmptyOverrideMaterials();
+	for (int32 i = 0; i < OverrideMaterials.Num(); i++)
+	{
+		if (OverrideMaterials[i])
+		{
+			MeshComponent->SetMaterial(i, OverrideMaterials[i]);
+		}
+	}
+}
+
+bool UMutableFunctionLib::AreMaterialTexturesStreamedIn(const TArray<UMaterialInterface*>& Materials)
+{
+	TArray<UTexture*> UsedTextures;
+	for (const UMaterialInterface* Material : Materials)
+	{
+		if (!Material)
+		{
+			continue;
+		}
+
+		UsedTextures.Reset();
+		Material->GetUsedTextures(UsedTextures, EMaterialQualityLevel::Num, true, ERHIFeatureLevel::Num, true);
+		for (UTexture* Texture : UsedTextures)
+		{
+			if (Texture && !Texture->IsFullyStreamedIn())
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void UMutableFunctionLib::PrestreamMaterialTextures(const TArray<UMaterialInterface*>& Materials, float Seconds)
+{
+	for (UMaterialInterface* Material : Materials)
+	{
+		if (Material)
+		{
+			Material->SetForceMipLevelsToBeResident(false, false, Seconds);
+		}
+	}
+}
+
+bool UMutableFunctionLib::IsActorLocallyControlled(const AActor* Actor)
+{
+	const APawn* MaybePawn = Cast<APawn>(Actor);
+	const AController* MaybeC = MaybePawn ? MaybePawn->GetController() : nullptr;
+	return MaybeC ? MaybeC->IsLocalPlayerController() : false;
+}
+
+void UMutableFunctionLib::GatherLocalViewPoints(const UWorld* World, TArray<FMutableViewPoint>& OutViewPoints)
+{
+	OutViewPoints.Reset();
+	if (!World)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!PlayerController || !PlayerController->IsLocalController())
+		{
+			continue;
+		}
+
+		FVector CameraLocation;
+		FRotator CameraRotation;
+		PlayerController->GetPlayerViewPoint(CameraLocation, CameraRotation);
+
+		FMutableViewPoint& ViewPoint = OutViewPoints.AddDefaulted_GetRef();
+		ViewPoint.Location = CameraLocation;
+		ViewPoint.Direction = CameraRotation.Vector();
+		if (PlayerController->PlayerCameraManager)
+		{
+			ViewPoint.HalfFOV = FMath::DegreesToRadians(PlayerController->PlayerCameraManager->GetFOVAngle() * 0.5f);
+		}
+	}
+}
+
+float UMutableFunctionLib::GetUpdateSignificance(const UCustomizableSkeletalComponent* Component,
+	const TArray<FMutableViewPoint>& ViewPoints, bool& bOffScreen)
+{
+	bOffScreen = false;
+	if (!Component)
+	{
+		return 0.f;
+	}
+
+	const AActor* Owner = Component->GetOwner();
+	if (IsActorLocallyControlled(Owner))
+	{
+		return 1000.f;
+	}
+
+	// Without a view (dedicated server) there is nothing to prioritize by
+	if (ViewPoints.Num() == 0)
+	{
+		return 0.f;
+	}
+
+	const USkeletalMeshComponent* MeshComponent = GetSkeletalMeshCompFromMutableComp(Component);
+	const FVector Origin = MeshComponent ? MeshComponent->Bounds.Origin : (Owner ? Owner->GetActorLocation() : Component->GetComponentLocation());
+	const float Radius = MeshComponent ? FMath::Max(MeshComponent->Bounds.SphereRadius, 1.f) : 100.f;
+
+	bOffScreen = true;
+	float ScreenSize = 0.f;
+	for (const FMutableViewPoint& ViewPoint : ViewPoints)
+	{
+		const FVector ToOrigin = Origin - ViewPoint.Location;
+		const float Distance = ToOrigin.Size();
+		if (Distance <= Radius)
+		{
+			bOffScreen = false;
+			ScreenSize = 1.f;
+			break;
+		}
+
+		// Widen the view cone by the angular radius of the bounds
+		const float AngleToOrigin = FMath::Acos(FMath::Clamp(ToOrigin.GetUnsafeNormal() | ViewPoint.Direction, -1.f, 1.f));
+		const float AngularRadius = FMath::Asin(Radius / Distance);
+		if (AngleToOrigin - AngularRadius <= ViewPoint.HalfFOV)
+		{
+			bOffScreen = false;
+		}
+
+		// Fraction of the screen width covered by the bounds
+		const float ViewScreenSize = Radius / (Distance * FMath::Tan(ViewPoint.HalfFOV));
+		ScreenSize = FMath::Max(ScreenSize, FMath::Min(ViewScreenSize, 1.f));
+	}
+
+	// Off-screen actors are still ordered by their size, but behind anything visible
+	return ScreenSize * (bOffScreen ? 10.f : 100.f);
+}
+
 AActor* UMutableFunctionLib::GetTargetedActor(const APlayerController* PlayerController, ECollisionChannel TraceChannel, bool bAllowUnderCursor, bool
 	bDebugTargetActorTrace)
 {
@@ -278,8 +686,11 @@ FString UMutableFunctionLib::GatherMutableDataDump(const AActor* ForActor)
 					Dump += FString::Printf(TEXT("Hidden In Game: { %s }\n"), *LexToString(bHiddenInGame));
 					Dump += FString::Printf(TEXT("Visible: { %s }\n"), *LexToString(MeshComponent->IsVisible()));
 					Dump += FString::Printf(TEXT("Num Materials: { %d }\n"), MeshComponent->GetNumMaterials());
-					Dump += FString::Printf(TEXT("Pending Init: { %s }\n"), *LexToString(ExtensionComp->GetMutableInitializingInstances().Contains(Instance)));
-					Dump += FString::Printf(TEXT("Pending Runtime Update: { %s }\n"), *LexToString(ExtensionComp->GetInstancesPendingRuntimeUpdate().Contains(Instance)));
+					if (ExtensionComp)
+					{
+						Dump += FString::Printf(TEXT("Pending Init: { %s }\n"), *LexToString(ExtensionComp->IsPendingInitialization(Instance)));
+						Dump += FString::Printf(TEXT("Pending Runtime Update: { %s }\n"), *LexToString(ExtensionComp->GetInstancesPendingRuntimeUpdate().Contains(Instance)));
+					}
 				}
 			}
 		}
@@ -340,6 +751,11 @@ FString UMutableFunctionLib::GetUpdateResultAsString(EUpdateResult Result)
 	}
 }
 
+bool UMutableFunctionLib::IsUpdateResultValid(EUpdateResult Result)
+{
+	return Result == EUpdateResult::Success || Result == EUpdateResult::Warning;
+}
+
 FString UMutableFunctionLib::ParseRuntimeUpdateError_Simple(const EMutableExtensionRuntimeUpdateError& Error)
 {
 	switch(Error)
@@ -350,6 +766,8 @@ FString UMutableFunctionLib::ParseRuntimeUpdateError_Simple(const EMutableExtens
 		return "Update Already Pending";
 	case EMutableExtensionRuntimeUpdateError::MeshNotValidToUpdate:
 		return "Mesh Not Valid To Update";
+	case EMutableExtensionRuntimeUpdateError::SchedulerUnavailable:
+		return "Scheduler Unavailable";
 	default:
 		return "None";
 	}
@@ -360,11 +778,13 @@ FString UMutableFunctionLib::ParseRuntimeUpdateError_Verbose(const EMutableExten
 	switch(Error)
 	{
 	case EMutableExtensionRuntimeUpdateError::DelegateNotBound:
-		return "Delegate Not Bound: UMutableExtensionComponent::OnComponentRuntimeUpdateCompleted";
+		return "Delegate Not Bound: UMutableExtensionComponent::OnComponentRuntimeUpdateCompleted, OnRuntimeUpdateCompletedNative or SubscribeToRuntimeUpdate()";
 	case EMutableExtensionRuntimeUpdateError::AlreadyPendingUpdate:
 		return "Update Already Pending: Call UMutableExtensionComponent::IsPendingUpdate() before UMutableExtensionComponent::RuntimeUpdateMutableComponent";
 	case EMutableExtensionRuntimeUpdateError::MeshNotValidToUpdate:
 		return "Mesh Not Valid To Update: SkeletalMeshStatus != Success, therefore it either errored or has not yet been generated. Call UMutableFunctionLib::IsMutableMeshValidToUpdate() before UMutableExtensionComponent::RuntimeUpdateMutableComponent";
+	case EMutableExtensionRuntimeUpdateError::SchedulerUnavailable:
+		return "Scheduler Unavailable: UMutableExtensionSubsystem does not exist for this world type";
 	default:
 		return "None";
 	}
@@ -3,16 +3,22 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "MutableExtensionReplication.h"
 #include "MutableExtensionTypes.h"
 #include "Components/ActorComponent.h"
 #include "MutableExtensionComponent.generated.h"
 
-struct FUpdateContext;
+enum class EMutableDiskCacheRead : uint8;
+struct FMutableScheduledUpdate;
 class UCustomizableObjectInstance;
 class UCustomizableSkeletalComponent;
+class UMutableExtensionSubsystem;
+class USkeletalMesh;
 
 DECLARE_DYNAMIC_DELEGATE(FOnMutableExtensionSimpleDelegate);
 DECLARE_DYNAMIC_DELEGATE_OneParam(FOnMutableExtensionUpdateDelegate, const FMutablePendingRuntimeUpdate&, Updated);
+DECLARE_MULTICAST_DELEGATE(FOnMutableExtensionFullQualityNative);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMutableExtensionRuntimeUpdateNative, const FMutablePendingRuntimeUpdate& /* Updated */);
 
 /**
  * Handler for initialization of Mutable components
@@ -24,6 +30,8 @@ DECLARE_DYNAMIC_DELEGATE_OneParam(FOnMutableExtensionUpdateDelegate, const FMuta
  *
  * RUNTIME FLOW: 
  * [ When Mesh Changed]  ➜ RuntimeUpdateMutableComponents()
+ *
+ * Runtime updates are queued on the UMutableExtensionSubsystem, which dispatches them to Mutable under a per-frame budget
  */
 UCLASS()
 class MUTABLEEXTENSION_API UMutableExtensionComponent final : public UActorComponent
@@ -35,7 +43,9 @@ public:
 
 	void ResetMutableInitialization();
 
+	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 public:
 	// Begin Initialization
@@ -48,11 +58,75 @@ public:
 	/** @return True if nothing is pending initialization and RequestMutableInitialization() was ever called */
 	bool HasMutableInitialized() const { return bHasRequestedInitialize && InstancesPendingInitialization.Num() == 0; }
 
+	bool IsPendingInitialization(const UCustomizableObjectInstance* Instance) const { return InstancesPendingInitialization.Contains(Instance); }
+	int32 GetNumPendingInitialization() const { return InstancesPendingInitialization.Num(); }
+
+	/** Per-instance latency of the most recent initialization, and which instance held up OnMutableInitialized */
+	const FMutableInitializationStats& GetInitializationStats() const { return InitializationStats; }
+
+	/**
+	 * If true, instances whose descriptors are identical to one already generated in the world share that generated
+	 * instance (and therefore its skeletal meshes and materials) instead of generating their own
+	 * A runtime update on a shared instance gives this actor its own copy first
+	 * Instances prewarmed with UMutableExtensionSubsystem::PrewarmInstances() are shared even if this is false
+	 * @see UMutableExtensionSubsystem::AcquireCachedInstance()
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	bool bShareGeneratedInstances = false;
+
+	/**
+	 * If true, initialization first looks for what a previous run generated for the same Customizable Object and
+	 * descriptor on disk, and stores what Mutable generates for the next run. Intended for rosters that are identical
+	 * across runs, e.g. bots and NPCs
+	 * @see FMutableExtensionDiskCache, MutableExtension.DiskCache.Enabled
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	bool bUseDiskCache = false;
+
+	/**
+	 * If true, RequestMutableInitialization() first generates only the less detailed LODs from ProgressiveMinLOD so that
+	 * OnMutableInitialized fires sooner, then regenerates at full detail in the background at lower priority
+	 * @see FMutableInitializationStats::TimeToFullQuality
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	bool bProgressiveInitialization = false;
+
+	/** First LOD generated by progressive initialization, INDEX_NONE for the least detailed LOD available */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable", meta=(EditCondition="bProgressiveInitialization"))
+	int32 ProgressiveMinLOD = INDEX_NONE;
+
+	/** @return True while progressive initialization is still generating full detail */
+	bool IsRefining() const { return RefiningInstances.Num() > 0; }
+
+	/** Broadcast once progressive initialization has generated every instance at full detail */
+	FOnMutableExtensionFullQualityNative OnMutableFullQualityNative;
+
+	/**
+	 * What to generate when running as a dedicated server
+	 * When not generating, OnMutableInitialized and runtime update listeners are still called, immediately, so gameplay
+	 * code does not need to know; runtime updates report EMutableExtensionUpdateOutcome::ServerSkipped
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	EMutableExtensionServerGeneration DedicatedServerGeneration = EMutableExtensionServerGeneration::Generate;
+
+	/** @return True if DedicatedServerGeneration applies and Mutable is never called */
+	bool ShouldSkipGeneration() const;
+
+	/**
+	 * Identifies this actor in world snapshots, must be unique within the world and the same wherever the snapshot is
+	 * restored, e.g. a save game id. None to use the owning actor's name
+	 * @see UMutableExtensionSubsystem::SaveWorldSnapshot()
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	FName SnapshotId = NAME_None;
+
+	FName GetSnapshotId() const;
+
 private:
 	FOnMutableExtensionSimpleDelegate OnMutableInitialized;
 
 	UPROPERTY()
-	TArray<UCustomizableObjectInstance*> InstancesPendingInitialization;
+	TSet<UCustomizableObjectInstance*> InstancesPendingInitialization;
 
 	UPROPERTY()
 	TArray<UCustomizableObjectInstance*> CachedInitializingInstances;
@@ -63,11 +137,81 @@ private:
 	UPROPERTY()
 	bool bHasRequestedInitialize = false;
 
+	UPROPERTY()
+	FMutableInitializationStats InitializationStats;
+
+	/** Descriptor hash each pending instance is being initialized with */
+	TMap<const UCustomizableObjectInstance*, uint64> InitializingDescriptorHashes;
+
+	/** Pending instances that we are generating, rather than waiting on a shared instance */
+	TSet<const UCustomizableObjectInstance*> GeneratingInstances;
+
+	/** Instances we are waiting on somebody else to finish updating */
+	TMap<UCustomizableObjectInstance*, FDelegateHandle> InstanceUpdatedHandles;
+
+	/** Bound while waiting on somebody else, in case their update never completes */
+	FDelegateHandle InstanceTimedOutHandle;
+
+	/** Instances generated at low detail by progressive initialization, and the MinLOD to restore for full detail */
+	TMap<UCustomizableObjectInstance*, int32> RefiningInstances;
+
+	/** Complete initialization without generating anything, see DedicatedServerGeneration */
+	void SkipMutableInitialization();
+
+	/** Queue full detail generation of everything progressive initialization generated at low detail */
+	void BeginRefinement();
+
+	void OnMutableInstanceRefinementCompleted(const FMutableScheduledUpdate& Update);
+
+	/** Shared instances from UMutableExtensionSubsystem that this component holds a reference to */
+	TSet<UCustomizableObjectInstance*> SharedInstances;
+
 	UFUNCTION()
 	void BeginMutableInitialization();
 	
 	void OnInitializationCompleted();
 
+	void WaitForInstanceUpdate(UCustomizableObjectInstance* Instance);
+
+	void OnInstanceUpdated(UCustomizableObjectInstance* UpdatedInstance);
+
+	void OnInstanceTimedOut(UCustomizableObjectInstance* Instance);
+
+	void OnMutableInstanceInitializationCompleted(const FMutableScheduledUpdate& Update);
+
+	void CompleteInstanceInitialization(UCustomizableObjectInstance* Instance, bool bSuccess, double DispatchTime = 0.0,
+		bool bTimedOut = false);
+
+	/** Point every component using Instance at SharedInstance instead */
+	void ShareInstance(UCustomizableObjectInstance* Instance, UCustomizableObjectInstance* SharedInstance);
+
+	/**
+	 * Share, read from the disk cache or generate a pending instance
+	 * @param bReadDiskCache False once the disk cache missed, to generate it
+	 */
+	void InitializeInstance(UCustomizableObjectInstance* Instance, bool bReadDiskCache);
+
+	/** Instances waiting on the disk cache, see UMutableExtensionSubsystem::ReadDiskCache() */
+	TSet<const UCustomizableObjectInstance*> DiskCacheReadingInstances;
+
+	/** Bind what a previous run generated for the instance and complete its initialization, or generate it on a miss */
+	void OnDiskCacheRead(EMutableDiskCacheRead Result, const TMap<int32, USkeletalMesh*>& Meshes,
+		UCustomizableObjectInstance* Instance, uint64 DescriptorHash);
+
+	/** Stop sharing the instance, taking our own copy if anybody else is still using it */
+	UCustomizableObjectInstance* UnshareInstance(UCustomizableObjectInstance* SharedInstance);
+
+	/** Point every component and subscriber of Instance at NewInstance */
+	void ReplaceInstance(UCustomizableObjectInstance* Instance, UCustomizableObjectInstance* NewInstance);
+
+	void ReleaseSharedInstances();
+
+	/** @return Estimated size of everything generated for the instance across our components */
+	int64 GetGeneratedResourceSize(const UCustomizableObjectInstance* Instance) const;
+
+	/** The memory budget released the instance, point every component and subscriber at the copy that replaces it */
+	void ReleaseInstance(UCustomizableObjectInstance* Instance, UCustomizableObjectInstance* ReleasedInstance);
+
 	// ~End Initialization
 
 public:
@@ -75,6 +219,109 @@ public:
 
 	FOnMutableExtensionUpdateDelegate OnComponentRuntimeUpdateCompleted;
 
+	/** Native counterpart to OnComponentRuntimeUpdateCompleted that any number of systems can listen to */
+	FOnMutableExtensionRuntimeUpdateNative OnRuntimeUpdateCompletedNative;
+
+	/** When completions are delivered to OnComponentRuntimeUpdateCompleted and the native events */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	EMutableExtensionCompletionDelivery CompletionDelivery = EMutableExtensionCompletionDelivery::Immediate;
+
+	/** Listen for runtime updates of a single instance only */
+	FDelegateHandle SubscribeToRuntimeUpdate(const UCustomizableObjectInstance* Instance, FOnMutableExtensionRuntimeUpdateNative::FDelegate&& Delegate);
+	void UnsubscribeFromRuntimeUpdate(const UCustomizableObjectInstance* Instance, FDelegateHandle Handle);
+
+	/** @return True if anything will receive the completion of a runtime update for this instance */
+	bool HasRuntimeUpdateListener(const UCustomizableObjectInstance* Instance) const;
+
+	/**
+	 * If true, requesting a runtime update for an instance that is already pending will not fail with AlreadyPendingUpdate
+	 * Instead the latest parameters win: the instance is marked dirty and exactly one follow-up update is made when the
+	 * current one completes. OnComponentRuntimeUpdateCompleted is called once for every request, after the follow-up
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	bool bCoalesceRuntimeUpdates = false;
+
+	/**
+	 * If true, requesting a runtime update for an instance that is already pending cancels the pending update instead of
+	 * failing with AlreadyPendingUpdate. Its listeners receive EMutableExtensionUpdateOutcome::Cancelled and the new request
+	 * takes its place. Ignored if bCoalesceRuntimeUpdates is true
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	bool bSupersedeRuntimeUpdates = false;
+
+	/**
+	 * If true, the mesh bound when a runtime update is requested stays bound after Mutable generates the new one, until
+	 * the new mesh's textures have streamed in. Swaps across every component are spread over frames by
+	 * MutableExtension.MeshSwap.MaxPerFrame. Listeners are told the update completed once the new mesh is bound
+	 * Mutable generates a copy of the instance so the new mesh is only ever bound once, the copy then replaces the
+	 * component's instance. Read the instance from the component, or FMutablePendingRuntimeUpdate::MutableInstance,
+	 * rather than holding on to it
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	bool bDeferMeshSwap = false;
+
+	/** @return True while a generated mesh is waiting to replace the one bound to OwningComponent */
+	bool IsMeshSwapPending(const USkeletalMeshComponent* OwningComponent) const;
+
+	bool HasPendingMeshSwaps() const { return NumStagedMeshSwaps > 0; }
+
+	/**
+	 * Bind staged meshes whose textures are streamed in, or that have waited long enough, called by UMutableExtensionSubsystem
+	 * @return Number of meshes bound
+	 */
+	int32 ApplyReadyMeshSwaps(int32 MaxSwaps, float MaxWaitSeconds);
+
+	/**
+	 * Stop the pending runtime update for this component's instance, listeners receive EMutableExtensionUpdateOutcome::Cancelled
+	 * If it was already dispatched Mutable still finishes it, but the result is ignored
+	 * @return True if an update was pending
+	 */
+	bool CancelRuntimeUpdate(const UCustomizableSkeletalComponent* Component);
+
+	/** Cancel every pending runtime update, see CancelRuntimeUpdate(). To cancel initialization use ResetMutableInitialization() */
+	int32 CancelRuntimeUpdates();
+
+	/**
+	 * If true, a runtime update whose descriptor matches the last successful update of that instance completes with
+	 * EMutableExtensionUpdateOutcome::Unchanged instead of regenerating
+	 * The completion is delivered at the end of the frame regardless of CompletionDelivery, never before
+	 * RuntimeUpdateMutableComponent() returns
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	bool bSkipUnchangedRuntimeUpdates = false;
+
+	/** @return Number of runtime updates this component completed without regenerating because nothing changed */
+	int32 GetNumSkippedUnchangedUpdates() const { return NumSkippedUnchangedUpdates; }
+
+	/**
+	 * Generate likely next descriptors of the component's instance while the scheduler is idle
+	 * A runtime update that matches one then completes with EMutableExtensionUpdateOutcome::Speculated at the end of the frame
+	 * @see UMutableExtensionSubsystem::AddSpeculativeCandidates()
+	 * @return Number of candidates added
+	 */
+	int32 AddSpeculativeCandidates(const UCustomizableSkeletalComponent* Component, const TArray<TArray<uint8>>& Descriptors);
+
+	/** Discard every candidate of the component's instance, e.g. when the customization menu is closed */
+	void ClearSpeculativeCandidates(const UCustomizableSkeletalComponent* Component);
+
+	/**
+	 * While in a transaction, runtime updates are collected instead of submitted
+	 * Gameplay systems can then freely set parameters and request updates without each causing a regeneration
+	 * Transactions nest, nothing is submitted until the outermost is committed
+	 * @see FMutableScopedParameterTransaction
+	 */
+	void BeginParameterTransaction();
+
+	/**
+	 * Submit a single runtime update for every instance whose descriptor changed since the transaction began, or that
+	 * had an update requested during it. As with coalesced updates, every request made during the transaction receives
+	 * its own completion. Those that can no longer be submitted complete with EMutableExtensionUpdateOutcome::Rejected
+	 * @return Number of runtime updates submitted
+	 */
+	int32 CommitParameterTransaction();
+
+	bool IsInParameterTransaction() const { return TransactionDepth > 0; }
+
 	bool RuntimeUpdateMutableComponent(USkeletalMeshComponent* OwningComponent, UCustomizableSkeletalComponent* Component, EMutableExtensionRuntimeUpdateError& Error, bool bIgnoreCloseDist = false, bool bForceHighPriority = false);
 
 	bool IsPendingUpdate(const UCustomizableSkeletalComponent* Component) const;
@@ -93,11 +340,191 @@ private:
 	UPROPERTY()
 	TMap<UCustomizableObjectInstance*, FMutablePendingRuntimeUpdate> InstancesPendingRuntimeUpdate;
 
-	UFUNCTION()
-	void OnMutableInstanceRuntimeUpdateCompleted(const FUpdateContext& Result);
+	bool CancelInstanceRuntimeUpdate(UCustomizableObjectInstance* Instance, bool bNotifyListeners);
+
+	UPROPERTY()
+	TMap<USkeletalMeshComponent*, FMutableMeshSwap> MeshSwaps;
+
+	int32 NumStagedMeshSwaps = 0;
+
+	/** Queue a runtime update with the subsystem, into a copy of the instance if bDeferMeshSwap */
+	void EnqueueRuntimeUpdate(UMutableExtensionSubsystem* Subsystem, USkeletalMeshComponent* OwningComponent,
+		UCustomizableSkeletalComponent* Component, bool bIgnoreCloseDist, bool bForceHighPriority);
+
+	/** @return Copy of the component's instance to generate instead, that no component uses */
+	UCustomizableObjectInstance* CaptureMeshSwap(USkeletalMeshComponent* OwningComponent, UCustomizableSkeletalComponent* Component);
+
+	/** @return The instance a runtime update is pending for, GeneratedInstance unless it is a copy made by CaptureMeshSwap() */
+	UCustomizableObjectInstance* GetRuntimeUpdateInstance(UCustomizableObjectInstance* GeneratedInstance) const;
+
+	/**
+	 * Hold the generated copy until its textures are ready, nothing was bound yet
+	 * @return True if the completion will be delivered once the mesh is swapped
+	 */
+	bool StageMeshSwap(const FMutablePendingRuntimeUpdate& CompletedUpdate, UCustomizableObjectInstance* GeneratedInstance);
+
+	/** Bind the staged copy's meshes and replace the component's instance with it */
+	void BindStagedInstance(FMutableMeshSwap& MeshSwap);
+
+	/** Bind every staged mesh immediately and cancel copies still generating, without notifying listeners */
+	void FlushMeshSwaps();
+
+	/** Stop anything queued with UMutableExtensionSubsystem for this component, without notifying anyone */
+	void CancelScheduledWork();
+
+	/**
+	 * Swap in a speculative candidate generated for the instance's current descriptor, see AddSpeculativeCandidates()
+	 * @return True if the update was completed with EMutableExtensionUpdateOutcome::Speculated
+	 */
+	bool CommitSpeculativeInstance(USkeletalMeshComponent* OwningComponent, UCustomizableSkeletalComponent* Component,
+		int32 NumRequests);
+
+	/** RuntimeUpdateMutableComponent() on behalf of NumRequests callers, each of which receives a completion */
+	bool RequestRuntimeUpdate(USkeletalMeshComponent* OwningComponent, UCustomizableSkeletalComponent* Component,
+		EMutableExtensionRuntimeUpdateError& Error, bool bIgnoreCloseDist, bool bForceHighPriority, int32 NumRequests);
+
+	/** Descriptor hash of the last successful initialization or runtime update of each instance */
+	TMap<const UCustomizableObjectInstance*, uint64> LastGeneratedDescriptorHashes;
+
+	/** @return True if Mutable can update the component, or the scheduler will regenerate it from scratch */
+	bool IsMeshValidToRuntimeUpdate(const UCustomizableSkeletalComponent* Component) const;
+
+	/** Current descriptor hash, cached by UMutableExtensionSubsystem until the parameters change */
+	uint64 GetDescriptorHash(UCustomizableObjectInstance* Instance) const;
+
+	int32 NumSkippedUnchangedUpdates = 0;
+
+	int32 TransactionDepth = 0;
+
+	/** Descriptor hash of every initialized instance when the outermost transaction began */
+	TMap<const UCustomizableObjectInstance*, uint64> TransactionBaseHashes;
+
+	UPROPERTY()
+	TMap<UCustomizableObjectInstance*, FMutableTransactionUpdate> TransactionUpdates;
+
+	void OnMutableInstanceRuntimeUpdateCompleted(const FMutableScheduledUpdate& Update);
 	
-	UFUNCTION()
-	void CallOnComponentRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& PendingUpdate) const;
+	TMap<const UCustomizableObjectInstance*, FOnMutableExtensionRuntimeUpdateNative> InstanceRuntimeUpdateDelegates;
+
+	/** Completions waiting for the end of the frame, when using EMutableExtensionCompletionDelivery::EndOfFrame or not generated */
+	TArray<FMutablePendingRuntimeUpdate> QueuedCompletions;
+
+	FDelegateHandle EndOfFrameHandle;
+
+	void CallOnComponentRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& PendingUpdate);
+
+	/** Deliver at the end of the frame, for completions that would otherwise happen before the request returns */
+	void QueueRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& PendingUpdate);
+
+	void DeliverQueuedCompletions();
+
+	void BroadcastRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& PendingUpdate) const;
 
 	// ~End Runtime Update
+
+public:
+	// Begin Replication
+
+	/**
+	 * If true, the authority replicates the descriptor of every initializing component, bit-packed and one parameter at
+	 * a time so that only parameters that changed are sent. Clients apply them and run the runtime update themselves
+	 * Components are matched by their order in RequestMutableInitialization(), which must be the same on every machine
+	 * Bool, int, float and color parameters are replicated, textures and projectors are not
+	 * Console: MutableExtension.Replication.Stats
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Mutable")
+	bool bReplicateDescriptors = false;
+
+	/**
+	 * Precision of replicated float and color parameters. Lossless by default, quantized only where the difference
+	 * can't be seen, e.g. colors that are never outside [0,1]. Only the authority's setting matters
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable", meta=(EditCondition="bReplicateDescriptors"))
+	EMutableReplicationPrecision ReplicationPrecision = EMutableReplicationPrecision::Lossless;
+
+	const FMutableReplicationStats& GetReplicationStats() const { return ReplicationStats; }
+
+	/** Called by FMutableReplicatedDescriptor when parameters are received */
+	void ApplyReplicatedParameters(const TArrayView<int32>& Indices);
+
+private:
+	UPROPERTY(Replicated)
+	FMutableReplicatedDescriptor ReplicatedDescriptor;
+
+	UPROPERTY()
+	FMutableReplicationStats ReplicationStats;
+
+	/** Components whose replicated parameters were applied but not yet updated */
+	UPROPERTY()
+	TArray<UCustomizableSkeletalComponent*> ComponentsPendingReplicatedUpdate;
+
+	/** When parameters were first received for each instance that has not been updated with them yet */
+	TMap<const UCustomizableObjectInstance*, double> ReplicatedReceiveTimes;
+
+	/** Replicated updates need a listener, the same as any other runtime update */
+	TMap<const UCustomizableObjectInstance*, FDelegateHandle> ReplicatedUpdateHandles;
+
+	/** Authority: mark every parameter of Component that changed since it was last replicated */
+	void ReplicateDescriptor(const UCustomizableSkeletalComponent* Component);
+
+	/** @return The component the parameter was applied to, nullptr if it isn't initializing */
+	UCustomizableSkeletalComponent* ApplyReplicatedParameter(const FMutableReplicatedParameter& Parameter);
+
+	/** Apply everything received so far, before initialization reads the descriptors */
+	void ApplyReplicatedDescriptor();
+
+	/** Request a runtime update for every component with replicated parameters, once initialized */
+	void FlushReplicatedUpdates();
+
+	void OnReplicatedRuntimeUpdateCompleted(const FMutablePendingRuntimeUpdate& Update);
+
+	// ~End Replication
+
+public:
+	// Begin Pooling
+
+	/**
+	 * Keep everything generated while the actor sits in a pool, instead of ResetMutableInitialization()
+	 * Pending runtime updates are cancelled, but instances, their generated meshes and usages stay alive and registered,
+	 * so the memory budget can still release them if the pool is hidden
+	 * @return False if initialization hadn't completed, everything is reset instead
+	 */
+	bool ParkMutable();
+
+	/**
+	 * Return a parked actor to play. Descriptors may be changed while parked, only instances whose descriptor differs
+	 * from what was last generated (or that were released) are regenerated
+	 * RequestMutableInitialization() unparks instead when given the same components and instances
+	 * @return Called once every instance is ready, the same as RequestMutableInitialization()
+	 */
+	FOnMutableExtensionSimpleDelegate& UnparkMutable();
+
+	bool IsParked() const { return bParked; }
+
+	const FMutablePoolStats& GetPoolStats() const { return PoolStats; }
+
+private:
+	bool bParked = false;
+
+	FMutablePoolStats PoolStats;
+
+	/** @return True if the components and their instances are exactly what we parked with */
+	bool CanUnpark(const TArray<UCustomizableSkeletalComponent*>& MutableComponents) const;
+
+	/** Complete unchanged instances and regenerate the rest, next tick so the caller can bind OnMutableInitialized */
+	void BeginUnpark();
+
+	// ~End Pooling
+};
+
+/** Begins a parameter transaction on construction and commits it on destruction */
+struct MUTABLEEXTENSION_API FMutableScopedParameterTransaction
+{
+	explicit FMutableScopedParameterTransaction(UMutableExtensionComponent* InExtensionComponent);
+	~FMutableScopedParameterTransaction();
+
+	UE_NONCOPYABLE(FMutableScopedParameterTransaction);
+
+private:
+	TWeakObjectPtr<UMutableExtensionComponent> ExtensionComponent;
 };
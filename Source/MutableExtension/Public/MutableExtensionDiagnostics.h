@@ -0,0 +1,89 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "MutableExtensionTypes.h"
+#include "MuCO/CustomizableObjectInstance.h"
+
+/** State of a single UCustomizableSkeletalComponent at the time of the snapshot */
+struct MUTABLEEXTENSION_API FMutableComponentDiagnostics
+{
+	FName ComponentName;
+	FName InstanceName;
+	FName MeshComponentName;
+	FName SkeletalMeshName;
+
+	ESkeletalMeshStatus MeshStatus = ESkeletalMeshStatus::NotGenerated;
+	bool bValidMeshStatus = false;
+
+	bool bHiddenInGame = false;
+	bool bVisible = false;
+	int32 NumMaterials = 0;
+
+	/** Always false if the actor has no UMutableExtensionComponent */
+	bool bPendingInitialization = false;
+	bool bPendingRuntimeUpdate = false;
+};
+
+/** State of an actor with a UCustomizableSkeletalComponent or UMutableExtensionComponent at the time of the snapshot */
+struct MUTABLEEXTENSION_API FMutableActorDiagnostics
+{
+	FName ActorName;
+	FName OwnerName;
+
+	TEnumAsByte<ENetRole> LocalRole = ROLE_None;
+	TEnumAsByte<ENetRole> RemoteRole = ROLE_None;
+	bool bHasAuthority = false;
+	bool bHidden = false;
+	bool bLocallyControlled = false;
+	bool bIsBot = false;
+
+	bool bHasExtensionComponent = false;
+	bool bHasMutableInitialized = false;
+	int32 NumPendingInitialization = 0;
+	int32 NumPendingRuntimeUpdate = 0;
+
+	/** Range of FMutableWorldDiagnostics::Components that belong to this actor */
+	int32 FirstComponent = 0;
+	int32 NumComponents = 0;
+};
+
+/**
+ * Snapshot of every Mutable actor in a world, gathered in a single pass
+ * Names are stored as FName and components are flattened into a single array, so gathering into the same snapshot
+ * repeatedly does not allocate once it has grown to fit the world
+ *
+ * Console: Mutable.DumpAll [Json|Csv] [Filename]
+ */
+struct MUTABLEEXTENSION_API FMutableWorldDiagnostics
+{
+	FName WorldName;
+	double CaptureTime = 0.0;
+
+	TArray<FMutableActorDiagnostics> Actors;
+	TArray<FMutableComponentDiagnostics> Components;
+
+	FMutableExtensionSchedulerStats SchedulerStats;
+	FMutableExtensionCacheStats CacheStats;
+	FMutableExtensionMemoryStats MemoryStats;
+	FMutableSpeculationStats SpeculationStats;
+	FMutableDiskCacheStats DiskCacheStats;
+	FMutablePoolStats PoolStats;
+	FMutableSnapshotStats SnapshotStats;
+
+	/** Replace the snapshot with the current state of World */
+	void Gather(const UWorld* World);
+
+	/** Append a single actor, ignored if it has no Mutable components */
+	void GatherActor(const AActor* Actor);
+
+	void Reset();
+
+	/** Stream the snapshot to Ar as UTF-8 JSON */
+	void WriteJson(FArchive& Ar) const;
+
+	/** Stream the snapshot to Ar as UTF-8 CSV, one row per component (or per actor that has none) */
+	void WriteCsv(FArchive& Ar) const;
+};
@@ -0,0 +1,145 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+#include "UObject/GCObject.h"
+
+struct FStreamableHandle;
+class UCustomizableObject;
+class UCustomizableObjectInstance;
+class USkeletalMesh;
+
+/** Result of reading an entry with FMutableDiskCacheRead */
+enum class EMutableDiskCacheRead : uint8
+{
+	Hit,
+	/** No entry for this object and descriptor */
+	Missing,
+	/** Written for a different compilation of the object, or an older format */
+	Stale,
+	/** Unreadable or referencing assets that no longer load */
+	Invalid,
+};
+
+/** Outcome of FMutableExtensionDiskCache::Write() */
+struct FMutableDiskCacheWriteResult
+{
+	/** Zero if the entry couldn't be written */
+	int64 BytesWritten = 0;
+
+	/** Oldest entries deleted to stay under the size limit */
+	int32 NumEvicted = 0;
+	int64 EvictedBytes = 0;
+};
+
+/** Everything generated for an instance, gathered by FMutableExtensionDiskCache::PrepareWrite() */
+struct FMutableDiskCacheWrite;
+
+/**
+ * Generated meshes, materials and textures of an instance, stored on disk so that a later run can skip Mutable
+ *
+ * Entries are keyed by the Customizable Object's compilation and the descriptor hash. Each is a single file:
+ *   Header		Magic, format version, object version, descriptor hash and where the contents are
+ *   Payload	Mesh render data and texture mips, each aligned to BlobAlignment so they can be used straight from
+ *				the memory mapped file
+ *   Contents	Skeleton, LODs, materials and parameters of every component, with offsets into the payload
+ *
+ * Meshes with morph targets, clothing, or a skeleton or physics asset merged by Mutable are not cached
+ */
+struct MUTABLEEXTENSION_API FMutableExtensionDiskCache
+{
+	static constexpr int64 BlobAlignment = 4096;
+
+	/** Changes whenever the object is recompiled */
+	static uint64 GetObjectVersion(const UCustomizableObject* CustomizableObject);
+
+	static FString GetEntryFilename(const UCustomizableObject* CustomizableObject, uint64 DescriptorHash);
+
+	static FString GetDirectory();
+
+	/**
+	 * Gather everything generated for the instance, on the game thread. Render data and mips are copied, so Write()
+	 * never touches objects Mutable or the render thread may still change or discard
+	 * @return Nullptr if anything generated can't be cached
+	 */
+	static TSharedPtr<FMutableDiskCacheWrite> PrepareWrite(const UCustomizableObjectInstance* Instance, uint64 DescriptorHash);
+
+	/**
+	 * Serialize and write the entry, then delete the least recently used entries until the cache is under MaxBytes
+	 * Thread safe, but the game thread must keep Entry alive until it returns. Entry's payload is released as it is written
+	 * @param MaxBytes Unlimited if zero or less
+	 */
+	static FMutableDiskCacheWriteResult Write(FMutableDiskCacheWrite& Entry, int64 MaxBytes);
+
+	/** Delete the least recently used entries until the cache is under MaxBytes. Thread safe */
+	static void Trim(int64 MaxBytes, int32& OutNumEvicted, int64& OutEvictedBytes);
+};
+
+/**
+ * Recreates the generated skeletal meshes, with their materials, from an entry without blocking the game thread
+ * The file is mapped, validated and decoded on a worker thread and referenced assets are loaded asynchronously. The game
+ * thread only creates the objects, a worker thread then deserializes render data and mips into them before the game
+ * thread initializes their resources
+ */
+class MUTABLEEXTENSION_API FMutableDiskCacheRead final : public FGCObject
+{
+public:
+	FMutableDiskCacheRead(const UCustomizableObject* CustomizableObject, uint64 DescriptorHash);
+
+	/** Waits for any worker thread still filling the objects being created */
+	virtual ~FMutableDiskCacheRead() override;
+
+	/**
+	 * Advance the read, on the game thread
+	 * @return True once complete
+	 */
+	bool Tick();
+
+	bool IsComplete() const { return Phase == EPhase::Complete; }
+
+	EMutableDiskCacheRead GetResult() const { return Result; }
+
+	/** Generated mesh by component index, on a hit */
+	const TMap<int32, USkeletalMesh*>& GetMeshes() const { return Meshes; }
+
+	int64 GetBytesRead() const { return BytesRead; }
+
+	/** Time spent by Tick() creating objects and initializing their resources */
+	double GetGameThreadTime() const { return GameThreadTime; }
+
+	// Begin FGCObject
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FMutableDiskCacheRead"); }
+	// ~End FGCObject
+
+private:
+	enum class EPhase : uint8
+	{
+		Decode,
+		LoadAssets,
+		Deserialize,
+		Complete,
+	};
+
+	struct FState;
+	TUniquePtr<FState> State;
+
+	EPhase Phase = EPhase::Decode;
+	EMutableDiskCacheRead Result = EMutableDiskCacheRead::Missing;
+	TMap<int32, USkeletalMesh*> Meshes;
+	int64 BytesRead = 0;
+	double GameThreadTime = 0.0;
+
+	UE::Tasks::FTask Task;
+	TSharedPtr<FStreamableHandle> LoadHandle;
+
+	void Complete(EMutableDiskCacheRead InResult);
+
+	/** Create every object of the entry once its assets are loaded, their contents are filled on a worker thread */
+	bool CreateObjects();
+
+	/** Initialize the resources of everything the worker thread filled */
+	bool InitResources();
+};
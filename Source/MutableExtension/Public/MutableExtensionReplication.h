@@ -0,0 +1,179 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "MutableExtensionReplication.generated.h"
+
+class UCustomizableObjectInstance;
+class UMutableExtensionComponent;
+struct FMutableReplicatedDescriptor;
+
+/** Parameter types that can be replicated, anything else (textures, projectors) is left to gameplay code */
+enum class EMutableReplicatedParameterType : uint8
+{
+	Bool,
+	Int,
+	Float,
+	Color,
+};
+
+/** How float and color parameters are replicated, see UMutableExtensionComponent::ReplicationPrecision */
+UENUM(BlueprintType)
+enum class EMutableReplicationPrecision : uint8
+{
+	Lossless		UMETA(ToolTip="Floats and colors are replicated exactly, 32 bits per float and per color channel"),
+	Quantized		UMETA(ToolTip="Floats are replicated at 16 bit half precision and colors at 8 bits per channel, clamped to [0,1]"),
+};
+
+/**
+ * A single bit-packed parameter of one replicated instance
+ * Parameters are identified by index into the Customizable Object, so both ends must use the same compiled object
+ * The precision is sent with each float and color, so receivers never need to match the sender's settings
+ *
+ * Encoding:
+ *   Bool	1 bit
+ *   Int	Packed option index
+ *   Float	1 bit precision, then 32 bit float, or 16 bit half precision when quantized
+ *   Color	1 bit precision, then 4 x 32 bit float RGBA, or 32 bit RGBA at 8 bits per channel clamped to [0,1] when quantized
+ */
+USTRUCT()
+struct MUTABLEEXTENSION_API FMutableReplicatedParameter : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** Index into the extension component's initializing components */
+	uint16 ComponentIndex = 0;
+
+	/** Index into the Customizable Object's parameters */
+	uint16 ParameterIndex = 0;
+
+	EMutableReplicatedParameterType Type = EMutableReplicatedParameterType::Bool;
+
+	/** Float and color only, Value holds the quantized value */
+	bool bQuantized = false;
+
+	/** Bool, int and float value, or quantized color, see the encoding above */
+	uint32 Value = 0;
+
+	/** Color value when not quantized */
+	FLinearColor Color = FLinearColor::Transparent;
+
+	bool HasSameValue(const FMutableReplicatedParameter& Other) const
+	{
+		return Type == Other.Type && bQuantized == Other.bQuantized && Value == Other.Value && Color == Other.Color;
+	}
+
+	/** Key into FMutableReplicatedDescriptor, unique per component and parameter */
+	uint32 GetKey() const { return (static_cast<uint32>(ComponentIndex) << 16) | ParameterIndex; }
+
+	/**
+	 * Read the current value of a parameter
+	 * @return False if the parameter type is not replicated
+	 */
+	bool Capture(const UCustomizableObjectInstance* Instance, int32 InParameterIndex,
+		EMutableReplicationPrecision Precision = EMutableReplicationPrecision::Lossless);
+
+	/** Set the parameter on the instance, which should then be updated */
+	void Apply(UCustomizableObjectInstance* Instance) const;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FMutableReplicatedParameter> : public TStructOpsTypeTraitsBase2<FMutableReplicatedParameter>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * Descriptors of every component a UMutableExtensionComponent initialized, replicated one parameter at a time so that
+ * only parameters that changed are sent
+ */
+USTRUCT()
+struct MUTABLEEXTENSION_API FMutableReplicatedDescriptor : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FMutableReplicatedParameter> Parameters;
+
+	/** Receives replicated parameters */
+	UMutableExtensionComponent* Owner = nullptr;
+
+	/**
+	 * Mark every parameter of Instance that changed since it was last captured
+	 * @return Number of parameters that changed
+	 */
+	int32 Capture(const UCustomizableObjectInstance* Instance, int32 ComponentIndex, int64& OutNumBits,
+		EMutableReplicationPrecision Precision = EMutableReplicationPrecision::Lossless);
+
+	/** Forget every captured parameter, the next captures replicate the whole descriptor again */
+	void Reset();
+
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize);
+	void PostReplicatedChange(const TArrayView<int32>& ChangedIndices, int32 FinalSize);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FastArrayDeltaSerialize<FMutableReplicatedParameter, FMutableReplicatedDescriptor>(Parameters, DeltaParms, *this);
+	}
+
+private:
+	/** Index of each parameter by FMutableReplicatedParameter::GetKey(), authority only */
+	TMap<uint32, int32> ParameterIndices;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMutableReplicatedDescriptor> : public TStructOpsTypeTraitsBase2<FMutableReplicatedDescriptor>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/** Bandwidth and latency of descriptor replication, see UMutableExtensionComponent::bReplicateDescriptors */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableReplicationStats
+{
+	GENERATED_BODY()
+
+	/** Authority: captures that changed at least one parameter */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumChangesSent = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumParametersSent = 0;
+
+	/** Authority: payload of every changed parameter, excluding the fast array's own per item header */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 TotalBitsSent = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float AverageBitsPerChange = 0.f;
+
+	/** Client: replication callbacks that changed at least one parameter */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumChangesReceived = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumParametersReceived = 0;
+
+	/** Client: runtime updates completed because of replicated parameters */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumUpdatesApplied = 0;
+
+	/** Client: seconds from receiving parameters until the runtime update listeners were called */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float AverageApplyLatency = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float MaxApplyLatency = 0.f;
+
+	double TotalApplyLatency = 0.0;
+};
@@ -0,0 +1,45 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCustomizableSkeletalComponent;
+class UMutableExtensionComponent;
+struct FMutableSnapshotStats;
+
+/**
+ * Descriptors of every UMutableExtensionComponent in a world, in one versioned binary blob for save games and server
+ * migration. Actors are matched by UMutableExtensionComponent::GetSnapshotId() and components by name
+ *
+ * Layout, all counts and indices packed:
+ *   Header			Magic and format version
+ *   Strings		Every object path, parameter name, option, actor id and component name, once
+ *   Objects		Customizable Objects, as string indices
+ *   Parameters		Every distinct name, type and value, shared by all descriptors
+ *   Descriptors	Every distinct set of parameters, sorted and delta encoded indices into Parameters, each size prefixed
+ *					so they can be decoded in parallel
+ *   Actors			Snapshot id, then each component's name and descriptor
+ *
+ * Bool, int, float and color parameters are stored without loss. Texture and projector parameters are left to
+ * gameplay code, the same as with descriptor replication
+ */
+struct MUTABLEEXTENSION_API FMutableWorldSnapshot
+{
+	static constexpr uint32 FormatVersion = 1;
+
+	/**
+	 * Encode the descriptors of every component in World that requested initialization
+	 * @return False if there was nothing to save
+	 */
+	static bool Save(const UWorld* World, TArray<uint8>& OutData, FMutableSnapshotStats& OutStats);
+
+	/**
+	 * Decode, and check every parameter against the Customizable Objects in the world, on worker threads, then set the
+	 * parameters of every matching component's instance on the game thread
+	 * @param OutRestored Components whose instances were changed, by the extension component that should initialize them
+	 * @return False if the data is not a snapshot of this format version
+	 */
+	static bool Apply(const UWorld* World, const TArray<uint8>& Data,
+		TMap<UMutableExtensionComponent*, TArray<UCustomizableSkeletalComponent*>>& OutRestored, FMutableSnapshotStats& OutStats);
+};
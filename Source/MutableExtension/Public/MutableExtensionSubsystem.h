@@ -0,0 +1,694 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MutableExtensionComponent.h"
+#include "MutableExtensionDiskCache.h"
+#include "MutableExtensionTypes.h"
+#include "Containers/MpscQueue.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MuCO/CustomizableObjectInstance.h"
+#include "UObject/ObjectKey.h"
+#include "MutableExtensionSubsystem.generated.h"
+
+enum class EUpdateResult : uint8;
+struct FUpdateContext;
+class UCustomizableObjectInstance;
+class UCustomizableSkeletalComponent;
+
+struct FMutableScheduledUpdate;
+
+DECLARE_DELEGATE_OneParam(FOnMutableScheduledUpdateCompleted, const FMutableScheduledUpdate& /* Update */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMutableInstanceTimedOut, UCustomizableObjectInstance* /* Instance */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMutablePrewarmProgress, const FMutablePrewarmProgress& /* Progress */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMutableWorldSnapshotRestored, const FMutableSnapshotStats& /* Stats */);
+DECLARE_DELEGATE_TwoParams(FOnMutableDiskCacheRead, EMutableDiskCacheRead /* Result */, const TMap<int32, USkeletalMesh*>& /* Meshes */);
+
+/** An update waiting on, or being processed by, UMutableExtensionSubsystem */
+struct MUTABLEEXTENSION_API FMutableScheduledUpdate
+{
+	FMutableScheduledUpdate(
+	UCustomizableSkeletalComponent* InMutableComponent = nullptr,
+	const FOnMutableScheduledUpdateCompleted& InOnCompleted = FOnMutableScheduledUpdateCompleted(),
+	bool bInIgnoreCloseDist = false,
+	bool bInForceHighPriority = false);
+
+	TWeakObjectPtr<UCustomizableObjectInstance> MutableInstance;
+	TWeakObjectPtr<UCustomizableSkeletalComponent> MutableComponent;
+
+	FOnMutableScheduledUpdateCompleted OnCompleted;
+
+	bool bIgnoreCloseDist;
+	bool bForceHighPriority;
+
+	/** First generation of the instance, the component may not be ready to update yet */
+	bool bInitialization;
+
+	/** Dispatched to the instance rather than through the component, which doesn't have to be valid to update */
+	bool bByInstance;
+
+	/** Nobody is waiting on it to become visible, scored by MutableExtension.Scheduler.BackgroundPriorityScale */
+	bool bBackground;
+
+	/** Significance score, rescored every tick while queued. Higher is dispatched first */
+	float Priority;
+
+	/** Hash of the descriptor at the time it was dispatched to Mutable */
+	uint64 DescriptorHash;
+
+	/** Result reported by Mutable, only valid once completed */
+	EUpdateResult UpdateResult;
+
+	/** Number of times this update has been retried after stalling or being discarded */
+	int32 Attempt;
+
+	/**
+	 * Unique to each dispatch to Mutable. A stalled attempt can still complete after it was retried, its completion
+	 * carries the id it was dispatched with and is ignored
+	 */
+	uint32 DispatchId;
+
+	/** Mutable never completed the update within MutableExtension.Scheduler.Timeout, on every attempt */
+	bool bTimedOut;
+
+	/** Cancelled while in flight, Mutable still completes it but nobody is told */
+	bool bAbandoned;
+
+	/** Not dispatched again before this time, while backing off between attempts */
+	double RetryTime;
+
+	/** When it was first queued, retries keep it so they have already aged and aren't starved */
+	double EnqueueTime;
+
+	/** When the latest retry was queued, its wait is recorded separately from first attempts */
+	double RequeueTime;
+
+	double DispatchTime;
+	double CompleteTime;
+};
+
+/** A request made off the game thread, see UMutableExtensionSubsystem::SubmitRuntimeUpdate() */
+struct MUTABLEEXTENSION_API FMutableThreadedRequest
+{
+	TWeakObjectPtr<UMutableExtensionComponent> ExtensionComponent;
+
+	/** Runtime update only */
+	TWeakObjectPtr<USkeletalMeshComponent> OwningComponent;
+	TWeakObjectPtr<UCustomizableSkeletalComponent> MutableComponent;
+	bool bIgnoreCloseDist = false;
+	bool bForceHighPriority = false;
+
+	/** Initialization only */
+	TArray<TWeakObjectPtr<UCustomizableSkeletalComponent>> InitializingComponents;
+	FOnMutableExtensionSimpleDelegate OnInitialized;
+	bool bInitialization = false;
+
+	double SubmitTime = 0.0;
+};
+
+/**
+ * Funnels Mutable updates from every UMutableExtensionComponent in the world through a single queue
+ * Prevents many characters updating on the same frame (round start, loadout reset) from hitching
+ *
+ * Each tick the queue is drained until either budget is exhausted:
+ *	MutableExtension.Scheduler.MaxInFlightUpdates	- Updates dispatched to Mutable that have not yet completed
+ *	MutableExtension.Scheduler.MaxDispatchMs		- Game thread time spent dispatching per tick
+ *
+ * Queued updates are rescored every tick by UMutableFunctionLib::GetUpdateSignificance() so the locally controlled pawn
+ * and large on-screen actors are dispatched before distant NPCs. Updates for actors that are off-screen for every local
+ * player can be held back by MutableExtension.Scheduler.DeferOffScreen
+ *
+ * Updates that Mutable doesn't complete within MutableExtension.Scheduler.Timeout, or that it discards, are retried
+ * with exponential backoff up to MutableExtension.Scheduler.MaxAttempts times, then completed with bTimedOut
+ *
+ * Systems running on worker threads can use SubmitRuntimeUpdate() and SubmitInitialization(), which are handed to their
+ * extension component in a single batch at the start of the next tick
+ *
+ * Completion is never called from within EnqueueUpdate(), even if Mutable completes synchronously
+ */
+UCLASS()
+class MUTABLEEXTENSION_API UMutableExtensionSubsystem final : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UMutableExtensionSubsystem* Get(const UWorld* World);
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	// Begin Scheduler
+
+	/** Must always call UMutableFunctionLib::IsMutableMeshValidToUpdate() beforehand */
+	void EnqueueUpdate(UCustomizableSkeletalComponent* MutableComponent, const FOnMutableScheduledUpdateCompleted& OnCompleted,
+		bool bIgnoreCloseDist = false, bool bForceHighPriority = false);
+
+	/**
+	 * Queue the first generation of an instance, which skips the validity checks of EnqueueUpdate()
+	 * @param MutableComponent Any component using the instance, used to score significance
+	 * @param RequestTime When initialization was requested, so the wait includes the tick before it was queued. 0 for now
+	 */
+	void EnqueueInitialization(UCustomizableObjectInstance* Instance, UCustomizableSkeletalComponent* MutableComponent,
+		const FOnMutableScheduledUpdateCompleted& OnCompleted, double RequestTime = 0.0);
+
+	/**
+	 * Queue the generation of a copy of MutableComponent's instance that no component uses, so Mutable has nothing to
+	 * bind the result to. Skips the validity checks of EnqueueUpdate() the same as EnqueueInitialization()
+	 * @see UMutableExtensionComponent::bDeferMeshSwap
+	 */
+	void EnqueueStagedUpdate(UCustomizableObjectInstance* Instance, UCustomizableSkeletalComponent* MutableComponent,
+		const FOnMutableScheduledUpdateCompleted& OnCompleted, bool bForceHighPriority);
+
+	/**
+	 * Queue a background generation, e.g. full detail of an instance that is already visible at lower detail
+	 * Skips the validity checks of EnqueueUpdate() the same as EnqueueInitialization(), but at lower priority
+	 */
+	void EnqueueRefinement(UCustomizableObjectInstance* Instance, UCustomizableSkeletalComponent* MutableComponent,
+		const FOnMutableScheduledUpdateCompleted& OnCompleted);
+
+	bool IsQueued(const UCustomizableObjectInstance* Instance) const;
+	bool IsInFlight(const UCustomizableObjectInstance* Instance) const;
+
+	/**
+	 * Stop every update for Instance, OnCompleted will not be called for any of them
+	 * Queued updates are removed before they reach Mutable. In-flight updates can't be stopped, they are abandoned and
+	 * the instance is not dispatched again until Mutable is done with it
+	 * Shared instances that others are still waiting on keep generating, for them
+	 * @return Number of queued updates that were removed
+	 */
+	int32 CancelUpdates(const UCustomizableObjectInstance* Instance);
+
+	/** Record a runtime update that was satisfied without going through the scheduler */
+	void NotifyUpdateSkippedUnchanged() { SchedulerStats.TotalSkippedUnchanged++; }
+
+	/** Record a pooled actor being parked and unparked, see UMutableExtensionComponent::ParkMutable() */
+	void NotifyParked() { PoolStats.NumParks++; }
+	void NotifyUnparked(int32 NumReused, int32 NumRegenerated) { PoolStats.RecordUnpark(NumReused, NumRegenerated); }
+
+	/** Pool reuse of every UMutableExtensionComponent in the world */
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	const FMutablePoolStats& GetPoolStats() const { return PoolStats; }
+
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	const FMutableExtensionSchedulerStats& GetSchedulerStats() const { return SchedulerStats; }
+
+	/**
+	 * Generation time of recent updates, to tune MutableExtension.Scheduler.Timeout against
+	 * @param Percentile 0-1, e.g. 0.99
+	 * @return Seconds
+	 */
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	float GetGenerationTimePercentile(float Percentile = 0.99f) const;
+
+	/**
+	 * Thread safe, may be called from any thread
+	 * Calls UMutableExtensionComponent::RuntimeUpdateMutableComponent() at the start of the next game thread tick
+	 * Failures are logged, listen to the extension component's completion delegates for the result
+	 */
+	void SubmitRuntimeUpdate(UMutableExtensionComponent* ExtensionComponent, USkeletalMeshComponent* OwningComponent,
+		UCustomizableSkeletalComponent* MutableComponent, bool bIgnoreCloseDist = false, bool bForceHighPriority = false);
+
+	/**
+	 * Thread safe, may be called from any thread
+	 * Calls UMutableExtensionComponent::RequestMutableInitialization() at the start of the next game thread tick
+	 * @param OnInitialized Bound to OnMutableInitialized, if bound
+	 */
+	void SubmitInitialization(UMutableExtensionComponent* ExtensionComponent,
+		const TArray<UCustomizableSkeletalComponent*>& MutableComponents,
+		const FOnMutableExtensionSimpleDelegate& OnInitialized = FOnMutableExtensionSimpleDelegate());
+
+	/**
+	 * Bind meshes staged by the extension component once their textures are streamed in
+	 * Spread across frames by MutableExtension.MeshSwap.MaxPerFrame
+	 * @param NewMaterials Materials of the staged mesh, prestreamed for MutableExtension.MeshSwap.PrestreamSeconds
+	 */
+	void EnqueueMeshSwap(UMutableExtensionComponent* ExtensionComponent, const TArray<UMaterialInterface*>& NewMaterials);
+
+	/** Broadcast when an update gives up after timing out, for anyone waiting on the instance outside the scheduler */
+	FOnMutableInstanceTimedOut OnInstanceTimedOut;
+
+private:
+	TArray<FMutableScheduledUpdate> QueuedUpdates;
+
+	/** Bounded by MaxInFlightUpdates, so a linear search is cheaper than hashing */
+	TArray<FMutableScheduledUpdate> InFlightUpdates;
+
+	/** @see FMutableScheduledUpdate::DispatchId */
+	uint32 LastDispatchId = 0;
+
+	FMutableExtensionSchedulerStats SchedulerStats;
+
+	FMutablePoolStats PoolStats;
+
+	static constexpr int32 NumRecentGenerationTimes = 256;
+
+	/** Lock free, producers on any thread and consumed once per tick by DrainThreadedRequests() */
+	TMpscQueue<FMutableThreadedRequest> ThreadedRequests;
+
+	void DrainThreadedRequests();
+
+	TArray<TWeakObjectPtr<UMutableExtensionComponent>> ComponentsPendingMeshSwap;
+
+	void ApplyMeshSwaps();
+
+	/** Ring buffer of recent generation times in seconds */
+	TArray<float> RecentGenerationTimes;
+	int32 NextGenerationTimeIndex = 0;
+
+	/** Local player view points, gathered once per tick */
+	TArray<FMutableViewPoint> ViewPoints;
+
+	/** Rescore and reorder the queue, most significant first */
+	void PrioritizeQueuedUpdates();
+
+	/** Retry or time out updates that Mutable has not completed within MutableExtension.Scheduler.Timeout */
+	void CheckInFlightTimeouts();
+
+	/** @return False if the update has no attempts remaining */
+	bool RetryUpdate(FMutableScheduledUpdate& Update);
+
+	void DispatchQueuedUpdates();
+	void DispatchUpdate(FMutableScheduledUpdate& Update);
+
+	void OnScheduledUpdateCompleted(const FUpdateContext& Result, uint32 DispatchId);
+
+	void CompleteUpdate(FMutableScheduledUpdate& Update);
+
+	// ~End Scheduler
+
+public:
+	// Begin Cache
+
+	/**
+	 * Find an instance generated (or currently generating) from an identical descriptor
+	 * Adds a reference that must be released with ReleaseCachedInstance()
+	 * @return Shared instance if it exists, otherwise nullptr
+	 */
+	UCustomizableObjectInstance* AcquireCachedInstance(uint64 DescriptorHash, bool& bGenerated);
+
+	/** Add an instance that is about to be generated, the caller holds the first reference */
+	void AddCachedInstance(uint64 DescriptorHash, UCustomizableObjectInstance* Instance, const TArray<uint8>& Descriptor);
+
+	/** Must be called by whoever added the instance once it has finished generating */
+	void OnCachedInstanceGenerated(UCustomizableObjectInstance* Instance, bool bSuccess, int64 SizeBytes);
+
+	void ReleaseCachedInstance(UCustomizableObjectInstance* Instance);
+
+	/** Remove regardless of references, e.g. when the only user is about to change it */
+	void RemoveCachedInstance(UCustomizableObjectInstance* Instance);
+
+	/** Revert a cached instance's parameters to the descriptor it was cached with */
+	void RestoreCachedInstanceDescriptor(UCustomizableObjectInstance* Instance);
+
+	bool IsCachedInstance(const UCustomizableObjectInstance* Instance) const { return CachedInstanceHashes.Contains(Instance); }
+	int32 GetCachedInstanceRefCount(const UCustomizableObjectInstance* Instance) const;
+
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	const FMutableExtensionCacheStats& GetCacheStats() const { return CacheStats; }
+
+	/**
+	 * UMutableFunctionLib::GetDescriptorHash(), only serializing the descriptor again once the instance's fingerprint
+	 * shows its parameters changed
+	 * @see UMutableFunctionLib::GetDescriptorFingerprint()
+	 */
+	uint64 GetDescriptorHash(UCustomizableObjectInstance* Instance);
+
+private:
+	struct FDescriptorHashEntry
+	{
+		uint64 Fingerprint = 0;
+		uint64 Hash = 0;
+	};
+
+	TMap<TObjectKey<UCustomizableObjectInstance>, FDescriptorHashEntry> DescriptorHashes;
+
+	UPROPERTY()
+	TMap<uint64, FMutableCachedInstance> CachedInstances;
+
+	TMap<const UCustomizableObjectInstance*, uint64> CachedInstanceHashes;
+
+	FMutableExtensionCacheStats CacheStats;
+
+	/** Evict the least recently used unreferenced entries until under MutableExtension.Cache.MaxSizeMB */
+	void TrimCache();
+
+	// ~End Cache
+
+public:
+	// Begin Prewarm
+
+	/**
+	 * Generate instances ahead of time, e.g. behind a loading screen, and keep them in the shared instance cache
+	 * RequestMutableInitialization() for an instance with a matching descriptor then shares the prewarmed instance
+	 * instead of generating it, even if bShareGeneratedInstances is false
+	 * @param MaxParallel Most prewarm generations queued with the scheduler at once, which still applies its own budgets
+	 * @return Number of instances that will be generated, descriptors that are already cached are skipped
+	 */
+	UFUNCTION(BlueprintCallable, Category="Mutable")
+	int32 PrewarmInstances(const TArray<FMutablePrewarmRequest>& Requests, int32 MaxParallel = 4);
+
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	const FMutablePrewarmProgress& GetPrewarmProgress() const { return PrewarmProgress; }
+
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	bool IsPrewarming() const { return !PrewarmProgress.IsComplete(); }
+
+	/** @return True if the descriptor was prewarmed and hasn't been released since */
+	bool IsPrewarmedDescriptor(uint64 DescriptorHash) const { return PrewarmedHashes.Contains(DescriptorHash); }
+
+	/**
+	 * Stop prewarming and drop the prewarm references, e.g. once the match has started
+	 * Prewarmed instances that nobody is using can then be evicted by MutableExtension.Cache.MaxSizeMB
+	 */
+	UFUNCTION(BlueprintCallable, Category="Mutable")
+	void ReleasePrewarmedInstances();
+
+	/** Broadcast whenever a prewarmed instance completes */
+	FOnMutablePrewarmProgress OnPrewarmProgress;
+
+private:
+	/** Every prewarmed instance we still hold a cache reference to */
+	UPROPERTY()
+	TArray<UCustomizableObjectInstance*> PrewarmedInstances;
+
+	/** Waiting for a parallel slot */
+	UPROPERTY()
+	TArray<UCustomizableObjectInstance*> PrewarmQueue;
+
+	TSet<const UCustomizableObjectInstance*> PrewarmInFlight;
+
+	/** Released while in flight, the reference is dropped once they complete */
+	TSet<const UCustomizableObjectInstance*> PrewarmReleasePending;
+
+	TSet<uint64> PrewarmedHashes;
+
+	/** Descriptor hash of every prewarmed instance, so it stops being reported once the instance fails or leaves the cache */
+	TMap<const UCustomizableObjectInstance*, uint64> PrewarmDescriptorHashes;
+
+	FMutablePrewarmProgress PrewarmProgress;
+
+	int32 MaxPrewarmParallel = 4;
+
+	void DispatchPrewarm();
+
+	void OnPrewarmUpdateCompleted(const FMutableScheduledUpdate& Update);
+
+	/** Called through OnCachedInstanceGenerated(), which is also how abandoned updates complete */
+	void CompletePrewarm(UCustomizableObjectInstance* Instance, bool bSuccess);
+
+	/** The instance is no longer cached, so its descriptor can't be shared as prewarmed */
+	void ForgetPrewarmedDescriptor(const UCustomizableObjectInstance* Instance);
+
+	// ~End Prewarm
+
+public:
+	// Begin Speculation
+
+	/**
+	 * Register likely next descriptors of an instance, e.g. the armor the player is hovering in the equipment UI
+	 * Candidates are generated one at a time, only while nothing else is queued. A runtime update whose descriptor
+	 * matches a generated candidate then swaps the candidate in instead of generating
+	 * @param Descriptors Serialized with UMutableFunctionLib::SaveDescriptor()
+	 * @return Number of candidates added, duplicates and the current descriptor are skipped
+	 */
+	int32 AddSpeculativeCandidates(UCustomizableObjectInstance* Instance, const TArray<TArray<uint8>>& Descriptors);
+
+	void ClearSpeculativeCandidates(const UCustomizableObjectInstance* Instance);
+
+	bool HasSpeculativeCandidates(const UCustomizableObjectInstance* Instance) const;
+
+	/**
+	 * Take ownership of the generated candidate matching the descriptor, the instance's remaining candidates move to it
+	 * Counts a miss if there is none
+	 * @return The candidate instance, nullptr if none is generated for this descriptor
+	 */
+	UCustomizableObjectInstance* TakeSpeculativeInstance(const UCustomizableObjectInstance* Instance, uint64 DescriptorHash);
+
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	const FMutableSpeculationStats& GetSpeculationStats() const { return SpeculationStats; }
+
+private:
+	UPROPERTY()
+	TArray<FMutableSpeculativeCandidate> SpeculativeCandidates;
+
+	TWeakObjectPtr<const UCustomizableObjectInstance> SpeculativeInFlight;
+
+	FMutableSpeculationStats SpeculationStats;
+
+	int32 FindSpeculativeCandidate(const UCustomizableObjectInstance* Instance, uint64 DescriptorHash) const;
+
+	void RemoveSpeculativeCandidate(int32 Index, bool bEvicted);
+
+	/** Queue the oldest candidate that isn't generated yet, if the scheduler has nothing else to do */
+	void DispatchSpeculation();
+
+	void OnSpeculativeUpdateCompleted(const FMutableScheduledUpdate& Update);
+
+	/** Evict the oldest generated candidates until they use no more than MaxBytes */
+	void TrimSpeculation(int64 MaxBytes);
+
+	// ~End Speculation
+
+public:
+	// Begin Disk Cache
+
+	/**
+	 * Recreate what a previous run generated for this Customizable Object and descriptor, instead of generating it
+	 * Read on worker threads and completed by Tick, see FMutableDiskCacheRead. Not called if the instance is destroyed
+	 * Mutable itself never generated the instance, so its first runtime update regenerates it from scratch
+	 * @return False if the disk cache is disabled, OnCompleted is then never called
+	 */
+	bool ReadDiskCache(UCustomizableObjectInstance* Instance, uint64 DescriptorHash, const FOnMutableDiskCacheRead& OnCompleted);
+
+	/**
+	 * Store what Mutable generated for the instance. Only gathered here, it is serialized and written on a worker thread
+	 * Ignored if already stored
+	 */
+	void WriteDiskCache(const UCustomizableObjectInstance* Instance, uint64 DescriptorHash);
+
+	/** @return True if the instance was recreated by ReadDiskCache() and hasn't been generated by Mutable since */
+	bool IsInstanceFromDiskCache(const UCustomizableObjectInstance* Instance) const { return DiskCachedInstances.Contains(Instance); }
+
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	const FMutableDiskCacheStats& GetDiskCacheStats() const { return DiskCacheStats; }
+
+private:
+	TSet<TObjectKey<UCustomizableObjectInstance>> DiskCachedInstances;
+
+	/** Entries written, or being written, by this world so each is only serialized once */
+	TSet<FString> DiskCacheWrites;
+
+	struct FPendingDiskCacheRead
+	{
+		TWeakObjectPtr<UCustomizableObjectInstance> Instance;
+		TUniquePtr<FMutableDiskCacheRead> Read;
+		FOnMutableDiskCacheRead OnCompleted;
+	};
+
+	TArray<FPendingDiskCacheRead> DiskCacheReads;
+
+	/** The entry holds the generated objects until the task has written them */
+	struct FPendingDiskCacheWrite
+	{
+		TSharedPtr<FMutableDiskCacheWrite> Entry;
+		UE::Tasks::TTask<FMutableDiskCacheWriteResult> Task;
+	};
+
+	TArray<FPendingDiskCacheWrite> DiskCacheWriteTasks;
+
+	/** Advance pending reads and count completed writes */
+	void TickDiskCache();
+
+	FMutableDiskCacheStats DiskCacheStats;
+
+	// ~End Disk Cache
+
+public:
+	// Begin Snapshot
+
+	/**
+	 * Encode the descriptors of every initialized UMutableExtensionComponent in the world, e.g. for a save game
+	 * @see FMutableWorldSnapshot
+	 * @return False if there was nothing to save
+	 */
+	bool SaveWorldSnapshot(TArray<uint8>& OutData);
+
+	/**
+	 * Set the descriptors of every actor in the snapshot and initialize them again, most significant first
+	 * This requests initialization for them, gameplay code should wait on OnWorldSnapshotRestored instead of requesting
+	 * it too. Actors that hadn't requested initialization yet initialize only the components in the snapshot
+	 * @return False if the data is not a snapshot of this format version
+	 */
+	bool RestoreWorldSnapshot(const TArray<uint8>& Data);
+
+	/** @return True while actors from the last RestoreWorldSnapshot() are still initializing */
+	bool IsRestoringWorldSnapshot() const { return SnapshotRestoringComponents.Num() > 0; }
+
+	/** Size and timing of the last snapshot saved or restored */
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	const FMutableSnapshotStats& GetSnapshotStats() const { return SnapshotStats; }
+
+	/** Broadcast once every actor from RestoreWorldSnapshot() has initialized */
+	FOnMutableWorldSnapshotRestored OnWorldSnapshotRestored;
+
+private:
+	TArray<TWeakObjectPtr<UMutableExtensionComponent>> SnapshotRestoringComponents;
+
+	double SnapshotRestoreTime = 0.0;
+
+	FMutableSnapshotStats SnapshotStats;
+
+	/** Broadcast OnWorldSnapshotRestored once the last restoring actor has initialized */
+	void CheckSnapshotRestored();
+
+	// ~End Snapshot
+
+public:
+	// Begin Registry
+
+	/** Track the component's mesh status, safe to call if already registered */
+	void RegisterComponent(UCustomizableSkeletalComponent* MutableComponent);
+	void UnregisterComponent(const UCustomizableSkeletalComponent* MutableComponent);
+
+	/** Refresh the status of a registered component, e.g. after it was assigned a different instance */
+	void UpdateRegisteredComponent(const UCustomizableSkeletalComponent* MutableComponent);
+
+	/** Refresh the status of every registered component using Instance, called when an update completes */
+	void UpdateRegisteredInstance(const UCustomizableObjectInstance* Instance);
+
+	bool IsRegistered(const UCustomizableSkeletalComponent* MutableComponent) const { return RegisteredIndices.Contains(MutableComponent); }
+
+	/** @return False if the component is not registered */
+	bool GetRegisteredStatus(const UCustomizableSkeletalComponent* MutableComponent, ESkeletalMeshStatus& OutStatus) const;
+
+	int32 GetNumRegisteredComponents() const { return RegisteredComponents.Num(); }
+
+	/** O(1) */
+	int32 GetNumRegisteredWithStatus(ESkeletalMeshStatus Status) const;
+
+	/** Linear scan of the status array, only touches components that match */
+	void GetRegisteredComponentsWithStatus(ESkeletalMeshStatus Status, TArray<UCustomizableSkeletalComponent*>& OutComponents) const;
+
+	/** Parallel arrays, the same index refers to the same component. Order changes when components unregister */
+	const TArray<TObjectKey<UCustomizableSkeletalComponent>>& GetRegisteredComponents() const { return RegisteredComponents; }
+	const TArray<ESkeletalMeshStatus>& GetRegisteredStatuses() const { return RegisteredStatuses; }
+
+private:
+	static constexpr int32 NumMeshStatuses = static_cast<int32>(ESkeletalMeshStatus::Error) + 1;
+
+	/** Structure of arrays so bulk queries scan contiguous statuses without touching the components */
+	TArray<TObjectKey<UCustomizableSkeletalComponent>> RegisteredComponents;
+	TArray<TObjectKey<UCustomizableObjectInstance>> RegisteredInstances;
+	TArray<ESkeletalMeshStatus> RegisteredStatuses;
+
+	TMap<TObjectKey<UCustomizableSkeletalComponent>, int32> RegisteredIndices;
+
+	int32 RegisteredStatusCounts[NumMeshStatuses] = {};
+
+	void SetRegisteredStatus(int32 Index, ESkeletalMeshStatus Status);
+
+	// ~End Registry
+
+public:
+	// Begin Memory Budget
+
+	/** @return Memory accounted to a registered instance when it last completed an update, nullptr if never updated */
+	const FMutableInstanceMemory* GetInstanceMemory(const UCustomizableObjectInstance* Instance) const { return InstanceMemory.Find(Instance); }
+
+	const TMap<TObjectKey<UCustomizableObjectInstance>, FMutableInstanceMemory>& GetInstanceMemories() const { return InstanceMemory; }
+
+	bool IsInstanceReleased(const UCustomizableObjectInstance* Instance) const;
+
+	/**
+	 * Release everything generated for the instance, its components are given the Customizable Object's reference mesh
+	 * Mutable keeps what it generated for as long as the instance lives, so its components and subscribers move to a copy
+	 * holding only the descriptor and the original is left to garbage collection
+	 * Ignored for instances that are shared, queued or in flight
+	 * @return The copy the components now use, nullptr if not released
+	 */
+	UCustomizableObjectInstance* ReleaseInstanceResources(UCustomizableObjectInstance* Instance);
+
+	/**
+	 * Regenerate a released instance through the scheduler
+	 * @return True if it was released
+	 */
+	bool RestoreInstanceResources(UCustomizableObjectInstance* Instance);
+
+	UFUNCTION(BlueprintPure, Category="Mutable")
+	const FMutableExtensionMemoryStats& GetMemoryStats() const { return MemoryStats; }
+
+private:
+	TMap<TObjectKey<UCustomizableObjectInstance>, FMutableInstanceMemory> InstanceMemory;
+
+	FMutableExtensionMemoryStats MemoryStats;
+
+	double NextMemoryCheckTime = 0.0;
+
+	void AccountInstanceMemory(const UCustomizableObjectInstance* Instance, const USkeletalMeshComponent* MeshComponent);
+
+	/** Stop accounting for the instance, none of our components use it anymore */
+	void RemoveInstanceMemory(TObjectKey<UCustomizableObjectInstance> Instance);
+
+	/** Remove instances no longer registered, or since replaced by sharing */
+	void PruneInstanceMemory();
+
+	/** Stop tracking a released instance, it is being regenerated */
+	bool ClearInstanceReleased(const UCustomizableObjectInstance* Instance);
+
+	/**
+	 * Restore released instances that became significant, then release the least significant until under
+	 * MutableExtension.Memory.BudgetMB
+	 */
+	void EnforceMemoryBudget();
+
+	void OnInstanceRestored(const FMutableScheduledUpdate& Update);
+
+	// ~End Memory Budget
+
+public:
+	// Begin Benchmark
+
+	/**
+	 * Start capturing frame and initialization times for the benchmark results. Nothing is captured otherwise, and
+	 * capture compiles out of Shipping
+	 * Console: MutableExtension.Benchmark.Reset
+	 */
+	void ResetBenchmark();
+
+	/**
+	 * Stop capturing and write everything captured since ResetBenchmark() as JSON, for headless runs (-nullrhi)
+	 * Console: MutableExtension.Benchmark.Write [Filename]
+	 * @param Filename Defaults to Saved/MutableExtension/Benchmark-<Timestamp>.json
+	 * @return True if the file was written
+	 */
+	bool WriteBenchmark(FString Filename = TEXT(""));
+
+	bool IsCapturingBenchmark() const { return bBenchmarkCapturing; }
+
+	/** Record the time a UMutableExtensionComponent took from RequestMutableInitialization() to HasMutableInitialized() */
+	void NotifyInitializationCompleted(float Seconds);
+
+private:
+	bool bBenchmarkCapturing = false;
+
+	double BenchmarkStartTime = 0.0;
+	int32 BenchmarkStartCompleted = 0;
+
+	/** Process memory when capture began and the most it reached since, sampled once per frame */
+	uint64 BenchmarkStartUsedPhysical = 0;
+	uint64 BenchmarkPeakUsedPhysical = 0;
+
+	/** Ring buffers, see MutableExtension.Benchmark.MaxInitializations and MutableExtension.Benchmark.MaxFrames */
+	TArray<float> BenchmarkInitializationTimes;
+	TArray<float> BenchmarkFrameTimes;
+	int32 NextBenchmarkInitialization = 0;
+	int32 NextBenchmarkFrame = 0;
+
+	// ~End Benchmark
+};
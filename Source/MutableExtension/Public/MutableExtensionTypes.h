@@ -7,8 +7,11 @@
 #include "MutableExtensionTypes.generated.h"
 
 enum class EUpdateResult : uint8;
+class UCustomizableObject;
 class UCustomizableSkeletalComponent;
 class UCustomizableObjectInstance;
+class UMaterialInterface;
+class USkeletalMesh;
 
 UENUM(BlueprintType)
 enum class EMutableExtensionRuntimeUpdateError : uint8
@@ -17,6 +20,37 @@ enum class EMutableExtensionRuntimeUpdateError : uint8
 	DelegateNotBound,
 	AlreadyPendingUpdate,
 	MeshNotValidToUpdate,
+	SchedulerUnavailable,
+};
+
+/** When runtime update completions are delivered to listeners */
+UENUM(BlueprintType)
+enum class EMutableExtensionCompletionDelivery : uint8
+{
+	Immediate			UMETA(ToolTip="Listeners are called as soon as a generated update completes. Outcomes decided without generating, such as Unchanged, Cancelled or Rejected, are always delivered at the end of the frame so never before the request returns"),
+	EndOfFrame			UMETA(ToolTip="Listeners are called at the end of the frame the update completed in"),
+};
+
+/** How a runtime update was satisfied */
+UENUM(BlueprintType)
+enum class EMutableExtensionUpdateOutcome : uint8
+{
+	Generated,
+	Unchanged			UMETA(ToolTip="Descriptor matched the last successful update so Mutable was skipped"),
+	TimedOut			UMETA(ToolTip="Mutable didn't complete the update on any attempt, see MutableExtension.Scheduler.Timeout"),
+	Cancelled			UMETA(ToolTip="Cancelled or superseded by a newer request before it completed"),
+	Speculated			UMETA(ToolTip="Swapped for an instance generated ahead of time, see UMutableExtensionSubsystem::AddSpeculativeCandidates()"),
+	ServerSkipped		UMETA(ToolTip="Nothing is rendered on a dedicated server so Mutable was skipped, see UMutableExtensionComponent::DedicatedServerGeneration"),
+	Rejected			UMETA(ToolTip="Collected by a parameter transaction but couldn't be submitted when it was committed"),
+};
+
+/** What a dedicated server generates */
+UENUM(BlueprintType)
+enum class EMutableExtensionServerGeneration : uint8
+{
+	Generate			UMETA(ToolTip="Generate the same as a client would"),
+	Skip				UMETA(ToolTip="Never generate, initialization and runtime updates complete immediately"),
+	ReferenceMesh		UMETA(ToolTip="Never generate, but give the owning mesh component the Customizable Object's reference skeletal mesh so its skeleton and physics asset are available for physics and hit detection"),
 };
 
 USTRUCT(BlueprintType)
@@ -31,6 +65,9 @@ struct MUTABLEEXTENSION_API FMutablePendingRuntimeUpdate
 
 	UPROPERTY(BlueprintReadOnly, Category="Mutable")
 	EUpdateResult UpdateResult;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	EMutableExtensionUpdateOutcome Outcome;
 	
 	UPROPERTY(BlueprintReadOnly, Category="Mutable")
 	UCustomizableObjectInstance* MutableInstance;
@@ -40,4 +77,587 @@ struct MUTABLEEXTENSION_API FMutablePendingRuntimeUpdate
 
 	UPROPERTY(BlueprintReadOnly, Category="Mutable")
 	USkeletalMeshComponent* OwningComponent;
+
+	/** Number of RuntimeUpdateMutableComponent() calls satisfied by this update, greater than 1 if requests were coalesced */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumRequests;
+
+	/** When Mutable reported the result, used to measure how long listeners waited to be told */
+	double CompletedTime;
+
+	/** A coalesced request arrived after this update was dispatched, so the result is stale and a follow-up is required */
+	bool bDirty;
+	bool bFollowUpIgnoreCloseDist;
+	bool bFollowUpForceHighPriority;
+};
+
+/**
+ * A runtime update generated into a copy of a component's instance, held back from the skeletal mesh component until it
+ * is ready to replace the bound mesh. No component uses the copy, so Mutable has nothing to bind its meshes to
+ */
+USTRUCT()
+struct MUTABLEEXTENSION_API FMutableMeshSwap
+{
+	GENERATED_BODY()
+
+	/** Requested the runtime update, its instance is replaced by StagedInstance once swapped */
+	UPROPERTY()
+	UCustomizableSkeletalComponent* MutableComponent = nullptr;
+
+	/** Copy of the component's instance that Mutable is generating, nullptr if none is in flight */
+	UPROPERTY()
+	UCustomizableObjectInstance* GeneratingInstance = nullptr;
+
+	/** Generated copy waiting to replace the component's instance, nullptr until a runtime update completes */
+	UPROPERTY()
+	UCustomizableObjectInstance* StagedInstance = nullptr;
+
+	/** Generated for the component by StagedInstance */
+	UPROPERTY()
+	USkeletalMesh* NewMesh = nullptr;
+
+	/** Every material used by the new mesh, their textures must be streamed in before swapping */
+	UPROPERTY()
+	TArray<UMaterialInterface*> NewMaterials;
+
+	/** Delivered to listeners once the new mesh is bound */
+	UPROPERTY()
+	TArray<FMutablePendingRuntimeUpdate> Completions;
+
+	double StagedTime = 0.0;
+
+	bool IsStaged() const { return StagedInstance != nullptr; }
+};
+
+/** A local player's point of view, gathered once per tick to score the significance of pending updates */
+struct MUTABLEEXTENSION_API FMutableViewPoint
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+
+	/** Half of the horizontal field of view, in radians */
+	float HalfFOV = UE_HALF_PI * 0.5f;
+};
+
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableInstanceInitializationTiming
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	UCustomizableObjectInstance* Instance = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	bool bSuccess = false;
+
+	/** Seconds from RequestMutableInitialization() until this instance completed */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float Latency = 0.f;
+
+	/** Seconds from being dispatched to Mutable until this instance completed, 0 if it was never dispatched */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float GenerationTime = 0.f;
+
+	/** Mutable never completed the generation, see MutableExtension.Scheduler.Timeout */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	bool bTimedOut = false;
+};
+
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableInitializationStats
+{
+	GENERATED_BODY()
+
+	/** In order of completion */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	TArray<FMutableInstanceInitializationTiming> Instances;
+
+	/** The last instance to complete, which held up OnMutableInitialized */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	UCustomizableObjectInstance* CriticalPathInstance = nullptr;
+
+	/** Seconds from RequestMutableInitialization() until OnMutableInitialized, i.e. time to first visible */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float TotalTime = 0.f;
+
+	/**
+	 * Seconds from RequestMutableInitialization() until every instance was generated at full detail
+	 * Equal to TotalTime unless UMutableExtensionComponent::bProgressiveInitialization is enabled
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float TimeToFullQuality = 0.f;
+
+	double RequestTime = 0.0;
+};
+
+/** Runtime update requests for a single instance, collected during a parameter transaction */
+USTRUCT()
+struct MUTABLEEXTENSION_API FMutableTransactionUpdate
+{
+	GENERATED_BODY()
+
+	/** Most recent component to request an update for the instance */
+	UPROPERTY()
+	UCustomizableSkeletalComponent* MutableComponent = nullptr;
+
+	UPROPERTY()
+	USkeletalMeshComponent* OwningComponent = nullptr;
+
+	int32 NumRequests = 0;
+	bool bIgnoreCloseDist = false;
+	bool bForceHighPriority = false;
+};
+
+/** Counters exposed by UMutableExtensionSubsystem for tuning the update budget */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableExtensionSchedulerStats
+{
+	GENERATED_BODY()
+
+	/** Updates waiting to be dispatched to Mutable */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 QueueDepth = 0;
+
+	/** Highest QueueDepth seen since the subsystem was created */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 PeakQueueDepth = 0;
+
+	/** Updates dispatched to Mutable that have not yet completed */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumInFlight = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalDispatched = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalCompleted = 0;
+
+	/** Updates dispatched during the most recent tick */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 LastFrameDispatched = 0;
+
+	/** Game thread time spent dispatching during the most recent tick */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float LastFrameDispatchMs = 0.f;
+
+	/** Average time between an update being queued and dispatched, in seconds */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float AverageWaitTime = 0.f;
+
+	/** Longest time between an update being queued and dispatched, in seconds */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float MaxWaitTime = 0.f;
+
+	/** Runtime updates that completed immediately because their descriptor had not changed */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalSkippedUnchanged = 0;
+
+	/** Queued updates held back during the most recent tick because their actor was off-screen */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumDeferredOffScreen = 0;
+
+	/** Times an in-flight update exceeded MutableExtension.Scheduler.Timeout */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalStalled = 0;
+
+	/** Updates dispatched again after stalling or being discarded by Mutable */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalRetried = 0;
+
+	/** Average time between a retry being queued and dispatched, in seconds. Not included in AverageWaitTime */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float AverageRetryWaitTime = 0.f;
+
+	/** Longest time between a retry being queued and dispatched, in seconds. Not included in MaxWaitTime */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float MaxRetryWaitTime = 0.f;
+
+	/** Completions of a stalled attempt that arrived after it was retried or timed out, and were ignored */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalLateCompletions = 0;
+
+	/** Updates that ran out of attempts and completed with bTimedOut */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalTimedOut = 0;
+
+	/** Longest time Mutable took to complete an update, in seconds */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float MaxGenerationTime = 0.f;
+
+	/** Queued updates removed before they were dispatched to Mutable */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalCancelled = 0;
+
+	/** In-flight updates whose result was thrown away */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalAbandoned = 0;
+
+	/** Generation time not spent on cancelled updates, estimated from the median of recent generation times */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float EstimatedSavedMs = 0.f;
+
+	/** Generated meshes bound after waiting for their textures to stream in */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalMeshSwaps = 0;
+
+	/** Generated meshes bound during the most recent tick */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 LastFrameMeshSwaps = 0;
+
+	/** Requests submitted from other threads and handed to their extension component */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalThreadedRequests = 0;
+
+	/** Threaded requests handed over during the most recent tick */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 LastFrameThreadedRequests = 0;
+
+	/** Average time between a threaded request being submitted and handed over on the game thread, in seconds */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float AverageThreadedLatency = 0.f;
+
+	/** Longest time between a threaded request being submitted and handed over on the game thread, in seconds */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float MaxThreadedLatency = 0.f;
+
+	/** Accumulated wait used to compute AverageWaitTime */
+	double TotalWaitTime = 0.0;
+
+	/** Accumulated wait and number of dispatched retries used to compute AverageRetryWaitTime */
+	double TotalRetryWaitTime = 0.0;
+	int32 TotalRetriesDispatched = 0;
+
+	/** Accumulated latency used to compute AverageThreadedLatency */
+	double TotalThreadedLatency = 0.0;
+};
+
+/** An instance shared between every component whose descriptor hashes identically */
+USTRUCT()
+struct MUTABLEEXTENSION_API FMutableCachedInstance
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UCustomizableObjectInstance* Instance = nullptr;
+
+	/** Descriptor the instance was cached with, used to restore it if a user modifies it */
+	TArray<uint8> Descriptor;
+
+	/** Number of UMutableExtensionComponents using this instance */
+	int32 RefCount = 0;
+
+	/** Estimated size of the generated meshes and textures */
+	int64 SizeBytes = 0;
+
+	double LastUsedTime = 0.0;
+
+	/** False while the first user is still generating it */
+	bool bGenerated = false;
+};
+
+/** A likely next descriptor of an instance, generated while the scheduler is idle */
+USTRUCT()
+struct MUTABLEEXTENSION_API FMutableSpeculativeCandidate
+{
+	GENERATED_BODY()
+
+	/** Generated with the candidate descriptor, replaces SourceInstance if committed */
+	UPROPERTY()
+	UCustomizableObjectInstance* Instance = nullptr;
+
+	TWeakObjectPtr<UCustomizableObjectInstance> SourceInstance;
+
+	uint64 DescriptorHash = 0;
+
+	/** Estimated size of the generated meshes and textures */
+	int64 SizeBytes = 0;
+
+	float GenerationTime = 0.f;
+
+	double RegisterTime = 0.0;
+
+	bool bGenerated = false;
+};
+
+/** Counters exposed by UMutableExtensionSubsystem for speculative generation */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableSpeculationStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumCandidates = 0;
+
+	/** Generated and ready to be committed */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumReady = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 SizeBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalRegistered = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalGenerated = 0;
+
+	/** Runtime updates that were satisfied by a generated candidate */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Hits = 0;
+
+	/** Runtime updates for instances with candidates, that none of them satisfied */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Misses = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float HitRate = 0.f;
+
+	/** Generated candidates that were discarded without ever being committed */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalWasted = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float WastedGenerationMs = 0.f;
+
+	/** Generated candidates discarded for MutableExtension.Speculation.MaxMB or the memory budget */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalEvicted = 0;
+};
+
+/** Counters exposed by UMutableExtensionSubsystem for the shared instance cache */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableExtensionCacheStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Hits = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Misses = 0;
+
+	/** Unreferenced entries removed to stay under MutableExtension.Cache.MaxSizeMB */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Evictions = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumEntries = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 SizeBytes = 0;
+};
+
+/** Counters exposed by UMutableExtensionSubsystem for the persistent disk cache, see FMutableExtensionDiskCache */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableDiskCacheStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Hits = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Misses = 0;
+
+	/** Entries that exist but were written for another compilation of the object, or couldn't be read */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Rejected = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Writes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 BytesRead = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 BytesWritten = 0;
+
+	/** Least recently used entries deleted for MutableExtension.DiskCache.MaxMB */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 Evictions = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 EvictedBytes = 0;
+
+	/** Time spent on the game thread creating meshes, materials and textures, everything else is read on worker threads */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float ReadTimeMs = 0.f;
+};
+
+/** Reuse of generated instances by pooled actors, see UMutableExtensionComponent::ParkMutable() */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutablePoolStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumParks = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumUnparks = 0;
+
+	/** Unparks that reused every instance without generating anything */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumFullReuses = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumInstancesReused = 0;
+
+	/** Instances whose descriptor changed while parked, or that were released by the memory budget */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumInstancesRegenerated = 0;
+
+	/** Fraction of unparked instances that were reused */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float HitRate = 0.f;
+
+	void RecordUnpark(int32 NumReused, int32 NumRegenerated)
+	{
+		NumUnparks++;
+		NumFullReuses += NumRegenerated == 0 ? 1 : 0;
+		NumInstancesReused += NumReused;
+		NumInstancesRegenerated += NumRegenerated;
+		HitRate = static_cast<float>(NumInstancesReused) / FMath::Max(1, NumInstancesReused + NumInstancesRegenerated);
+	}
+};
+
+/** Size and timing of the last world snapshot saved or restored, see FMutableWorldSnapshot */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableSnapshotStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 SizeBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumActors = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumInstances = 0;
+
+	/** Instances with identical descriptors are stored once */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumUniqueDescriptors = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumUniqueParameters = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumStrings = 0;
+
+	/** Actors or components in the snapshot that are not in the world, or have a different Customizable Object */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumUnmatched = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float EncodeTimeMs = 0.f;
+
+	/** Decoding on worker threads and setting parameters on the game thread */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float DecodeTimeMs = 0.f;
+
+	/** From restoring until every restored actor has initialized, 0 while still pending */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float RestoreToReadyTime = 0.f;
+};
+
+/** A Customizable Object and descriptor to generate ahead of time, see UMutableExtensionSubsystem::PrewarmInstances() */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutablePrewarmRequest
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	UCustomizableObject* CustomizableObject = nullptr;
+
+	/** Serialized with UMutableFunctionLib::SaveDescriptor(), empty for the object's default parameters */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mutable")
+	TArray<uint8> Descriptor;
+};
+
+/** Progress of UMutableExtensionSubsystem::PrewarmInstances(), e.g. for a loading bar */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutablePrewarmProgress
+{
+	GENERATED_BODY()
+
+	/** Unique descriptors that are being generated, across every call since prewarming last finished */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumRequested = 0;
+
+	/** Including failures */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumCompleted = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumFailed = 0;
+
+	/** [0,1] */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float Progress = 0.f;
+
+	/** Seconds since prewarming started */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	float ElapsedTime = 0.f;
+
+	double StartTime = 0.0;
+
+	bool IsComplete() const { return NumCompleted >= NumRequested; }
+};
+
+/** Estimated memory of everything Mutable generated for a single instance */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableInstanceMemory
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 MeshBytes = 0;
+
+	/** Textures used by the bound materials, each counted once */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 TextureBytes = 0;
+
+	/** Generated material instances, excluding their textures */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 MaterialBytes = 0;
+
+	/** Released by the memory budget, regenerated once significant again or when a runtime update is requested */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	bool bReleased = false;
+
+	int64 GetTotal() const { return MeshBytes + TextureBytes + MaterialBytes; }
+};
+
+/** Counters exposed by UMutableExtensionSubsystem for the memory budget */
+USTRUCT(BlueprintType)
+struct MUTABLEEXTENSION_API FMutableExtensionMemoryStats
+{
+	GENERATED_BODY()
+
+	/** MutableExtension.Memory.BudgetMB, 0 if unlimited */
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 BudgetBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 UsedBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 PeakUsedBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumInstances = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 NumReleased = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalEvictions = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int64 TotalEvictedBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Mutable")
+	int32 TotalRestores = 0;
 };
@@ -8,6 +8,7 @@
 #include "MutableFunctionLib.generated.h"
 
 enum class EMutableExtensionRuntimeUpdateError : uint8;
+struct FMutableViewPoint;
 class UCustomizableSkeletalComponent;
 
 /**
@@ -23,6 +24,7 @@ class MUTABLEEXTENSION_API UMutableFunctionLib : public UBlueprintFunctionLibrar
 
 public:
 	static ESkeletalMeshStatus GetMutableComponentStatus(const UCustomizableSkeletalComponent* Component, bool& bValidResult);
+	static ESkeletalMeshStatus GetMutableInstanceStatus(const UCustomizableObjectInstance* Instance, bool& bValidResult);
 	
 public:
 	static void ErrorOnFailedValidation(const UCustomizableSkeletalComponent* MutableMesh);
@@ -39,8 +41,74 @@ public:
 		const FInstanceUpdateDelegate& InstanceUpdateDelegate,
 		bool bIgnoreCloseDist = false, bool bForceHighPriority = false);
 
+	/** Must always call IsMutableMeshValidToUpdate() beforehand */
+	static void UpdateMutableMesh_Callback(const UCustomizableSkeletalComponent* MutableMesh,
+		const FInstanceUpdateNativeDelegate& InstanceUpdateDelegate,
+		bool bIgnoreCloseDist = false, bool bForceHighPriority = false);
+
 public:
 	static USkeletalMeshComponent* GetSkeletalMeshCompFromMutableComp(const UCustomizableSkeletalComponent* Component);
+
+	/** @return The mesh the Customizable Object was authored against, with the reference skeleton and physics asset */
+	static USkeletalMesh* GetReferenceSkeletalMesh(const UCustomizableSkeletalComponent* Component);
+
+public:
+	/** Serialize the instance's descriptor (parameters, state, etc.) */
+	static void SaveDescriptor(UCustomizableObjectInstance* Instance, TArray<uint8>& OutDescriptor);
+
+	static void LoadDescriptor(UCustomizableObjectInstance* Instance, const TArray<uint8>& Descriptor);
+
+	/** @return Stable hash of the instance's Customizable Object and serialized descriptor */
+	static uint64 GetDescriptorHash(const UCustomizableObjectInstance* Instance, const TArray<uint8>& Descriptor);
+	static uint64 GetDescriptorHash(UCustomizableObjectInstance* Instance);
+
+	/**
+	 * Hash of the state, LOD and parameter values, read directly instead of serializing the descriptor
+	 * Changes whenever the descriptor hash would, so it can tell when that needs recomputing
+	 * @return False if the instance has projector, transform or multidimensional parameters, which aren't read
+	 */
+	static bool GetDescriptorFingerprint(const UCustomizableObjectInstance* Instance, uint64& OutFingerprint);
+
+	/** @return Estimated size of the skeletal mesh, materials and material textures bound to the component */
+	static FMutableInstanceMemory GetGeneratedMemory(const USkeletalMeshComponent* MeshComponent);
+
+	/** @return Estimated size of the skeletal mesh and material textures bound to the component */
+	static int64 GetGeneratedResourceSize(const USkeletalMeshComponent* MeshComponent);
+
+	/** @return Estimated size of the skeletal meshes and material textures the instance generated, bound or not */
+	static int64 GetGeneratedResourceSize(const UCustomizableObjectInstance* Instance);
+
+public:
+	static int32 GetInstanceMinLOD(const UCustomizableObjectInstance* Instance);
+
+	/**
+	 * Only generate LODs from MinLOD onwards (higher is less detailed), takes effect on the next update
+	 * @param MinLOD INDEX_NONE for the least detailed LOD available
+	 */
+	static void SetInstanceMinLOD(UCustomizableObjectInstance* Instance, int32 MinLOD);
+
+	/** Bind a mesh and replace every override material, without reinitializing the pose */
+	static void SetMeshAndOverrideMaterials(USkeletalMeshComponent* MeshComponent, USkeletalMesh* SkeletalMesh,
+		const TArray<TObjectPtr<UMaterialInterface>>& OverrideMaterials);
+
+	/** @return True if every texture used by the materials is fully streamed in */
+	static bool AreMaterialTexturesStreamedIn(const TArray<UMaterialInterface*>& Materials);
+
+	/** Ask the texture streamer to stream in every texture used by the materials, for the duration */
+	static void PrestreamMaterialTextures(const TArray<UMaterialInterface*>& Materials, float Seconds);
+
+public:
+	static bool IsActorLocallyControlled(const AActor* Actor);
+
+	/** Gather the view points of every local player in the world */
+	static void GatherLocalViewPoints(const UWorld* World, TArray<FMutableViewPoint>& OutViewPoints);
+
+	/**
+	 * Score how important it is that this component updates soon, higher is more significant
+	 * Locally controlled actors always outrank everything else, then projected screen size (which accounts for distance)
+	 * @param bOffScreen True if the component's bounds are outside of every view point
+	 */
+	static float GetUpdateSignificance(const UCustomizableSkeletalComponent* Component, const TArray<FMutableViewPoint>& ViewPoints, bool& bOffScreen);
 	
 public:
 	static AActor* GetTargetedActor(const APlayerController* PlayerController, ECollisionChannel TraceChannel = ECC_Visibility, bool bAllowUnderCursor = false, bool bDebugTargetActorTrace = false);
@@ -52,6 +120,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Mutable")
 	static void DumpMutableDataForTargetedActor(const APlayerController* PlayerController, ECollisionChannel TraceChannel = ECC_Visibility, bool bDumpToMessageLog = false, bool bAllowUnderCursor = false, bool bDebugTargetActorTrace = true);
 
+	/** Human readable dump of a single actor, see FMutableWorldDiagnostics for every actor in the world */
 	static FString GatherMutableDataDump(const AActor* ForActor);
 
 	static FString ParseRuntimeUpdateError(const EMutableExtensionRuntimeUpdateError& Error, bool bVerbose);
@@ -62,6 +131,9 @@ public:
 
 	static FString GetUpdateResultAsString(EUpdateResult Result);
 
+	/** @return True if the update produced a usable mesh */
+	static bool IsUpdateResultValid(EUpdateResult Result);
+
 protected:
 	static FString ParseRuntimeUpdateError_Simple(const EMutableExtensionRuntimeUpdateError& Error);
 	static FString ParseRuntimeUpdateError_Verbose(const EMutableExtensionRuntimeUpdateError& Error);
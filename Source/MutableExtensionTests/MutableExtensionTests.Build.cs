@@ -0,0 +1,29 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+using UnrealBuildTool;
+
+public class MutableExtensionTests : ModuleRules
+{
+	public MutableExtensionTests(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"CustomizableObject",
+				"Engine",
+				"Json",
+				"MutableExtension",
+			}
+			);
+
+		// Listen server tests play in editor
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("UnrealEd");
+		}
+	}
+}
@@ -0,0 +1,49 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionReplicationTestActor.h"
+
+#include "MutableExtensionComponent.h"
+#include "MutableExtensionTestWorld.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "MuCO/CustomizableObject.h"
+#include "MuCO/CustomizableObjectInstance.h"
+#include "MuCO/CustomizableSkeletalComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(MutableExtensionReplicationTestActor)
+
+AMutableExtensionReplicationTestActor::AMutableExtensionReplicationTestActor()
+{
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	Mesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Mesh"));
+	RootComponent = Mesh;
+
+	Customizable = CreateDefaultSubobject<UCustomizableSkeletalComponent>(TEXT("Customizable"));
+	Customizable->SetupAttachment(Mesh);
+
+	MutableExtension = CreateDefaultSubobject<UMutableExtensionComponent>(TEXT("MutableExtension"));
+	MutableExtension->bReplicateDescriptors = true;
+}
+
+void AMutableExtensionReplicationTestActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FString ObjectPath;
+	UCustomizableObject* CustomizableObject = FMutableExtensionTestWorld::LoadTestObject(ObjectPath);
+	if (!CustomizableObject)
+	{
+		return;
+	}
+
+	Customizable->SetCustomizableObjectInstance(CustomizableObject->CreateInstance());
+	Customizable->SetComponentIndex(0);
+
+	MutableExtension->OnRuntimeUpdateCompletedNative.AddWeakLambda(this, [this](const FMutablePendingRuntimeUpdate&)
+	{
+		NumRuntimeUpdatesCompleted++;
+	});
+	MutableExtension->RequestMutableInitialization({ Customizable });
+}
@@ -0,0 +1,38 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "MutableExtensionReplicationTestActor.generated.h"
+
+class UCustomizableSkeletalComponent;
+class UMutableExtensionComponent;
+class USkeletalMeshComponent;
+
+/**
+ * Replicated actor with a single customizable component whose descriptor is replicated by its UMutableExtensionComponent
+ * Every machine gives it an instance of the test Customizable Object and initializes it on BeginPlay
+ */
+UCLASS(NotPlaceable, Transient)
+class AMutableExtensionReplicationTestActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AMutableExtensionReplicationTestActor();
+
+	virtual void BeginPlay() override;
+
+	UPROPERTY()
+	USkeletalMeshComponent* Mesh;
+
+	UPROPERTY()
+	UCustomizableSkeletalComponent* Customizable;
+
+	UPROPERTY()
+	UMutableExtensionComponent* MutableExtension;
+
+	/** Runtime updates completed on this machine, replicated or requested */
+	int32 NumRuntimeUpdatesCompleted = 0;
+};
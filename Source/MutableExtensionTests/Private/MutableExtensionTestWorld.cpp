@@ -0,0 +1,120 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionTestWorld.h"
+
+#include "MutableExtensionComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/CommandLine.h"
+#include "Misc/PackageName.h"
+#include "MuCO/CustomizableObject.h"
+#include "MuCO/CustomizableObjectInstance.h"
+#include "MuCO/CustomizableSkeletalComponent.h"
+
+namespace MutableExtensionTests
+{
+	static const TCHAR* DefaultTestObjectPath = TEXT("/MutableExtension/Tests/CO_MutableExtensionTest.CO_MutableExtensionTest");
+}
+
+bool FMutableExtensionTestWorld::Create(const FString& Name)
+{
+	Destroy();
+
+	World = UWorld::CreateWorld(EWorldType::Game, false, MakeUniqueObjectName(nullptr, UWorld::StaticClass(), *Name));
+	if (!World)
+	{
+		return false;
+	}
+
+	World->InitializeActorsForPlay(FURL());
+
+	// No game mode, begin play the same way AGameStateBase::HandleBeginPlay() does
+	if (AWorldSettings* WorldSettings = World->GetWorldSettings())
+	{
+		WorldSettings->NotifyBeginPlay();
+	}
+	return World->HasBegunPlay();
+}
+
+void FMutableExtensionTestWorld::Destroy()
+{
+	if (World)
+	{
+		World->DestroyWorld(false);
+		World->RemoveFromRoot();
+		World = nullptr;
+	}
+}
+
+void FMutableExtensionTestWorld::Tick(float DeltaSeconds)
+{
+	if (World)
+	{
+		World->Tick(LEVELTICK_All, DeltaSeconds);
+	}
+}
+
+FMutableExtensionTestActor FMutableExtensionTestWorld::SpawnMutableActor(UCustomizableObject* CustomizableObject,
+	int32 NumComponents)
+{
+	FMutableExtensionTestActor Result;
+	if (!World || !CustomizableObject)
+	{
+		return Result;
+	}
+
+	AActor* Actor = World->SpawnActor<AActor>();
+	if (!Actor)
+	{
+		return Result;
+	}
+
+	USceneComponent* Root = NewObject<USceneComponent>(Actor, TEXT("Root"));
+	Actor->SetRootComponent(Root);
+	Root->RegisterComponent();
+
+	UMutableExtensionComponent* Extension = NewObject<UMutableExtensionComponent>(Actor, TEXT("MutableExtension"));
+	Extension->RegisterComponent();
+
+	for (int32 Index = 0; Index < NumComponents; Index++)
+	{
+		USkeletalMeshComponent* Mesh = NewObject<USkeletalMeshComponent>(Actor, *FString::Printf(TEXT("Mesh%d"), Index));
+		Mesh->SetupAttachment(Root);
+		Mesh->RegisterComponent();
+
+		UCustomizableSkeletalComponent* Component = NewObject<UCustomizableSkeletalComponent>(Actor,
+			*FString::Printf(TEXT("Customizable%d"), Index));
+		Component->SetCustomizableObjectInstance(CustomizableObject->CreateInstance());
+		Component->SetComponentIndex(0);
+		Component->SetupAttachment(Mesh);
+		Component->RegisterComponent();
+
+		Result.Components.Add(Component);
+	}
+
+	Result.Actor = Actor;
+	Result.Extension = Extension;
+	return Result;
+}
+
+UCustomizableObject* FMutableExtensionTestWorld::LoadTestObject(FString& OutPath)
+{
+	if (!FParse::Value(FCommandLine::Get(), TEXT("-MutableExtensionTestObject="), OutPath))
+	{
+		OutPath = MutableExtensionTests::DefaultTestObjectPath;
+	}
+	return LoadObject<UCustomizableObject>(nullptr, *OutPath);
+}
+
+bool FMutableExtensionTestWorld::HasTestObject()
+{
+	// An explicit object that is missing is still an error, so the test runs and reports it
+	FString Path;
+	if (FParse::Value(FCommandLine::Get(), TEXT("-MutableExtensionTestObject="), Path))
+	{
+		return true;
+	}
+	return FPackageName::DoesPackageExist(FPackageName::ObjectPathToPackageName(FString(MutableExtensionTests::DefaultTestObjectPath)));
+}
@@ -0,0 +1,55 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UCustomizableObject;
+class UCustomizableSkeletalComponent;
+class UMutableExtensionComponent;
+class UWorld;
+
+/** Actor spawned by FMutableExtensionTestWorld::SpawnMutableActor() */
+struct FMutableExtensionTestActor
+{
+	TWeakObjectPtr<AActor> Actor;
+	TWeakObjectPtr<UMutableExtensionComponent> Extension;
+	TArray<UCustomizableSkeletalComponent*> Components;
+};
+
+/**
+ * Game world that automation tests tick themselves, so they run the same headless (-nullrhi) as in the editor
+ * The world is not known to the engine, nothing else ticks it
+ */
+class FMutableExtensionTestWorld
+{
+public:
+	~FMutableExtensionTestWorld() { Destroy(); }
+
+	/** Create the world and begin play */
+	bool Create(const FString& Name);
+	void Destroy();
+
+	void Tick(float DeltaSeconds);
+
+	/**
+	 * Spawn an actor with a UMutableExtensionComponent and NumComponents skeletal meshes, each with a
+	 * UCustomizableSkeletalComponent using a new instance of CustomizableObject
+	 */
+	FMutableExtensionTestActor SpawnMutableActor(UCustomizableObject* CustomizableObject, int32 NumComponents);
+
+	UWorld* GetWorld() const { return World; }
+
+	/** Customizable Object for tests in the plugin's content, override with -MutableExtensionTestObject= */
+	static UCustomizableObject* LoadTestObject(FString& OutPath);
+
+	/**
+	 * The plugin doesn't ship the test object, a project adds it to Content/Tests, see the README there
+	 * @return False if it wasn't added and none was passed on the command line, tests that need it are skipped
+	 */
+	static bool HasTestObject();
+
+private:
+	UWorld* World = nullptr;
+};
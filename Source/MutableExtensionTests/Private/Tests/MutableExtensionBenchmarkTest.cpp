@@ -0,0 +1,264 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionTestWorld.h"
+
+#include "MutableExtensionComponent.h"
+#include "MutableExtensionSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "MuCO/CustomizableObject.h"
+#include "MuCO/CustomizableObjectInstance.h"
+#include "MuCO/CustomizableSkeletalComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MutableExtensionTests
+{
+	/** Defaults are small enough for CI, override on the command line, e.g. -MutableExtensionTestActors=200 */
+	struct FSpawnAndMeasureSettings
+	{
+		int32 NumActors = 32;
+		int32 NumComponents = 4;
+		int32 NumRuntimeUpdateRounds = 4;
+		float TimeoutSeconds = 300.f;
+		FString Filename;
+
+		void ParseCommandLine()
+		{
+			const TCHAR* CommandLine = FCommandLine::Get();
+			FParse::Value(CommandLine, TEXT("-MutableExtensionTestActors="), NumActors);
+			FParse::Value(CommandLine, TEXT("-MutableExtensionTestComponents="), NumComponents);
+			FParse::Value(CommandLine, TEXT("-MutableExtensionTestRounds="), NumRuntimeUpdateRounds);
+			FParse::Value(CommandLine, TEXT("-MutableExtensionTestTimeout="), TimeoutSeconds);
+			if (!FParse::Value(CommandLine, TEXT("-MutableExtensionTestResult="), Filename))
+			{
+				Filename = FPaths::ProjectSavedDir() / TEXT("MutableExtension") /
+					FString::Printf(TEXT("SpawnAndMeasure-%dx%d.json"), NumActors, NumComponents);
+			}
+		}
+	};
+}
+
+/**
+ * Spawns actors, waits for every one to initialize, then runs rounds of runtime updates on every component and writes
+ * the subsystem's benchmark (time to initialized, throughput, memory growth during the run, frame time percentiles) as JSON
+ */
+class FMutableExtensionSpawnAndMeasureCommand final : public IAutomationLatentCommand
+{
+public:
+	FMutableExtensionSpawnAndMeasureCommand(FAutomationTestBase* InTest, const MutableExtensionTests::FSpawnAndMeasureSettings& InSettings)
+		: Test(InTest)
+		, Settings(InSettings)
+	{}
+
+	virtual bool Update() override
+	{
+		switch (Phase)
+		{
+		case EPhase::Spawn: return Spawn();
+		case EPhase::Initialize: return WaitForInitialization();
+		case EPhase::RuntimeUpdate: return WaitForRuntimeUpdates();
+		default: return true;
+		}
+	}
+
+private:
+	enum class EPhase : uint8
+	{
+		Spawn,
+		Initialize,
+		RuntimeUpdate,
+	};
+
+	bool Spawn()
+	{
+		FString ObjectPath;
+		UCustomizableObject* CustomizableObject = FMutableExtensionTestWorld::LoadTestObject(ObjectPath);
+		if (!CustomizableObject)
+		{
+			Test->AddError(FString::Printf(TEXT("Test Customizable Object %s not found"), *ObjectPath));
+			return true;
+		}
+
+		if (!TestWorld.Create(TEXT("MutableExtensionSpawnAndMeasure")))
+		{
+			Test->AddError(TEXT("Failed to create the test world"));
+			return true;
+		}
+
+		Subsystem = UMutableExtensionSubsystem::Get(TestWorld.GetWorld());
+		if (!Subsystem)
+		{
+			Test->AddError(TEXT("UMutableExtensionSubsystem is missing from the test world"));
+			return true;
+		}
+
+		// The first float parameter is changed by each runtime update so that each one regenerates
+		for (int32 ParameterIndex = 0; ParameterIndex < CustomizableObject->GetParameterCount(); ParameterIndex++)
+		{
+			if (CustomizableObject->GetParameterTypeByIndex(ParameterIndex) == EMutableParameterType::Float &&
+				!CustomizableObject->IsParameterMultidimensional(ParameterIndex))
+			{
+				FloatParameter = CustomizableObject->GetParameterName(ParameterIndex);
+				break;
+			}
+		}
+
+		Subsystem->ResetBenchmark();
+		StartTime = FPlatformTime::Seconds();
+
+		for (int32 Index = 0; Index < Settings.NumActors; Index++)
+		{
+			FMutableExtensionTestActor Actor = TestWorld.SpawnMutableActor(CustomizableObject, Settings.NumComponents);
+			if (!Actor.Extension.IsValid())
+			{
+				Test->AddError(TEXT("Failed to spawn a test actor"));
+				return true;
+			}
+
+			Actor.Extension->OnRuntimeUpdateCompletedNative.AddLambda([this](const FMutablePendingRuntimeUpdate&)
+			{
+				NumRuntimeUpdatesCompleted++;
+			});
+			Actor.Extension->RequestMutableInitialization(Actor.Components);
+			Actors.Add(MoveTemp(Actor));
+		}
+
+		Phase = EPhase::Initialize;
+		return false;
+	}
+
+	bool WaitForInitialization()
+	{
+		TestWorld.Tick(FApp::GetDeltaTime());
+
+		for (const FMutableExtensionTestActor& Actor : Actors)
+		{
+			if (!Actor.Extension.IsValid() || !Actor.Extension->HasMutableInitialized())
+			{
+				return HasTimedOut(TEXT("initialization"));
+			}
+		}
+
+		InitializedSeconds = FPlatformTime::Seconds() - StartTime;
+		return BeginRuntimeUpdateRound();
+	}
+
+	bool BeginRuntimeUpdateRound()
+	{
+		if (Round >= Settings.NumRuntimeUpdateRounds)
+		{
+			return Finish();
+		}
+		Round++;
+
+		for (const FMutableExtensionTestActor& Actor : Actors)
+		{
+			for (UCustomizableSkeletalComponent* Component : Actor.Components)
+			{
+				UCustomizableObjectInstance* Instance = Component ? Component->GetCustomizableObjectInstance() : nullptr;
+				USkeletalMeshComponent* OwningComponent = Component ? Cast<USkeletalMeshComponent>(Component->GetAttachParent()) : nullptr;
+				if (!Instance || !OwningComponent)
+				{
+					continue;
+				}
+
+				if (!FloatParameter.IsEmpty())
+				{
+					Instance->SetFloatParameterSelectedOption(FloatParameter, FMath::FRand());
+				}
+
+				EMutableExtensionRuntimeUpdateError Error = EMutableExtensionRuntimeUpdateError::None;
+				if (Actor.Extension->RuntimeUpdateMutableComponent(OwningComponent, Component, Error))
+				{
+					NumRuntimeUpdatesRequested++;
+				}
+			}
+		}
+
+		Phase = EPhase::RuntimeUpdate;
+		return false;
+	}
+
+	bool WaitForRuntimeUpdates()
+	{
+		TestWorld.Tick(FApp::GetDeltaTime());
+
+		for (const FMutableExtensionTestActor& Actor : Actors)
+		{
+			if (Actor.Extension.IsValid() && (Actor.Extension->GetInstancesPendingRuntimeUpdate().Num() > 0 ||
+				Actor.Extension->HasPendingMeshSwaps()))
+			{
+				return HasTimedOut(TEXT("runtime updates"));
+			}
+		}
+
+		return BeginRuntimeUpdateRound();
+	}
+
+	bool Finish()
+	{
+		const double UpdateSeconds = FPlatformTime::Seconds() - StartTime - InitializedSeconds;
+		Test->AddInfo(FString::Printf(TEXT("%d actors x %d components initialized in %.2fs, %d of %d runtime updates completed in %.2fs"),
+			Settings.NumActors, Settings.NumComponents, InitializedSeconds, NumRuntimeUpdatesCompleted, NumRuntimeUpdatesRequested,
+			UpdateSeconds));
+		Test->TestEqual(TEXT("Runtime updates completed"), NumRuntimeUpdatesCompleted, NumRuntimeUpdatesRequested);
+
+		if (!Subsystem.IsValid() || !Subsystem->WriteBenchmark(Settings.Filename))
+		{
+			Test->AddError(FString::Printf(TEXT("Failed to write %s"), *Settings.Filename));
+		}
+		return true;
+	}
+
+	bool HasTimedOut(const TCHAR* Waiting)
+	{
+		if (FPlatformTime::Seconds() - StartTime < Settings.TimeoutSeconds)
+		{
+			return false;
+		}
+
+		Test->AddError(FString::Printf(TEXT("Timed out after %.0fs waiting for %s"), Settings.TimeoutSeconds, Waiting));
+		return true;
+	}
+
+	FAutomationTestBase* Test = nullptr;
+	MutableExtensionTests::FSpawnAndMeasureSettings Settings;
+
+	FMutableExtensionTestWorld TestWorld;
+	TWeakObjectPtr<UMutableExtensionSubsystem> Subsystem;
+	TArray<FMutableExtensionTestActor> Actors;
+	FString FloatParameter;
+
+	EPhase Phase = EPhase::Spawn;
+	int32 Round = 0;
+	int32 NumRuntimeUpdatesRequested = 0;
+	int32 NumRuntimeUpdatesCompleted = 0;
+	double StartTime = 0.0;
+	double InitializedSeconds = 0.0;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMutableExtensionSpawnAndMeasureTest, "MutableExtension.Benchmark.SpawnAndMeasure",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FMutableExtensionSpawnAndMeasureTest::RunTest(const FString& Parameters)
+{
+	if (!FMutableExtensionTestWorld::HasTestObject())
+	{
+		AddInfo(TEXT("Skipped, no test Customizable Object. Add CO_MutableExtensionTest to Content/Tests or pass -MutableExtensionTestObject="));
+		return true;
+	}
+
+	MutableExtensionTests::FSpawnAndMeasureSettings Settings;
+	Settings.ParseCommandLine();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FMutableExtensionSpawnAndMeasureCommand(this, Settings));
+	return true;
+}
+
+#endif
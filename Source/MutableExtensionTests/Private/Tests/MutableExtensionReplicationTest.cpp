@@ -0,0 +1,345 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "MutableExtensionReplicationTestActor.h"
+#include "MutableExtensionTestWorld.h"
+
+#include "MutableExtensionComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "MuCO/CustomizableObject.h"
+#include "MuCO/CustomizableObjectInstance.h"
+#include "MuCO/CustomizableSkeletalComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Editor.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationEditorCommon.h"
+
+namespace MutableExtensionTests
+{
+	struct FReplicationSettings
+	{
+		int32 NumChanges = 16;
+		float TimeoutSeconds = 120.f;
+		EMutableReplicationPrecision Precision = EMutableReplicationPrecision::Lossless;
+		FString Filename;
+
+		void ParseCommandLine()
+		{
+			const TCHAR* CommandLine = FCommandLine::Get();
+			FParse::Value(CommandLine, TEXT("-MutableExtensionTestChanges="), NumChanges);
+			FParse::Value(CommandLine, TEXT("-MutableExtensionTestTimeout="), TimeoutSeconds);
+			if (FParse::Param(CommandLine, TEXT("MutableExtensionTestQuantized")))
+			{
+				Precision = EMutableReplicationPrecision::Quantized;
+			}
+			if (!FParse::Value(CommandLine, TEXT("-MutableExtensionTestReplicationResult="), Filename))
+			{
+				Filename = FPaths::ProjectSavedDir() / TEXT("MutableExtension") / TEXT("ReplicationListenServer.json");
+			}
+		}
+	};
+
+	static UWorld* FindPlayWorld(ENetMode NetMode)
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			UWorld* World = Context.World();
+			if (Context.WorldType == EWorldType::PIE && World && World->GetNetMode() == NetMode)
+			{
+				return World;
+			}
+		}
+		return nullptr;
+	}
+
+	static AMutableExtensionReplicationTestActor* FindTestActor(UWorld* World)
+	{
+		if (!World)
+		{
+			return nullptr;
+		}
+
+		TActorIterator<AMutableExtensionReplicationTestActor> It(World);
+		return It ? *It : nullptr;
+	}
+}
+
+/**
+ * Plays in editor as a listen server with one client, then changes a float or color parameter of a replicated actor on
+ * the server and waits for each change to be generated on the client. Writes the bits sent per change and the
+ * client's apply latency as JSON, and checks that the client received the exact values
+ */
+class FMutableExtensionReplicationCommand final : public IAutomationLatentCommand
+{
+public:
+	FMutableExtensionReplicationCommand(FAutomationTestBase* InTest, const MutableExtensionTests::FReplicationSettings& InSettings)
+		: Test(InTest)
+		, Settings(InSettings)
+	{}
+
+	virtual bool Update() override
+	{
+		switch (Phase)
+		{
+		case EPhase::StartPlay: return StartPlay();
+		case EPhase::Spawn: return Spawn();
+		case EPhase::Initialize: return WaitForInitialization();
+		case EPhase::Replicate: return WaitForReplication();
+		default: return true;
+		}
+	}
+
+private:
+	enum class EPhase : uint8
+	{
+		StartPlay,
+		Spawn,
+		Initialize,
+		Replicate,
+	};
+
+	bool StartPlay()
+	{
+		FString ObjectPath;
+		UCustomizableObject* CustomizableObject = FMutableExtensionTestWorld::LoadTestObject(ObjectPath);
+		if (!CustomizableObject)
+		{
+			Test->AddError(FString::Printf(TEXT("Test Customizable Object %s not found"), *ObjectPath));
+			return true;
+		}
+
+		for (int32 ParameterIndex = 0; ParameterIndex < CustomizableObject->GetParameterCount(); ParameterIndex++)
+		{
+			const EMutableParameterType Type = CustomizableObject->GetParameterTypeByIndex(ParameterIndex);
+			if ((Type == EMutableParameterType::Float || Type == EMutableParameterType::Color) &&
+				!CustomizableObject->IsParameterMultidimensional(ParameterIndex))
+			{
+				ParameterName = CustomizableObject->GetParameterName(ParameterIndex);
+				ParameterType = Type;
+				break;
+			}
+		}
+
+		if (ParameterName.IsEmpty())
+		{
+			Test->AddError(FString::Printf(TEXT("%s has no float or color parameter to replicate"), *ObjectPath));
+			return true;
+		}
+
+		FAutomationEditorCommonUtils::CreateNewMap();
+
+		ULevelEditorPlaySettings* PlaySettings = NewObject<ULevelEditorPlaySettings>();
+		PlaySettings->SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+		PlaySettings->SetPlayNumberOfClients(2);
+		PlaySettings->SetRunUnderOneProcess(true);
+		PlaySettings->bLaunchSeparateServer = false;
+
+		FRequestPlaySessionParams Params;
+		Params.WorldType = EPlaySessionWorldType::PlayInEditor;
+		Params.EditorPlaySettings = PlaySettings;
+		GEditor->RequestPlaySession(Params);
+
+		StartTime = FPlatformTime::Seconds();
+		Phase = EPhase::Spawn;
+		return false;
+	}
+
+	bool Spawn()
+	{
+		UWorld* ServerWorld = MutableExtensionTests::FindPlayWorld(NM_ListenServer);
+		if (!ServerWorld || !MutableExtensionTests::FindPlayWorld(NM_Client) || !ServerWorld->HasBegunPlay())
+		{
+			return HasTimedOut(TEXT("play in editor"));
+		}
+
+		ServerActor = ServerWorld->SpawnActor<AMutableExtensionReplicationTestActor>();
+		if (!ServerActor.IsValid())
+		{
+			Test->AddError(TEXT("Failed to spawn the replicated test actor"));
+			return Finish();
+		}
+
+		ServerActor->MutableExtension->ReplicationPrecision = Settings.Precision;
+		Phase = EPhase::Initialize;
+		return false;
+	}
+
+	bool WaitForInitialization()
+	{
+		if (!ClientActor.IsValid())
+		{
+			ClientActor = MutableExtensionTests::FindTestActor(MutableExtensionTests::FindPlayWorld(NM_Client));
+		}
+
+		if (!ServerActor.IsValid() || !ClientActor.IsValid() || !ServerActor->MutableExtension->HasMutableInitialized() ||
+			!ClientActor->MutableExtension->HasMutableInitialized())
+		{
+			return HasTimedOut(TEXT("initialization"));
+		}
+
+		return RequestChange();
+	}
+
+	bool RequestChange()
+	{
+		if (NumChanges >= Settings.NumChanges)
+		{
+			return Finish();
+		}
+
+		// The client completes one runtime update per change, on top of whatever it completed so far
+		ExpectedClientUpdates = ClientActor->NumRuntimeUpdatesCompleted + 1;
+		NumChanges++;
+
+		// Values that half precision and 8 bit colors can't represent exactly
+		UCustomizableObjectInstance* Instance = ServerActor->Customizable->CustomizableObjectInstance;
+		if (ParameterType == EMutableParameterType::Float)
+		{
+			Instance->SetFloatParameterSelectedOption(ParameterName, FMath::FRand() * 0.999f + 0.0001f);
+		}
+		else
+		{
+			Instance->SetColorParameterSelectedOption(ParameterName,
+				FLinearColor(FMath::FRand() * 4.f, FMath::FRand(), FMath::FRand(), 1.f));
+		}
+
+		EMutableExtensionRuntimeUpdateError Error = EMutableExtensionRuntimeUpdateError::None;
+		if (!ServerActor->MutableExtension->RuntimeUpdateMutableComponent(ServerActor->Mesh, ServerActor->Customizable, Error))
+		{
+			Test->AddError(FString::Printf(TEXT("Server runtime update failed with %s"), *UEnum::GetValueAsString(Error)));
+			return Finish();
+		}
+
+		Phase = EPhase::Replicate;
+		return false;
+	}
+
+	bool WaitForReplication()
+	{
+		if (!ServerActor.IsValid() || !ClientActor.IsValid())
+		{
+			Test->AddError(TEXT("A test actor was destroyed"));
+			return Finish();
+		}
+
+		if (ClientActor->NumRuntimeUpdatesCompleted < ExpectedClientUpdates)
+		{
+			return HasTimedOut(TEXT("the client to apply a change"));
+		}
+
+		const UCustomizableObjectInstance* ServerInstance = ServerActor->Customizable->CustomizableObjectInstance;
+		const UCustomizableObjectInstance* ClientInstance = ClientActor->Customizable->CustomizableObjectInstance;
+		if (Settings.Precision == EMutableReplicationPrecision::Lossless)
+		{
+			if (ParameterType == EMutableParameterType::Float)
+			{
+				Test->TestEqual(TEXT("Replicated float"), ClientInstance->GetFloatParameterSelectedOption(ParameterName),
+					ServerInstance->GetFloatParameterSelectedOption(ParameterName), 0.f);
+			}
+			else
+			{
+				Test->TestEqual(TEXT("Replicated color"), ClientInstance->GetColorParameterSelectedOption(ParameterName),
+					ServerInstance->GetColorParameterSelectedOption(ParameterName), 0.f);
+			}
+		}
+
+		return RequestChange();
+	}
+
+	bool Finish()
+	{
+		if (ServerActor.IsValid() && ClientActor.IsValid())
+		{
+			WriteResult();
+		}
+
+		GEditor->RequestEndPlayMap();
+		return true;
+	}
+
+	void WriteResult() const
+	{
+		const FMutableReplicationStats& ServerStats = ServerActor->MutableExtension->GetReplicationStats();
+		const FMutableReplicationStats& ClientStats = ClientActor->MutableExtension->GetReplicationStats();
+
+		Test->AddInfo(FString::Printf(TEXT("%d changes, %.1f bits per change, client apply latency avg %.2fms max %.2fms"),
+			ServerStats.NumChangesSent, ServerStats.AverageBitsPerChange, ClientStats.AverageApplyLatency * 1000.f,
+			ClientStats.MaxApplyLatency * 1000.f));
+
+		FString Json;
+		TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("precision"), UEnum::GetValueAsString(Settings.Precision));
+		Writer->WriteValue(TEXT("parameter"), ParameterName);
+		Writer->WriteValue(TEXT("changesSent"), ServerStats.NumChangesSent);
+		Writer->WriteValue(TEXT("parametersSent"), ServerStats.NumParametersSent);
+		Writer->WriteValue(TEXT("totalBitsSent"), ServerStats.TotalBitsSent);
+		Writer->WriteValue(TEXT("bitsPerChange"), ServerStats.AverageBitsPerChange);
+		Writer->WriteValue(TEXT("changesReceived"), ClientStats.NumChangesReceived);
+		Writer->WriteValue(TEXT("updatesApplied"), ClientStats.NumUpdatesApplied);
+		Writer->WriteValue(TEXT("averageApplyLatencyMs"), ClientStats.AverageApplyLatency * 1000.f);
+		Writer->WriteValue(TEXT("maxApplyLatencyMs"), ClientStats.MaxApplyLatency * 1000.f);
+		Writer->WriteObjectEnd();
+		Writer->Close();
+
+		if (!FFileHelper::SaveStringToFile(Json, *Settings.Filename))
+		{
+			Test->AddError(FString::Printf(TEXT("Failed to write %s"), *Settings.Filename));
+		}
+	}
+
+	bool HasTimedOut(const TCHAR* Waiting)
+	{
+		if (FPlatformTime::Seconds() - StartTime < Settings.TimeoutSeconds)
+		{
+			return false;
+		}
+
+		Test->AddError(FString::Printf(TEXT("Timed out after %.0fs waiting for %s"), Settings.TimeoutSeconds, Waiting));
+		return Finish();
+	}
+
+	FAutomationTestBase* Test = nullptr;
+	MutableExtensionTests::FReplicationSettings Settings;
+
+	TWeakObjectPtr<AMutableExtensionReplicationTestActor> ServerActor;
+	TWeakObjectPtr<AMutableExtensionReplicationTestActor> ClientActor;
+	FString ParameterName;
+	EMutableParameterType ParameterType = EMutableParameterType::None;
+
+	EPhase Phase = EPhase::StartPlay;
+	int32 NumChanges = 0;
+	int32 ExpectedClientUpdates = 0;
+	double StartTime = 0.0;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMutableExtensionReplicationTest, "MutableExtension.Replication.ListenServer",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FMutableExtensionReplicationTest::RunTest(const FString& Parameters)
+{
+	if (!FMutableExtensionTestWorld::HasTestObject())
+	{
+		AddInfo(TEXT("Skipped, no test Customizable Object. Add CO_MutableExtensionTest to Content/Tests or pass -MutableExtensionTestObject="));
+		return true;
+	}
+
+	MutableExtensionTests::FReplicationSettings Settings;
+	Settings.ParseCommandLine();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FMutableExtensionReplicationCommand(this, Settings));
+	return true;
+}
+
+#endif